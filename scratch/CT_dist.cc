@@ -0,0 +1,426 @@
+//Utilities
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+//Distributed simulation (only when ns-3 is configured with --enable-mpi)
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#include <mpi.h>
+#endif
+//Losses
+#include "ns3/propagation-module.h"
+//Device mobility and position
+#include "ns3/mobility-helper.h"
+#include "ns3/position-allocator.h"
+//LoRa End Devices and Gateways
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-device-address-generator.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/lora-phy.h"
+//Periodic Sender
+#include "ns3/node-container.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/periodic-sender.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+// Network Server and Forwarder
+#include "ns3/point-to-point-helper.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/network-server-helper.h"
+// Bridge partitioning
+#include "lora-bridge/lib/region-partition.h"
+//Namespaces
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("CT_dist");
+
+// City-scale variant of CT_dev: the deployment is split into gateway regions,
+// each with its own end devices, radio channel and network server, and every
+// region is simulated by one MPI rank. The network server decides on the
+// state of the gateway MACs (is a gateway transmitting, for how long is it
+// off air), which only the rank owning the gateway simulates, so each region
+// is served by its own server on that rank and no decision ever reads a
+// gateway of another rank. The ranks exchange no packets during the run.
+//
+// Radio interference between regions is not modelled. The start offsets of
+// the devices are drawn for the whole deployment in the same order on every
+// rank, so without MPI, or with a single rank, the same partitioned topology
+// runs serially with the same traffic, which gives the reference for checking
+// a distributed run. --sharedChannel puts all regions on one channel, with
+// one network server, instead to measure what the partitioning leaves out.
+//
+//   mpirun -np 4 ./ns3 run "CT_dist --regions=16 --devicesPerRegion=500"
+
+/**********************
+ * Global simulation parameters (defaults, overridable from the command line)
+ **********************/
+static uint32_t SIM_END_HOURS = 24;          // Total simulation time in hours
+static uint32_t N_REGIONS = 4;               // Number of gateway regions
+static uint32_t N_GATEWAYS_PER_REGION = 1;   // Gateways in every region
+static uint32_t N_DEVICES_PER_REGION = 100;  // End devices in every region
+static double REGION_SPACING = 5000.0;       // Distance between region centres in meters
+static double REGION_RADIUS = 1500.0;        // Radius of the end device disc of a region in meters
+static Time PERIOD_SENDER = Minutes(15);     // Periodic sender interval
+static bool USE_CONFIRMED_UPLINK = true;     // true = confirmed, false = unconfirmed
+static bool USE_NULL_MESSAGE = false;        // true = null message synchronisation, false = granted time window
+static bool SHARED_CHANNEL = false;          // Serial runs only: one channel for all regions
+
+/**********************
+ * Global variables
+ **********************/
+static uint32_t g_systemId = 0;                    // Rank of this process
+static std::vector<uint64_t> g_uplinksSent;         // Per region, counted on the rank that owns it
+static std::vector<uint64_t> g_uplinksReceived;     // Per region, unique uplinks heard by a gateway
+static std::vector<uint64_t> g_acksSent;            // Per region
+static std::unordered_map<uint32_t, uint16_t> g_lastFCnt; // Device address -> frame counter of its last heard uplink
+
+/**********************
+ * Rank reductions
+ **********************/
+// Sum @p values element-wise over all ranks; the result is valid on rank 0
+void ReduceSum(std::vector<uint64_t>& values) {
+#ifdef NS3_MPI
+    if (MpiInterface::IsEnabled()) {
+        std::vector<uint64_t> total(values.size(), 0);
+        MPI_Reduce(values.data(), total.data(), values.size(), MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+        values = total;
+    }
+#endif
+}
+
+double ReduceMax(double value) {
+#ifdef NS3_MPI
+    if (MpiInterface::IsEnabled()) {
+        double result = 0.0;
+        MPI_Reduce(&value, &result, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        return result;
+    }
+#endif
+    return value;
+}
+
+/***************
+ * Callbacks for tracing packets at PHY layer
+ ***************/
+void OnEndDeviceStartSending(uint32_t region, Ptr<const Packet> packet, uint32_t phyIndex) {
+    g_uplinksSent[region]++;
+}
+
+void OnGatewayReceivedPacket(uint32_t region, Ptr<const Packet> packet, uint32_t phyIndex) {
+    Ptr<Packet> copy = packet->Copy();
+    LorawanMacHeader macHdr;
+    copy->RemoveHeader(macHdr);
+    if (!macHdr.IsUplink()) {
+        return;
+    }
+    LoraFrameHeader frameHdr;
+    frameHdr.SetAsUplink();
+    copy->RemoveHeader(frameHdr);
+
+    // Regions have disjoint gateways, so deduplicating on this rank is exact. A class A device
+    // only sends a new frame once the previous one is done, so copies and retransmissions of an
+    // uplink carry the frame counter of the last one heard: one entry per device is enough
+    auto last = g_lastFCnt.find(frameHdr.GetAddress().Get());
+    if (last == g_lastFCnt.end()) {
+        g_lastFCnt.emplace(frameHdr.GetAddress().Get(), frameHdr.GetFCnt());
+        g_uplinksReceived[region]++;
+    } else if (last->second != frameHdr.GetFCnt()) {
+        last->second = frameHdr.GetFCnt();
+        g_uplinksReceived[region]++;
+    }
+}
+
+void OnGatewayStartSending(uint32_t region, Ptr<const Packet> packet, uint32_t phyIndex) {
+    Ptr<Packet> copy = packet->Copy();
+    LorawanMacHeader macHdr;
+    copy->RemoveHeader(macHdr);
+    if (macHdr.IsUplink()) {
+        return;
+    }
+    LoraFrameHeader frameHdr;
+    frameHdr.SetAsDownlink();
+    copy->RemoveHeader(frameHdr);
+    if (frameHdr.GetAck()) {
+        g_acksSent[region]++;
+    }
+}
+
+/***************
+ * Main simulation code
+ ***************/
+int main(int argc, char *argv[]) {
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("simHours", "Total simulation time in hours", SIM_END_HOURS);
+    cmd.AddValue("regions", "Number of gateway regions", N_REGIONS);
+    cmd.AddValue("gatewaysPerRegion", "Gateways in every region", N_GATEWAYS_PER_REGION);
+    cmd.AddValue("devicesPerRegion", "End devices in every region", N_DEVICES_PER_REGION);
+    cmd.AddValue("regionSpacing", "Distance between region centres in meters", REGION_SPACING);
+    cmd.AddValue("regionRadius", "Radius of the end device disc of a region in meters", REGION_RADIUS);
+    cmd.AddValue("period", "Periodic sender interval", PERIOD_SENDER);
+    cmd.AddValue("confirmed", "Use confirmed uplinks", USE_CONFIRMED_UPLINK);
+    cmd.AddValue("nullmsg", "Use the null message synchronisation instead of the granted time window", USE_NULL_MESSAGE);
+    cmd.AddValue("sharedChannel", "Serial runs only: put all regions on one radio channel", SHARED_CHANNEL);
+    cmd.Parse(argc, argv);
+
+    /**********************
+     * Logical Processes
+     **********************/
+    uint32_t systemCount = 1;
+#ifdef NS3_MPI
+    if (USE_NULL_MESSAGE) {
+        GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::NullMessageSimulatorImpl"));
+    } else {
+        GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+    }
+    MpiInterface::Enable(&argc, &argv);
+    g_systemId = MpiInterface::GetSystemId();
+    systemCount = MpiInterface::GetSize();
+#endif
+    if (SHARED_CHANNEL && systemCount > 1) {
+        if (g_systemId == 0) {
+            NS_LOG_ERROR("--sharedChannel needs a serial run: regions on other ranks cannot share a channel");
+        }
+#ifdef NS3_MPI
+        MpiInterface::Disable();
+#endif
+        return 1;
+    }
+
+    LogComponentEnable("CT_dist", LOG_LEVEL_INFO);
+    RegionPartition partition(N_REGIONS, N_GATEWAYS_PER_REGION, N_DEVICES_PER_REGION,
+                              REGION_SPACING, REGION_RADIUS, systemCount);
+    if (g_systemId == 0) {
+        NS_LOG_INFO("Starting CT_dist: " << N_REGIONS << " regions on " << systemCount << " ranks");
+    }
+
+    /**********************
+     * Nodes Creation
+     **********************/
+    // Every rank builds the whole topology in the same order so that node ids
+    // match; only the nodes of its own regions are ever scheduled
+    const double endDeviceHeight = 1.5; // Height for end devices (meters)
+    const double gatewayHeight = 10.0;  // Height for gateways (meters)
+    Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
+    // One network server per region, at its centre; a single one on a shared channel
+    NodeContainer networkServers;
+    for (uint32_t r = 0; r < (SHARED_CHANNEL ? 1 : N_REGIONS); ++r) {
+        networkServers.Add(CreateObject<Node>(partition.GetRank(r)));
+        Vector centre = partition.GetCentre(r);
+        allocator->Add(Vector(centre.x, centre.y, gatewayHeight));
+    }
+
+    std::vector<NodeContainer> regionEndDevices(N_REGIONS);
+    std::vector<NodeContainer> regionGateways(N_REGIONS);
+    NodeContainer endDevices;
+    NodeContainer gateways;
+    for (uint32_t r = 0; r < N_REGIONS; ++r) {
+        regionEndDevices[r].Create(N_DEVICES_PER_REGION, partition.GetRank(r));
+        regionGateways[r].Create(N_GATEWAYS_PER_REGION, partition.GetRank(r));
+        endDevices.Add(regionEndDevices[r]);
+        gateways.Add(regionGateways[r]);
+    }
+    // Positions follow the node order: network servers, end devices, gateways
+    for (uint32_t r = 0; r < N_REGIONS; ++r) {
+        for (uint32_t k = 0; k < N_DEVICES_PER_REGION; ++k) {
+            allocator->Add(partition.GetDevicePosition(r, k, endDeviceHeight));
+        }
+    }
+    for (uint32_t r = 0; r < N_REGIONS; ++r) {
+        for (uint32_t k = 0; k < N_GATEWAYS_PER_REGION; ++k) {
+            allocator->Add(partition.GetGatewayPosition(r, k, gatewayHeight));
+        }
+    }
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator(allocator);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(networkServers);
+    mobility.Install(endDevices);
+    mobility.Install(gateways);
+    NS_LOG_INFO("Nodes creation complete..");
+
+    /**********************
+     * Channel and Devices Setup
+     **********************/
+    // One channel per region: a region only hears itself
+    Ptr<LoraDeviceAddressGenerator> addrGen = CreateObject<LoraDeviceAddressGenerator>(54, 1864);
+    LorawanMacHelper macHelper;
+    macHelper.SetRegion(LorawanMacHelper::EU);
+    macHelper.SetAddressGenerator(addrGen);
+    LoraHelper helper;
+
+    std::vector<Ptr<LoraChannel>> channels;
+    NetDeviceContainer endDevicesNet;
+    NetDeviceContainer gatewaysNet;
+    for (uint32_t r = 0; r < N_REGIONS; ++r) {
+        if (channels.empty() || !SHARED_CHANNEL) {
+            Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+            loss->SetPathLossExponent(3.9);
+            loss->SetReference(1.0, 32.4);
+            Ptr<NakagamiPropagationLossModel> fading = CreateObject<NakagamiPropagationLossModel>();
+            fading->SetAttribute("m0", DoubleValue(1.0));
+            fading->SetAttribute("m1", DoubleValue(1.5));
+            fading->SetAttribute("m2", DoubleValue(3.0));
+            loss->SetNext(fading);
+            Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+            channels.push_back(CreateObject<LoraChannel>(loss, delay));
+        }
+        LoraPhyHelper phyHelper;
+        phyHelper.SetChannel(channels.back());
+
+        phyHelper.SetDeviceType(LoraPhyHelper::ED);
+        macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+        endDevicesNet.Add(helper.Install(phyHelper, macHelper, regionEndDevices[r]));
+
+        phyHelper.SetDeviceType(LoraPhyHelper::GW);
+        macHelper.SetDeviceType(LorawanMacHelper::GW);
+        gatewaysNet.Add(helper.Install(phyHelper, macHelper, regionGateways[r]));
+
+        LorawanMacHelper::SetSpreadingFactorsUp(regionEndDevices[r], regionGateways[r], channels.back());
+    }
+
+    for (uint32_t i = 0; i < endDevicesNet.GetN(); ++i) {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevicesNet.Get(i));
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        if (USE_CONFIRMED_UPLINK) {
+            mac->SetMType(LorawanMacHeader::CONFIRMED_DATA_UP);
+        } else {
+            mac->SetMType(LorawanMacHeader::UNCONFIRMED_DATA_UP);
+        }
+    }
+    NS_LOG_INFO("Devices setup...");
+
+    /**********************
+     * Backbone Network Setup (Point-to-Point for gateways to NS)
+     **********************/
+    // Every gateway is linked to the server of its region, on the same rank
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    pointToPoint.SetChannelAttribute("Delay", TimeValue(MilliSeconds(2)));
+
+    std::vector<P2PGwRegistration_t> gwRegistrations(networkServers.GetN());
+    for (uint32_t r = 0; r < N_REGIONS; ++r) {
+        uint32_t server = SHARED_CHANNEL ? 0 : r;
+        for (uint32_t k = 0; k < N_GATEWAYS_PER_REGION; ++k) {
+            NetDeviceContainer p2pDevices = pointToPoint.Install(networkServers.Get(server), regionGateways[r].Get(k));
+            Ptr<PointToPointNetDevice> serverP2PNetDev = DynamicCast<PointToPointNetDevice>(p2pDevices.Get(0));
+            gwRegistrations[server].emplace_back(serverP2PNetDev, regionGateways[r].Get(k));
+        }
+    }
+
+    /**********************
+     * Local Applications and Traces
+     **********************/
+    g_uplinksSent.assign(N_REGIONS, 0);
+    g_uplinksReceived.assign(N_REGIONS, 0);
+    g_acksSent.assign(N_REGIONS, 0);
+    NodeContainer localEndDevices;
+    NodeContainer localGateways;
+    std::vector<uint32_t> localRegions;
+    for (uint32_t r = 0; r < N_REGIONS; ++r) {
+        if (partition.GetRank(r) != g_systemId) {
+            continue;
+        }
+        localRegions.push_back(r);
+        localEndDevices.Add(regionEndDevices[r]);
+        localGateways.Add(regionGateways[r]);
+        for (uint32_t k = 0; k < N_DEVICES_PER_REGION; ++k) {
+            Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(regionEndDevices[r].Get(k)->GetDevice(0));
+            loraNetDevice->GetPhy()->TraceConnectWithoutContext("StartSending", MakeBoundCallback(&OnEndDeviceStartSending, r));
+        }
+        for (uint32_t k = 0; k < N_GATEWAYS_PER_REGION; ++k) {
+            Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(regionGateways[r].Get(k)->GetDevice(0));
+            loraNetDevice->GetPhy()->TraceConnectWithoutContext("ReceivedPacket", MakeBoundCallback(&OnGatewayReceivedPacket, r));
+            loraNetDevice->GetPhy()->TraceConnectWithoutContext("StartSending", MakeBoundCallback(&OnGatewayStartSending, r));
+        }
+    }
+
+    ForwarderHelper forwarderHelper;
+    forwarderHelper.Install(localGateways);
+    for (uint32_t i = 0; i < networkServers.GetN(); ++i) {
+        if (networkServers.Get(i)->GetSystemId() != g_systemId) {
+            continue;
+        }
+        NetworkServerHelper networkServerHelper;
+        networkServerHelper.SetGatewaysP2P(gwRegistrations[i]);
+        networkServerHelper.SetEndDevices(SHARED_CHANNEL ? endDevices : regionEndDevices[i]);
+        networkServerHelper.Install(networkServers.Get(i));
+    }
+
+    // The helper draws the start offsets of the local devices only, which
+    // depends on the rank count; draw them for every device in the same order
+    // on every rank instead, from a fixed stream
+    PeriodicSenderHelper periodicSenderHelper;
+    periodicSenderHelper.SetPeriod(PERIOD_SENDER);
+    periodicSenderHelper.SetPacketSize(24);
+    Ptr<UniformRandomVariable> startOffset = CreateObject<UniformRandomVariable>();
+    startOffset->SetStream(0);
+    ApplicationContainer apps;
+    for (uint32_t r = 0; r < N_REGIONS; ++r) {
+        for (uint32_t k = 0; k < N_DEVICES_PER_REGION; ++k) {
+            double offset = startOffset->GetValue(0, PERIOD_SENDER.GetSeconds());
+            if (partition.GetRank(r) != g_systemId) {
+                continue;
+            }
+            ApplicationContainer app = periodicSenderHelper.Install(regionEndDevices[r].Get(k));
+            DynamicCast<PeriodicSender>(app.Get(0))->SetInitialDelay(Seconds(offset));
+            apps.Add(app);
+        }
+    }
+    apps.Start(Seconds(0));
+    apps.Stop(Hours(SIM_END_HOURS));
+    NS_LOG_INFO("Rank " << g_systemId << ": " << localRegions.size() << " regions, "
+                << localEndDevices.GetN() << " end devices, " << localGateways.GetN() << " gateways");
+
+    Simulator::Stop(Hours(SIM_END_HOURS));
+    auto wallStart = std::chrono::steady_clock::now();
+    Simulator::Run();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    Simulator::Destroy();
+
+    /**********************
+     * Summary (rank 0)
+     **********************/
+    std::cout << "Rank " << g_systemId << " simulated " << localRegions.size() << " regions in "
+              << wallSeconds << " s wall clock" << std::endl;
+    ReduceSum(g_uplinksSent);
+    ReduceSum(g_uplinksReceived);
+    ReduceSum(g_acksSent);
+    double slowestRank = ReduceMax(wallSeconds);
+
+    if (g_systemId == 0) {
+        std::cout << "================= REGION SUMMARY =================\n";
+        uint64_t sent = 0;
+        uint64_t received = 0;
+        uint64_t acks = 0;
+        for (uint32_t r = 0; r < N_REGIONS; ++r) {
+            std::cout << "Region " << r << " (rank " << partition.GetRank(r) << "): sent " << g_uplinksSent[r]
+                      << ", received " << g_uplinksReceived[r] << ", ACKs " << g_acksSent[r] << "\n";
+            sent += g_uplinksSent[r];
+            received += g_uplinksReceived[r];
+            acks += g_acksSent[r];
+        }
+        std::cout << "Total: sent " << sent << ", received " << received << " ("
+                  << std::fixed << std::setprecision(2) << (sent > 0 ? 100.0 * received / sent : 0.0)
+                  << "%), ACKs " << acks << "\n";
+        std::cout << "Slowest rank: " << slowestRank << " s wall clock on " << systemCount << " ranks"
+                  << (SHARED_CHANNEL ? ", shared channel" : "") << "\n";
+        std::cout << "==================================================\n";
+    }
+
+#ifdef NS3_MPI
+    MpiInterface::Disable();
+#endif
+    return 0;
+}
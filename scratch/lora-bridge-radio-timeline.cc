@@ -0,0 +1,235 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Analyses a radio state timeline written by RadioTimelineRecorder.
+//
+// For every device it reports the time spent in each state, the RX window
+// duty, the idle listening cost (receive windows that ended without a
+// downlink) and, for every uplink that got no downlink in RX1 or RX2, the
+// most likely cause seen by the device radio. The causes assume confirmed
+// uplinks: for unconfirmed traffic "no downlink" is the normal outcome.
+// Example:
+//
+//   ./ns3 run "lora-bridge-radio-timeline --input=adr_bridge-radio.bin"
+
+#include "lora-bridge/lib/radio-timeline.h"
+
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("LoraBridgeRadioTimeline");
+
+/// Why an uplink got no downlink in its receive windows
+enum MissCause
+{
+    MISS_NO_DOWNLINK,    //!< Nothing reached the radio during the windows
+    MISS_OUTSIDE_WINDOW, //!< A downlink arrived while no window was open
+    MISS_MISMATCH,       //!< A downlink used another frequency or SF
+    MISS_SENSITIVITY,    //!< A downlink arrived below sensitivity
+    MISS_INTERFERENCE,   //!< A downlink collided
+    MISS_COUNT
+};
+
+static const char* MISS_NAMES[MISS_COUNT] =
+    {"no downlink", "outside window", "wrong freq/SF", "under sensitivity", "interference"};
+
+/// Analysis state and results of one device
+struct DeviceTimeline
+{
+    uint8_t state = RADIO_SLEEP;   //!< Current state code
+    uint64_t since = 0;            //!< Entry time of the current state (us)
+    double stateTime[6] = {0};     //!< Time per state code (s)
+    int window = 0;                //!< Open receive window: 1, 2, or 0 for none
+    uint64_t windowStart = 0;      //!< Opening time of the open window (us)
+    bool windowReceived = false;   //!< Whether the open window got a downlink
+    uint64_t windows[2] = {0, 0};  //!< RX1 and RX2 windows opened
+    uint64_t idleWindows = 0;      //!< Windows closed without a downlink
+    double idleTime = 0.0;         //!< Time in windows without a downlink (s)
+    bool uplinkOpen = false;       //!< Whether an uplink is waiting for its windows
+    bool uplinkAnswered = false;   //!< Whether the current uplink got a downlink
+    int uplinkEvent = -1;          //!< Highest-ranked loss cause of the current uplink
+    uint64_t uplinks = 0;          //!< Uplinks seen
+    uint64_t answered = 0;         //!< Uplinks with a downlink in RX1 or RX2
+    uint64_t misses[MISS_COUNT] = {0}; //!< Unanswered uplinks per cause
+};
+
+/// Close the accounting of the uplink of @p device
+static void
+CloseUplink(DeviceTimeline& device)
+{
+    if (!device.uplinkOpen)
+    {
+        return;
+    }
+    if (device.uplinkAnswered)
+    {
+        device.answered++;
+    }
+    else
+    {
+        device.misses[device.uplinkEvent < 0 ? MISS_NO_DOWNLINK : device.uplinkEvent]++;
+    }
+    device.uplinkOpen = false;
+}
+
+/// Move @p device to state @p code at time @p now
+static void
+EnterState(DeviceTimeline& device, uint8_t code, uint64_t now)
+{
+    if (device.state <= RADIO_RX)
+    {
+        device.stateTime[device.state] += (now - device.since) * 1e-6;
+    }
+
+    // Demodulating a downlink does not close the window it started in
+    int window = code == RADIO_RX1 ? 1 : code == RADIO_RX2 ? 2 : code == RADIO_RX ? device.window : 0;
+    if (window != device.window)
+    {
+        if (device.window != 0 && !device.windowReceived)
+        {
+            device.idleWindows++;
+            device.idleTime += (now - device.windowStart) * 1e-6;
+        }
+        if (window != 0)
+        {
+            device.windows[window - 1]++;
+            device.windowStart = now;
+            device.windowReceived = false;
+        }
+        device.window = window;
+    }
+    device.state = code;
+    device.since = now;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string input = "radio-timeline.bin";
+    double voltage = 3.3;
+    double rxCurrent = 0.011;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Radio timeline file", input);
+    cmd.AddValue("voltage", "Supply voltage (V) for the idle listening cost", voltage);
+    cmd.AddValue("rxCurrent", "Receive current (A) for the idle listening cost", rxCurrent);
+    cmd.Parse(argc, argv);
+
+    RadioTimelineReader reader;
+    if (!reader.Open(input))
+    {
+        NS_LOG_UNCOND("Could not read radio timeline " << input);
+        return 1;
+    }
+
+    std::vector<DeviceTimeline> devices(reader.GetDeviceCount());
+    RadioTimelineReader::Entry entry;
+    uint64_t end = 0;
+    uint64_t records = 0;
+    while (reader.Next(entry))
+    {
+        records++;
+        end = entry.microseconds;
+        if (entry.device >= devices.size())
+        {
+            devices.resize(entry.device + 1);
+        }
+        DeviceTimeline& device = devices[entry.device];
+
+        if (entry.code >= RADIO_EVENT_RECEIVED)
+        {
+            bool inWindow = device.window != 0;
+            if (entry.code == RADIO_EVENT_RECEIVED && inWindow)
+            {
+                device.windowReceived = true;
+                device.uplinkAnswered = true;
+                continue;
+            }
+            int cause = MISS_OUTSIDE_WINDOW;
+            if (inWindow)
+            {
+                cause = entry.code == RADIO_EVENT_INTERFERENCE  ? MISS_INTERFERENCE
+                        : entry.code == RADIO_EVENT_SENSITIVITY ? MISS_SENSITIVITY
+                                                                : MISS_MISMATCH;
+            }
+            // Keep the highest-ranked cause: events inside a window rank above the others
+            if (device.uplinkOpen && cause > device.uplinkEvent)
+            {
+                device.uplinkEvent = cause;
+            }
+            continue;
+        }
+
+        EnterState(device, entry.code, entry.microseconds);
+        if (entry.code == RADIO_TX)
+        {
+            CloseUplink(device);
+            device.uplinkOpen = true;
+            device.uplinkAnswered = false;
+            device.uplinkEvent = -1;
+            device.uplinks++;
+        }
+    }
+    for (auto& device : devices)
+    {
+        EnterState(device, RADIO_SLEEP, end);
+        CloseUplink(device);
+    }
+
+    double total = end * 1e-6;
+    std::cout << "Radio timeline " << input << ": " << records << " records, " << devices.size()
+              << " devices, " << total << " s\n\n";
+    std::cout << std::left << std::setw(8) << "Device" << std::setw(10) << "TX (s)" << std::setw(10)
+              << "RX1 (s)" << std::setw(10) << "RX2 (s)" << std::setw(10) << "Demod (s)"
+              << std::setw(12) << "RX duty (%)" << std::setw(14) << "Idle windows" << std::setw(14) << "Idle cost (J)" << std::setw(10)
+              << "Uplinks" << std::setw(10) << "Answered";
+    for (const char* name : MISS_NAMES)
+    {
+        std::cout << std::setw(20) << name;
+    }
+    std::cout << "\n";
+
+    DeviceTimeline fleet;
+    for (uint32_t i = 0; i < devices.size(); ++i)
+    {
+        const DeviceTimeline& device = devices[i];
+        double windowTime = device.stateTime[RADIO_RX1] + device.stateTime[RADIO_RX2] +
+                            device.stateTime[RADIO_RX];
+        std::cout << std::setw(8) << i << std::setw(10) << device.stateTime[RADIO_TX] << std::setw(10)
+                  << device.stateTime[RADIO_RX1] << std::setw(10) << device.stateTime[RADIO_RX2]
+                  << std::setw(10) << device.stateTime[RADIO_RX]
+                  << std::setw(12) << (total > 0 ? 100.0 * windowTime / total : 0.0) << std::setw(14)
+                  << device.idleWindows << std::setw(14) << device.idleTime * rxCurrent * voltage
+                  << std::setw(10) << device.uplinks << std::setw(10) << device.answered;
+        for (int c = 0; c < MISS_COUNT; ++c)
+        {
+            std::cout << std::setw(20) << device.misses[c];
+            fleet.misses[c] += device.misses[c];
+        }
+        std::cout << "\n";
+        fleet.uplinks += device.uplinks;
+        fleet.answered += device.answered;
+        fleet.idleWindows += device.idleWindows;
+        fleet.idleTime += device.idleTime;
+        fleet.windows[0] += device.windows[0];
+        fleet.windows[1] += device.windows[1];
+    }
+
+    std::cout << "\nFleet: " << fleet.windows[0] << " RX1 and " << fleet.windows[1] << " RX2 windows, "
+              << fleet.idleWindows << " idle (" << fleet.idleTime * rxCurrent * voltage << " J), "
+              << fleet.answered << "/" << fleet.uplinks << " uplinks answered\n";
+    std::cout << "Missed downlinks:";
+    for (int c = 0; c < MISS_COUNT; ++c)
+    {
+        std::cout << " " << MISS_NAMES[c] << " " << fleet.misses[c] << (c + 1 < MISS_COUNT ? "," : "\n");
+    }
+    return 0;
+}
@@ -0,0 +1,477 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Renders the result records written by the bridge scenarios as LaTeX, CSV
+// or JSON. One record gives its full report; several records give a
+// comparison table with one row per run, holding the parameters that differ
+// between the runs and their scalar results. Examples:
+//
+//   ./ns3 run "lora-bridge-report --records=run.rec --format=latex --output=run.tex"
+//   ./ns3 run "lora-bridge-report --store=results-store --format=csv --scalars=failureRate,retryEnergy"
+
+#include "lora-bridge/lib/result-record.h"
+#include "lora-bridge/lib/results-store.h"
+
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("LoraBridgeReport");
+
+/// Cross-run comparison: one row per record
+struct Comparison
+{
+    std::vector<std::string> columns;           //!< Column names
+    std::vector<std::vector<std::string>> rows; //!< Formatted cells
+};
+
+/// @return @p list split on commas, without empty items
+static std::vector<std::string>
+SplitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * @return @p value as an integer when it is one. Otherwise, for LaTeX, six
+ * significant digits, in scientific notation for very small or large values;
+ * for CSV and JSON, enough digits to read the exact value back.
+ */
+static std::string
+FormatValue(double value, bool latex)
+{
+    std::ostringstream oss;
+    if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 1e15)
+    {
+        oss << static_cast<long long>(value);
+    }
+    else if (latex)
+    {
+        oss << std::setprecision(6) << value;
+    }
+    else
+    {
+        oss << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+    }
+    return oss.str();
+}
+
+/// @return @p text as a JSON string literal
+static std::string
+QuoteJson(const std::string& text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/// @return @p text quoted for CSV if needed
+static std::string
+QuoteCsv(const std::string& text)
+{
+    if (text.find_first_of(",\"\n") == std::string::npos)
+    {
+        return text;
+    }
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        quoted += c;
+        if (c == '"')
+        {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+/// @return A JSON number, null for values JSON cannot represent
+static std::string
+JsonNumber(double value)
+{
+    return std::isfinite(value) ? FormatValue(value, false) : "null";
+}
+
+/**
+ * Build the comparison of @p records: the parameters that differ between
+ * runs, then the requested scalars (all of them if @p scalars is empty),
+ * formatted for LaTeX if @p latex.
+ */
+static Comparison
+Compare(const std::vector<ResultRecord>& records, const std::vector<std::string>& scalars, bool latex)
+{
+    std::set<std::string> keys;
+    for (const auto& record : records)
+    {
+        for (const auto& parameter : record.GetParameters())
+        {
+            keys.insert(parameter.first);
+        }
+    }
+    std::vector<std::string> varying;
+    for (const auto& key : keys)
+    {
+        if (key == "key" || key == "build")
+        {
+            continue;
+        }
+        for (const auto& record : records)
+        {
+            if (record.GetParameter(key) != records[0].GetParameter(key))
+            {
+                varying.push_back(key);
+                break;
+            }
+        }
+    }
+
+    std::vector<std::string> names = scalars;
+    if (names.empty())
+    {
+        for (const auto& record : records)
+        {
+            for (const auto& scalar : record.GetScalars())
+            {
+                if (std::find(names.begin(), names.end(), scalar.first) == names.end())
+                {
+                    names.push_back(scalar.first);
+                }
+            }
+        }
+    }
+
+    Comparison comparison;
+    comparison.columns.push_back("run");
+    comparison.columns.insert(comparison.columns.end(), varying.begin(), varying.end());
+    comparison.columns.insert(comparison.columns.end(), names.begin(), names.end());
+    for (const auto& record : records)
+    {
+        std::vector<std::string> row{record.GetParameter("key")};
+        for (const auto& key : varying)
+        {
+            row.push_back(record.GetParameter(key));
+        }
+        for (const auto& name : names)
+        {
+            double value;
+            row.push_back(record.GetScalar(name, value) ? FormatValue(value, latex) : "");
+        }
+        comparison.rows.push_back(row);
+    }
+    return comparison;
+}
+
+/// Write a booktabs tabular
+static void
+LatexTable(std::ostream& os,
+           const std::vector<std::string>& columns,
+           const std::vector<std::vector<std::string>>& rows)
+{
+    os << "\\begin{tabular}{" << std::string(columns.size(), 'c') << "}\n"
+       << "\\toprule\n";
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+        os << (c ? " & " : "") << EscapeLatex(columns[c]);
+    }
+    os << " \\\\\n"
+       << "\\midrule\n";
+    for (const auto& row : rows)
+    {
+        for (size_t c = 0; c < row.size(); ++c)
+        {
+            os << (c ? " & " : "") << EscapeLatex(row[c]);
+        }
+        os << " \\\\\n";
+    }
+    os << "\\bottomrule\n"
+       << "\\end{tabular}\n";
+}
+
+/// Write the sections of one record
+static void
+LatexRecord(std::ostream& os, const ResultRecord& record, const std::string& section)
+{
+    os << "\\" << section << "{Simulation Parameters}\n";
+    for (const auto& parameter : record.GetParameters())
+    {
+        os << EscapeLatex(parameter.first) << ": " << EscapeLatex(parameter.second) << "\\\\\n";
+    }
+    os << "\n\\" << section << "{Results}\n";
+    std::vector<std::vector<std::string>> scalars;
+    for (const auto& scalar : record.GetScalars())
+    {
+        scalars.push_back({scalar.first, FormatValue(scalar.second, true)});
+    }
+    LatexTable(os, {"Result", "Value"}, scalars);
+    os << "\n";
+    for (const auto& table : record.GetTables())
+    {
+        os << "\\" << section << "{" << EscapeLatex(table.title) << "}\n";
+        std::vector<std::vector<std::string>> rows;
+        for (const auto& values : table.rows)
+        {
+            std::vector<std::string> row;
+            for (double value : values)
+            {
+                row.push_back(FormatValue(value, true));
+            }
+            rows.push_back(row);
+        }
+        LatexTable(os, table.columns, rows);
+        os << "\n";
+    }
+}
+
+static void
+RenderLatex(std::ostream& os, const std::vector<ResultRecord>& records, bool details, const Comparison& comparison)
+{
+    os << "\\documentclass{article}\n"
+       << "\\usepackage{booktabs}\n"
+       << "\\usepackage{graphicx}\n"
+       << "\\usepackage{geometry}\n"
+       << "\\geometry{a4paper, margin=1in}\n"
+       << "\\begin{document}\n";
+    if (records.size() == 1)
+    {
+        LatexRecord(os, records[0], "section");
+    }
+    else
+    {
+        os << "\\section{Comparison}\n"
+           << "\\resizebox{\\textwidth}{!}{%\n";
+        LatexTable(os, comparison.columns, comparison.rows);
+        os << "}\n\n";
+        for (size_t i = 0; details && i < records.size(); ++i)
+        {
+            os << "\\section{Run " << records[i].GetParameter("key") << "}\n";
+            LatexRecord(os, records[i], "subsection");
+        }
+    }
+    os << "\\end{document}\n";
+}
+
+static void
+RenderCsv(std::ostream& os, const std::vector<ResultRecord>& records, const Comparison& comparison)
+{
+    if (records.size() > 1)
+    {
+        for (size_t c = 0; c < comparison.columns.size(); ++c)
+        {
+            os << (c ? "," : "") << QuoteCsv(comparison.columns[c]);
+        }
+        os << "\n";
+        for (const auto& row : comparison.rows)
+        {
+            for (size_t c = 0; c < row.size(); ++c)
+            {
+                os << (c ? "," : "") << QuoteCsv(row[c]);
+            }
+            os << "\n";
+        }
+        return;
+    }
+
+    // One record: the scalars, then each table after a "# title" line
+    os << "result,value\n";
+    for (const auto& scalar : records[0].GetScalars())
+    {
+        os << QuoteCsv(scalar.first) << "," << FormatValue(scalar.second, false) << "\n";
+    }
+    for (const auto& table : records[0].GetTables())
+    {
+        os << "\n# " << table.title << "\n";
+        for (size_t c = 0; c < table.columns.size(); ++c)
+        {
+            os << (c ? "," : "") << QuoteCsv(table.columns[c]);
+        }
+        os << "\n";
+        for (const auto& row : table.rows)
+        {
+            for (size_t c = 0; c < row.size(); ++c)
+            {
+                os << (c ? "," : "") << FormatValue(row[c], false);
+            }
+            os << "\n";
+        }
+    }
+}
+
+static void
+RenderJson(std::ostream& os, const std::vector<ResultRecord>& records, const Comparison& comparison)
+{
+    os << "{\n  \"records\": [";
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const ResultRecord& record = records[i];
+        os << (i ? "," : "") << "\n    {\n      \"parameters\": {";
+        size_t n = 0;
+        for (const auto& parameter : record.GetParameters())
+        {
+            os << (n++ ? ", " : "") << QuoteJson(parameter.first) << ": " << QuoteJson(parameter.second);
+        }
+        os << "},\n      \"scalars\": {";
+        n = 0;
+        for (const auto& scalar : record.GetScalars())
+        {
+            os << (n++ ? ", " : "") << QuoteJson(scalar.first) << ": " << JsonNumber(scalar.second);
+        }
+        os << "},\n      \"tables\": {";
+        n = 0;
+        for (const auto& table : record.GetTables())
+        {
+            os << (n++ ? "," : "") << "\n        " << QuoteJson(table.name) << ": {\"title\": "
+               << QuoteJson(table.title) << ", \"columns\": [";
+            for (size_t c = 0; c < table.columns.size(); ++c)
+            {
+                os << (c ? ", " : "") << QuoteJson(table.columns[c]);
+            }
+            os << "], \"rows\": [";
+            for (size_t r = 0; r < table.rows.size(); ++r)
+            {
+                os << (r ? ", " : "") << "[";
+                for (size_t c = 0; c < table.rows[r].size(); ++c)
+                {
+                    os << (c ? ", " : "") << JsonNumber(table.rows[r][c]);
+                }
+                os << "]";
+            }
+            os << "]}";
+        }
+        os << "\n      }\n    }";
+    }
+    os << "\n  ]";
+    if (records.size() > 1)
+    {
+        os << ",\n  \"comparison\": {\"columns\": [";
+        for (size_t c = 0; c < comparison.columns.size(); ++c)
+        {
+            os << (c ? ", " : "") << QuoteJson(comparison.columns[c]);
+        }
+        os << "], \"rows\": [";
+        for (size_t r = 0; r < comparison.rows.size(); ++r)
+        {
+            os << (r ? "," : "") << "\n    [";
+            for (size_t c = 0; c < comparison.rows[r].size(); ++c)
+            {
+                os << (c ? ", " : "") << QuoteJson(comparison.rows[r][c]);
+            }
+            os << "]";
+        }
+        os << "\n  ]}";
+    }
+    os << "\n}\n";
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string recordList;
+    std::string storeDir;
+    std::string format = "latex";
+    std::string output;
+    std::string scalarList;
+    bool details = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("records", "Comma-separated result records to render", recordList);
+    cmd.AddValue("store", "Render every record of this results store", storeDir);
+    cmd.AddValue("format", "latex, csv or json", format);
+    cmd.AddValue("output", "File to write (default: standard output)", output);
+    cmd.AddValue("scalars", "Comma-separated scalars to compare (default: all)", scalarList);
+    cmd.AddValue("details", "With several records, also render each record in full (LaTeX)", details);
+    cmd.Parse(argc, argv);
+
+    std::vector<std::string> paths = SplitList(recordList);
+    if (!storeDir.empty())
+    {
+        ResultsStore store(storeDir);
+        for (const auto& key : store.GetKeys())
+        {
+            paths.push_back(store.GetArtifact(key));
+        }
+    }
+
+    std::vector<ResultRecord> records;
+    for (const auto& path : paths)
+    {
+        ResultRecord record;
+        if (!record.Read(path))
+        {
+            NS_LOG_UNCOND("Skipping " << path << ": not a result record");
+            continue;
+        }
+        records.push_back(record);
+    }
+    if (records.empty())
+    {
+        NS_LOG_UNCOND("No result records to render");
+        return 1;
+    }
+
+    Comparison comparison;
+    if (records.size() > 1)
+    {
+        comparison = Compare(records, SplitList(scalarList), format == "latex");
+    }
+
+    std::ofstream file;
+    if (!output.empty())
+    {
+        file.open(output);
+        if (!file)
+        {
+            NS_LOG_UNCOND("Could not open " << output);
+            return 1;
+        }
+    }
+    std::ostream& os = output.empty() ? std::cout : file;
+
+    if (format == "latex")
+    {
+        RenderLatex(os, records, details, comparison);
+    }
+    else if (format == "csv")
+    {
+        RenderCsv(os, records, comparison);
+    }
+    else if (format == "json")
+    {
+        RenderJson(os, records, comparison);
+    }
+    else
+    {
+        NS_LOG_UNCOND("Unknown format " << format);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,324 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Adaptive parameter sweep of a bridge scenario. Starts from a space-filling
+// design over the given parameter ranges and refines, batch by batch, where
+// a scalar of the result records changes most or is least certain, to
+// locate the coverage and capacity cliffs with few runs. Each run is one
+// invocation of the scenario program, several at a time, sharing a results
+// store: runs already in the store are not simulated again. Example:
+//
+//   ./ns3 run "lora-bridge-sweep --program=<path of the built CT_dev>
+//       --dimensions=gwX:-800:-100,nDevices:10:200:int --metric=failureRate
+//       --args=--simHours=6 --rounds=6 --output=sweep.csv"
+
+#include "lora-bridge/lib/adaptive-sampler.h"
+#include "lora-bridge/lib/result-record.h"
+#include "lora-bridge/lib/results-store.h"
+
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("LoraBridgeSweep");
+
+/// One invocation of the scenario program
+struct Job
+{
+    size_t sample = 0;                                        //!< Sample of the sampler
+    uint64_t run = 0;                                         //!< RNG run
+    std::string command;                                      //!< Shell command
+    std::string keyFile;                                      //!< Where the program writes the run key
+    bool failed = false;                                      //!< Whether the program exited with an error
+    double value = std::numeric_limits<double>::quiet_NaN(); //!< Metric, NaN if the run failed
+};
+
+/// @return @p list split on @p separator, without empty items
+static std::vector<std::string>
+Split(const std::string& list, char separator)
+{
+    std::vector<std::string> items;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, separator))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * Parse "name:min:max[:int]" items into the dimensions of @p sampler.
+ *
+ * @return Whether every item was valid.
+ */
+static bool
+ParseDimensions(const std::string& list, AdaptiveSampler& sampler)
+{
+    for (const auto& item : Split(list, ','))
+    {
+        std::vector<std::string> fields = Split(item, ':');
+        if (fields.size() < 3 || fields.size() > 4 || (fields.size() == 4 && fields[3] != "int"))
+        {
+            NS_LOG_UNCOND("Invalid dimension " << item << ", expected name:min:max[:int]");
+            return false;
+        }
+        try
+        {
+            sampler.AddDimension(fields[0], std::stod(fields[1]), std::stod(fields[2]), fields.size() == 4);
+        }
+        catch (const std::exception&)
+        {
+            NS_LOG_UNCOND("Invalid range in dimension " << item);
+            return false;
+        }
+    }
+    return !sampler.GetDimensions().empty();
+}
+
+/// @return The value as the scenario stores it in its configuration, so that the run keys match
+static std::string
+FormatParameter(double value)
+{
+    ScenarioConfig config;
+    config.Set("value", value);
+    return config.Get("value");
+}
+
+/**
+ * Reserve a key file in the store, unique even among sweeps sharing the store.
+ *
+ * @return Its path, also the base of the job's log file
+ */
+static std::string
+MakeKeyFile(const ResultsStore& store, uint32_t jobIndex)
+{
+    std::string path = store.GetPath("sweep-job" + std::to_string(jobIndex) + "-XXXXXX");
+    int fd = mkstemp(&path[0]);
+    if (fd < 0)
+    {
+        // Still distinct from the other sweeps running now
+        return store.GetPath("sweep-" + std::to_string(getpid()) + "-job" + std::to_string(jobIndex) + ".key");
+    }
+    close(fd);
+    return path;
+}
+
+/// Run @p jobs on @p nWorkers threads, then read their metric from the store
+static void
+RunJobs(std::vector<Job>& jobs, uint32_t nWorkers, const ResultsStore& store, const std::string& metric)
+{
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (uint32_t w = 0; w < nWorkers; ++w)
+    {
+        workers.emplace_back([&jobs, &next]() {
+            for (size_t j = next++; j < jobs.size(); j = next++)
+            {
+                if (std::system(jobs[j].command.c_str()) != 0)
+                {
+                    jobs[j].failed = true; // Do not trust a key written before the failure
+                }
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    for (auto& job : jobs)
+    {
+        std::string key;
+        std::ifstream keys(job.keyFile);
+        bool found = !job.failed && std::getline(keys, key) && store.Contains(key);
+        keys.close();
+        std::remove(job.keyFile.c_str());
+        if (!found)
+        {
+            NS_LOG_UNCOND("Run " << job.run << " of sample " << job.sample << " failed: " << job.command);
+            continue;
+        }
+        ResultRecord record;
+        double value;
+        if (!record.Read(store.GetArtifact(key)) || !record.GetScalar(metric, value))
+        {
+            NS_LOG_UNCOND("Run " << key << " has no scalar " << metric);
+            continue;
+        }
+        job.value = value;
+    }
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string program;
+    std::string dimensionList;
+    std::string metric = "failureRate";
+    std::string extraArgs;
+    std::string storeDir = "results-store";
+    std::string output;
+    uint32_t initialPoints = 0;
+    uint32_t rounds = 5;
+    uint32_t batchSize = 0;
+    uint32_t replications = 2;
+    uint32_t jobCount = 0;
+    uint64_t firstRun = 1;
+    uint64_t seed = 1;
+    double resolution = 1.0 / 64;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("program", "Scenario executable, called with --name=value per dimension", program);
+    cmd.AddValue("dimensions", "Comma-separated name:min:max[:int] parameter ranges", dimensionList);
+    cmd.AddValue("metric", "Scalar of the result record to refine on", metric);
+    cmd.AddValue("args", "Arguments passed to every run", extraArgs);
+    cmd.AddValue("store", "Results store shared by the runs", storeDir);
+    cmd.AddValue("output", "CSV file of the samples (default: standard output)", output);
+    cmd.AddValue("initial", "Points of the space-filling design (0 = 5 per dimension)", initialPoints);
+    cmd.AddValue("rounds", "Refinement rounds after the initial design", rounds);
+    cmd.AddValue("batch", "Points or replications proposed per round (0 = one per job)", batchSize);
+    cmd.AddValue("replications", "Runs per new point, and added to an uncertain one", replications);
+    cmd.AddValue("jobs", "Runs at the same time (0 = number of cores)", jobCount);
+    cmd.AddValue("firstRun", "RNG run of the first replication of every point", firstRun);
+    cmd.AddValue("seed", "Seed of the initial design", seed);
+    cmd.AddValue("resolution", "Smallest spacing between two points, as a fraction of each range", resolution);
+    cmd.Parse(argc, argv);
+
+    AdaptiveSampler sampler;
+    if (program.empty() || !ParseDimensions(dimensionList, sampler))
+    {
+        NS_LOG_UNCOND("Need --program and --dimensions");
+        return 1;
+    }
+    const auto& dimensions = sampler.GetDimensions();
+    if (initialPoints == 0)
+    {
+        initialPoints = 5 * dimensions.size();
+    }
+    if (jobCount == 0)
+    {
+        jobCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (batchSize == 0)
+    {
+        batchSize = jobCount;
+    }
+    sampler.SetSeed(seed);
+    sampler.SetResolution(resolution);
+
+    ResultsStore store(storeDir);
+    std::vector<uint64_t> nextRun; // Per sample
+    uint32_t jobIndex = 0;
+    uint32_t failed = 0;
+    std::vector<AdaptiveSampler::Proposal> proposals = sampler.Start(initialPoints, replications);
+    for (uint32_t round = 0; !proposals.empty(); ++round)
+    {
+        std::vector<Job> jobs;
+        for (const auto& proposal : proposals)
+        {
+            nextRun.resize(sampler.GetSamples().size(), firstRun);
+            const AdaptiveSampler::Sample& sample = sampler.GetSamples()[proposal.sample];
+            for (uint32_t r = 0; r < proposal.replications; ++r)
+            {
+                Job job;
+                job.sample = proposal.sample;
+                job.run = nextRun[proposal.sample]++;
+                job.keyFile = MakeKeyFile(store, jobIndex);
+                std::ostringstream command;
+                command << program << " --resultsStore=" << storeDir << " --RngRun=" << job.run
+                        << " --keyFile=" << job.keyFile;
+                for (size_t k = 0; k < dimensions.size(); ++k)
+                {
+                    command << " --" << dimensions[k].name << "=" << FormatParameter(sample.x[k]);
+                }
+                command << " " << extraArgs << " > " << job.keyFile << ".log 2>&1";
+                job.command = command.str();
+                jobs.push_back(job);
+                jobIndex++;
+            }
+        }
+
+        RunJobs(jobs, jobCount, store, metric);
+        for (const auto& job : jobs)
+        {
+            if (std::isnan(job.value))
+            {
+                failed++;
+                continue;
+            }
+            sampler.AddResult(job.sample, job.value);
+        }
+        NS_LOG_UNCOND((round == 0 ? "Initial design: " : "Round " + std::to_string(round) + ": ")
+                      << proposals.size() << " proposals, " << jobs.size() << " runs, "
+                      << sampler.GetSamples().size() << " points so far");
+        if (round >= rounds)
+        {
+            break;
+        }
+        proposals = sampler.Refine(batchSize, replications);
+    }
+
+    std::ofstream file;
+    if (!output.empty())
+    {
+        file.open(output);
+        if (!file)
+        {
+            NS_LOG_UNCOND("Could not open " << output);
+            return 1;
+        }
+    }
+    std::ostream& os = output.empty() ? std::cout : file;
+    os << std::setprecision(10);
+    for (const auto& dimension : dimensions)
+    {
+        os << dimension.name << ",";
+    }
+    os << "runs," << metric << ",stdError\n";
+    for (const auto& sample : sampler.GetSamples())
+    {
+        for (double x : sample.x)
+        {
+            os << x << ",";
+        }
+        os << sample.values.size() << "," << sample.GetMean() << "," << sample.GetStandardError() << "\n";
+    }
+
+    // The steepest links bracket the cliffs
+    std::cout << "================= STEEPEST LINKS =================\n";
+    std::vector<AdaptiveSampler::Edge> edges = sampler.GetEdges();
+    for (size_t e = 0; e < std::min<size_t>(edges.size(), 5); ++e)
+    {
+        const AdaptiveSampler::Sample& a = sampler.GetSamples()[edges[e].a];
+        const AdaptiveSampler::Sample& b = sampler.GetSamples()[edges[e].b];
+        for (size_t k = 0; k < dimensions.size(); ++k)
+        {
+            std::cout << (k ? ", " : "") << dimensions[k].name << " " << a.x[k] << " -> " << b.x[k];
+        }
+        std::cout << ": " << metric << " " << a.GetMean() << " -> " << b.GetMean() << "\n";
+    }
+    std::cout << "Runs: " << jobIndex << ", failed: " << failed << "\n";
+    std::cout << "==================================================\n";
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,1489 @@
+//Utilities
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+#include "ns3/application.h"
+#include "ns3/callback.h"
+#include "ns3/simulator.h"
+#include "ns3/names.h"
+#include "ns3/rng-seed-manager.h"
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <memory>
+#include <limits>
+#include <chrono>
+//Losses
+#include "ns3/propagation-module.h"
+//Device mobility and position
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/netanim-module.h"
+#include "ns3/animation-interface.h"
+//LoRa End Devices and Gateways
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/gateway-lora-phy.h"
+#include "ns3/gateway-lorawan-mac.h"
+#include "ns3/lora-helper.h"
+#include "ns3/class-a-end-device-lorawan-mac.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/lora-phy.h"
+#include "ns3/lora-tag.h"
+//Energy Models
+//Periodic Sender
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+// Network Server and Forwarder
+#include "ns3/network-server.h"
+// Bridge traffic models
+#include "lora-bridge/lib/arrival-process.h"
+#include "lora-bridge/lib/trace-replay.h"
+#include "lora-bridge/lib/period-reconfigurator.h"
+#include "lora-bridge/lib/retransmission-stats.h"
+#include "lora-bridge/lib/downlink-budget-component.h"
+#include "lora-bridge/lib/results-store.h"
+#include "lora-bridge/lib/result-record.h"
+#include "lora-bridge/lib/async-trace.h"
+#include "lora-bridge/lib/memory-footprint.h"
+#include "lora-bridge/lib/interference-tracker.h"
+#include "lora-bridge/lib/dedup-window.h"
+#include "lora-bridge/lib/sf-allocator.h"
+#include "lora-bridge/lib/channel-stats.h"
+#include "lora-bridge/lib/channel-plan.h"
+#include "lora-bridge/lib/lora-bridge-scenario.h"
+#include "lora-bridge/lib/fork-server.h"
+#include "lora-bridge/lib/biased-nakagami-loss-model.h"
+#include "lora-bridge/lib/rare-event-estimator.h"
+#include "lora-bridge/lib/counting-scheduler.h"
+#include "lora-bridge/lib/progress-reporter.h"
+#include "lora-bridge/lib/scheduler-tuner.h"
+//Namespaces
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("CT_dev");
+
+/**********************
+ * Global simulation parameters (defaults, overridable from the command line)
+ **********************/
+static uint32_t SIM_END_HOURS = 24;          // Total simulation time in hours
+static uint32_t N_END_DEVICES = 20;          // Number of end devices
+static uint32_t N_GATEWAYS = 1;             // Number of gateways
+static Time PERIOD_SENDER = Minutes(15);    // Periodic sender interval
+static double GATEWAY_X_POS = -800.0;        // Gateway X coordinate in meters
+static double GATEWAY_Y_POS = 100.0;          // Gateway Y coordinate in meters
+// Global variable to toggle confirmed/unconfirmed messages
+static bool USE_CONFIRMED_UPLINK = true;    // true = confirmed, false = unconfirmed
+// Global variable to toggle increased polling at 12th hour
+static bool ENABLE_12TH_HOUR_POLLING = false; // true = enable increased polling, false = maintain default period
+static Time POLLING_PERIOD = Seconds(90);    // Reporting period during the 12th hour
+static uint32_t N_PERIOD_GROUPS = 1;         // Device groups for the period schedule (device i is in group i % N)
+// Placement of the first send after a period change: "Random" or "Slotted" offsets inside the new period
+static std::string PERIOD_REPHASE_MODE = "Random";
+// Traffic model of the end devices: "periodic", "jitter", "poisson" or "mmpp"
+static std::string TRAFFIC_MODEL = "periodic";
+static Time PERIOD_JITTER = Seconds(30);     // Maximum deviation from PERIOD_SENDER for the "jitter" model
+// Global variable to toggle spatially correlated event storms (e.g. a truck crossing the bridge)
+static bool ENABLE_EVENT_STORMS = false;     // true = storms trigger extra uplinks, false = no storms
+static Time STORM_MEAN_INTERVAL = Hours(1);  // Mean time between two storms
+static int64_t TRAFFIC_STREAM_BASE = 1000;   // First RNG stream used by the traffic models
+// Binary arrival trace to replay (see lora-bridge-trace-convert); empty = use TRAFFIC_MODEL
+static std::string REPLAY_TRACE_FILE = "";
+static Time REPLAY_LOOKAHEAD = Seconds(60);  // Only trace records this far ahead are in the event queue
+// Global variable to toggle the duty-cycle-aware downlink scheduler at the network server
+static bool ENABLE_DOWNLINK_BUDGET = false;  // true = RX1/RX2 chosen per reply within the sub-band budgets
+// Global variable to toggle asynchronous trace processing (same results, bookkeeping off the simulator thread)
+static bool ENABLE_ASYNC_TRACES = false;     // true = sinks queue records for a background thread, false = inline
+static uint32_t TRACE_RING_SIZE = 65536;     // Records the trace ring holds (32 bytes each)
+// Global variable to toggle the memory accounting report
+static bool ENABLE_MEMORY_REPORT = false;    // true = footprint per category after setup, during and after the run
+static Time MEMORY_REPORT_INTERVAL = Hours(6); // Time between two footprint reports during the run
+// Global variable to toggle the interference analytics (overlaps, capture, loss causes at the gateway)
+static bool ENABLE_INTERFERENCE_TRACKING = false; // true = classify gateway losses, false = count sent/received only
+static Time INTERFERENCE_WINDOW = Hours(1);  // Statistics window of the interference analytics
+// "distance" = lowest SF the link supports (SetSpreadingFactorsUp), "airtime" = balance the airtime over the SFs
+static std::string SF_ALLOCATION = "distance";
+static double SF_LINK_MARGIN = 5.0;           // Margin over the gateway sensitivity the airtime allocation keeps (dB)
+static uint32_t N_CHANNELS = 3;               // EU868 uplink channels: 3 = default plan, up to 8 with 867.1-867.9 MHz
+static uint32_t CHANNELS_PER_DEVICE = 0;      // Channels each device may use, balanced by airtime (0 = all)
+// Replications forked from one set-up, with runs RngRun, RngRun + 1, ...; replication N draws what a single run N does
+static uint32_t FORK_RUNS = 0;                // 0 = a single run in this process
+static uint32_t FORK_JOBS = 0;                // Replications running at the same time (0 = number of cores)
+static bool FORK_CHECK = false;               // true = also run every replication from its own set-up and compare
+
+static double RARE_EVENT_BIAS_DB = 0.0;       // Uplink fading bias of the importance sampling mode (dB, 0 = off)
+
+static double PROGRESS_INTERVAL = 0.0;        // Wall-clock seconds between two progress samples (0 = off)
+static std::string PROGRESS_FILE = "CT_dev.prom"; // Prometheus text file of the progress samples ("" = stderr only)
+
+// Event scheduler: Map, Heap, Calendar, List, PriorityQueue, or auto to time each on a prefix of the run
+static std::string SCHEDULER = "Map";
+static Time SCHEDULER_PREFIX = Hours(1);       // Simulated time each scheduler is timed on in auto mode
+
+/**********************
+ * Global variables
+ **********************/
+static std::vector<uint32_t> g_ackCount;
+static DedupWindow receivedPacketIds; // track uniques over the most recent packet ids
+static std::vector<double> hourlyToA_RX1;  // Gateway ToA in RX1 per hour of simulation (seconds)
+static std::vector<double> hourlyToA_RX2;  // Gateway ToA in RX2 per hour of simulation (seconds)
+static std::vector<double> hourlyEndDeviceToA;  // Furthest end device ToA per hour of simulation (seconds)
+static uint32_t furthestDeviceIndex = 0;  // Index of furthest end device
+static RetransmissionStats retransmissionStats;  // Attempts, failures and retry cost per node and SF
+static AsyncTraceProcessor traceProcessor;  // Runs ProcessTraceRecord when ENABLE_ASYNC_TRACES
+static MemoryFootprint memoryFootprint;  // Memory per category when ENABLE_MEMORY_REPORT
+static InterferenceTracker interferenceTracker;  // Uplink intervals per channel and SF when ENABLE_INTERFERENCE_TRACKING
+static std::vector<double> meanRxPowerDbm;  // Mean receive power of each end device at gateway 0, without fading
+static ChannelStats channelStats;  // Uplink and downlink airtime and gateway outcomes per frequency
+static RareEventEstimator rareEventEstimator;  // Weighted loss samples per node when RARE_EVENT_BIAS_DB > 0
+static Time rareEventSpan;  // Draws a gateway outcome is weighted with: twice the longest uplink
+
+//Packet Tracking
+std::vector<int> packetsSent(6, 0);     // DR5 -> DR0
+std::vector<int> packetsReceived(6, 0);
+static PacketSenderRing packetSenders;  // sender node id of the most recent packet ids
+std::vector<int> packetsReceivedPerNode;
+
+
+/**********************
+ * Utility Functions
+ **********************/
+Ptr<ArrivalProcess> CreateArrivalProcess(const std::string& model, Time period) {
+    if (model == "poisson") {
+        Ptr<PoissonArrivalProcess> process = CreateObject<PoissonArrivalProcess>();
+        process->SetMeanInterval(period);
+        return process;
+    }
+    if (model == "mmpp") {
+        Ptr<MmppArrivalProcess> process = CreateObject<MmppArrivalProcess>();
+        process->SetMeanInterval(period);
+        return process;
+    }
+    if (model != "periodic" && model != "jitter") {
+        NS_LOG_ERROR("Unknown traffic model " << model << ", using periodic");
+    }
+    Ptr<PeriodicArrivalProcess> process = CreateObject<PeriodicArrivalProcess>();
+    process->SetMeanInterval(period);
+    if (model == "jitter") {
+        process->SetAttribute("Jitter", TimeValue(PERIOD_JITTER));
+    }
+    return process;
+}
+
+void FindFurthestDevice(NodeContainer endDevices, NodeContainer gateways) {
+    Ptr<Node> gateway = gateways.Get(0);  // Assume single gateway
+    Ptr<MobilityModel> gatewayMobility = gateway->GetObject<MobilityModel>();
+    Vector gatewayPos = gatewayMobility->GetPosition();
+    double maxDistance = 0.0;
+
+    for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+        Ptr<Node> device = endDevices.Get(i);
+        Ptr<MobilityModel> deviceMobility = device->GetObject<MobilityModel>();
+        Vector devicePos = deviceMobility->GetPosition();
+        double distance = std::sqrt(std::pow(devicePos.x - gatewayPos.x, 2) +
+                                    std::pow(devicePos.y - gatewayPos.y, 2) +
+                                    std::pow(devicePos.z - gatewayPos.z, 2));
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            furthestDeviceIndex = i;
+        }
+    }
+    NS_LOG_INFO("Furthest end device is index " << furthestDeviceIndex << " at distance " << maxDistance << " meters");
+}
+
+/**********************
+ * Trace bookkeeping
+ **********************/
+// The PHY sinks copy what they need into a TraceRecord; ProcessTraceRecord does the
+// bookkeeping, inline or on the trace processor thread. It must not touch ns-3 objects.
+enum TraceKind : uint8_t {
+    TRACE_ED_PHY_TX,      // End device PHY started sending
+    TRACE_ED_NEW_PACKET,  // Furthest end device MAC sent a new packet
+    TRACE_GW_PHY_TX,      // Gateway PHY started sending
+    TRACE_GW_PHY_RX,      // Gateway PHY received a packet
+    TRACE_GW_PHY_LOST_INTERFERENCE,  // Gateway PHY lost a packet to interference
+    TRACE_GW_PHY_LOST_SENSITIVITY,   // Gateway PHY lost a packet below sensitivity
+    TRACE_GW_PHY_LOST_NO_RECEIVER,   // Gateway PHY had no free reception path
+};
+
+TraceRecord MakeTraceRecord(uint8_t kind, uint32_t node, Ptr<const Packet> packet) {
+    TraceRecord record = {};
+    record.timeNs = Simulator::Now().GetNanoSeconds();
+    record.node = node;
+    record.kind = kind;
+    record.size = packet->GetSize();
+    packet->CopyData(record.header, sizeof(record.header));
+    LoraTag tag;
+    if (packet->PeekPacketTag(tag)) {
+        record.sf = tag.GetSpreadingFactor();
+        record.frequency = static_cast<uint32_t>(tag.GetFrequency());
+    }
+    return record;
+}
+
+void AddHourlyToA(std::vector<double>& hourly, int64_t timeNs, double toa) {
+    size_t hour = timeNs / 3600000000000LL;
+    if (hour >= hourly.size()) {
+        hourly.resize(hour + 1, 0.0);
+    }
+    hourly[hour] += toa;
+}
+
+void ProcessTraceRecord(const TraceRecord& record) {
+    switch (record.kind) {
+    case TRACE_GW_PHY_TX: {
+        // MType is the top 3 bits of the MHDR, the ACK bit is 0x20 of FCtrl (byte 5)
+        uint8_t mType = record.header[0] >> 5;
+        if ((mType == LorawanMacHeader::UNCONFIRMED_DATA_DOWN || mType == LorawanMacHeader::CONFIRMED_DATA_DOWN)
+            && (record.header[5] & 0x20)) {
+            if (record.node >= g_ackCount.size()) {
+                g_ackCount.resize(record.node + 1, 0);
+            }
+            g_ackCount[record.node]++;
+        }
+        uint8_t sf = (record.sf >= 7 && record.sf <= 12) ? record.sf : 7;
+        double toa = CalculateTimeOnAir(record.size, sf, 125000.0, 1, true, true, 8);
+        AddHourlyToA(record.frequency == 869525000 ? hourlyToA_RX2 : hourlyToA_RX1, record.timeNs, toa);
+        channelStats.AddDownlink(record.frequency, toa);
+        break;
+    }
+    case TRACE_ED_NEW_PACKET: {
+        uint8_t sf = (record.sf >= 7 && record.sf <= 12) ? record.sf : 7;
+        double toa = CalculateTimeOnAir(record.size, sf, 125000.0, 1, true, true, 8);
+        AddHourlyToA(hourlyEndDeviceToA, record.timeNs, toa);
+        break;
+    }
+    case TRACE_ED_PHY_TX: {
+        int idx = record.sf - 7;
+        if (idx >= 0 && idx < 6) {
+            packetsSent.at(idx)++;
+        }
+        if (record.packetId != 0) {
+            packetSenders.Set(record.packetId, record.node);
+        }
+        if (idx < 0 || idx >= 6) {
+            break;
+        }
+        double toa = CalculateTimeOnAir(record.size, record.sf, 125000.0, 1, true, true, 8);
+        channelStats.AddUplink(record.frequency, toa);
+        if (ENABLE_INTERFERENCE_TRACKING && record.packetId != 0) {
+            interferenceTracker.AddTransmission(record.packetId, record.frequency, record.sf, record.timeNs,
+                                                static_cast<int64_t>(toa * 1e9), meanRxPowerDbm.at(record.node));
+        }
+        break;
+    }
+    case TRACE_GW_PHY_RX: {
+        int idx = record.sf - 7;
+        if (idx >= 0 && idx < 6) {
+            packetsReceived.at(idx)++;
+        }
+        channelStats.AddReception(record.frequency);
+        if (ENABLE_INTERFERENCE_TRACKING) {
+            interferenceTracker.RecordOutcome(record.packetId, InterferenceTracker::RECEIVED);
+        }
+        if (record.packetId == 0 || !receivedPacketIds.Insert(record.packetId)) {
+            break;
+        }
+        uint32_t sender;
+        if (packetSenders.Get(record.packetId, sender) && sender < packetsReceivedPerNode.size()) {
+            packetsReceivedPerNode[sender]++;
+        }
+        break;
+    }
+    case TRACE_GW_PHY_LOST_INTERFERENCE:
+        channelStats.AddLoss(record.frequency, ChannelStats::LOST_INTERFERENCE);
+        if (ENABLE_INTERFERENCE_TRACKING) {
+            // Attributed to same-SF or inter-SF interference from the overlaps
+            interferenceTracker.RecordOutcome(record.packetId, InterferenceTracker::LOST_UNATTRIBUTED);
+        }
+        break;
+    case TRACE_GW_PHY_LOST_SENSITIVITY:
+        channelStats.AddLoss(record.frequency, ChannelStats::LOST_SENSITIVITY);
+        if (ENABLE_INTERFERENCE_TRACKING) {
+            interferenceTracker.RecordOutcome(record.packetId, InterferenceTracker::LOST_SENSITIVITY);
+        }
+        break;
+    case TRACE_GW_PHY_LOST_NO_RECEIVER:
+        channelStats.AddLoss(record.frequency, ChannelStats::LOST_NO_RECEIVER);
+        if (ENABLE_INTERFERENCE_TRACKING) {
+            interferenceTracker.RecordOutcome(record.packetId, InterferenceTracker::LOST_NO_RECEIVER);
+        }
+        break;
+    }
+}
+
+void DispatchTraceRecord(const TraceRecord& record) {
+    if (ENABLE_ASYNC_TRACES) {
+        traceProcessor.Push(record);
+    } else {
+        ProcessTraceRecord(record);
+    }
+}
+
+/**********************
+ * Ack tracing callback
+ **********************/
+void OnGatewayAck(uint32_t gwIndex, Ptr<const Packet> p) {
+    if (gwIndex >= g_ackCount.size()) {
+        g_ackCount.resize(gwIndex + 1, 0);
+    }
+    g_ackCount[gwIndex]++;
+    //NS_LOG_INFO("Gateway " << gwIndex
+    //            << " sent ACK at " << Simulator::Now().GetSeconds() << "s");
+}
+
+/**********************
+ * Gateway PHY StartSending tracer (detect downlink ACKs)
+ **********************/
+// ACK counting and ToA per receive window are done in ProcessTraceRecord
+void OnGatewayPhyStartSending(uint32_t gwIndex, Ptr<const Packet> packet, uint32_t phyIndex) {
+    TraceRecord record = MakeTraceRecord(TRACE_GW_PHY_TX, gwIndex, packet);
+    if (record.sf == 0) {
+        NS_LOG_ERROR("No LoraTag found for gateway " << gwIndex << ", forcing SF7");
+    }
+    DispatchTraceRecord(record);
+}
+
+void OnEndDeviceSentNewPacket(uint32_t deviceIndex, Ptr<EndDeviceLorawanMac> mac, Ptr<const Packet> packet) {
+    if (deviceIndex != furthestDeviceIndex) {
+        return;  // Only the furthest device is checked against the duty cycle
+    }
+    TraceRecord record = MakeTraceRecord(TRACE_ED_NEW_PACKET, deviceIndex, packet);
+    if (record.sf < 7 || record.sf > 12) {
+        // Fall back to the DR-based SF
+        uint8_t dr = mac->GetDataRate();
+        NS_LOG_ERROR("No valid LoraTag SF for end device " << deviceIndex << " packet, using DR" << unsigned(dr));
+        record.sf = (dr <= 5) ? (12 - dr) : 7;
+    }
+    DispatchTraceRecord(record);
+}
+
+/**********************
+ * Duty Cycle Check
+ **********************/
+// Hour @p hour covers [hour, hour + 1) hours of simulation time
+void CheckGatewayDutyCycle(uint32_t hour) {
+    double maxToA_RX1 = 36.0;  // 1% of 3600 seconds (ETSI limit for RX1 in EU868 sub-bands g1/g2)
+    double maxToA_RX2 = 360.0; // 10% of 3600 seconds (ETSI limit for RX2 in EU868 sub-band g3)
+    hourlyToA_RX1.resize(std::max<size_t>(hourlyToA_RX1.size(), hour + 1), 0.0);
+    hourlyToA_RX2.resize(std::max<size_t>(hourlyToA_RX2.size(), hour + 1), 0.0);
+    double toaRx1 = hourlyToA_RX1[hour];
+    double toaRx2 = hourlyToA_RX2[hour];
+    NS_LOG_INFO("DutyCycleChecker: Gateway RX1 time on air in hour " << hour + 1 << ": " << toaRx1 << " seconds");
+    if (toaRx1 <= maxToA_RX1) {
+        NS_LOG_INFO("DutyCycleChecker: Gateway RX1 compliant with ETSI 1% duty cycle.");
+    } else {
+        NS_LOG_INFO("DutyCycleChecker: Gateway RX1 non-compliant with ETSI 1% duty cycle (exceeds 36s).");
+    }
+    NS_LOG_INFO("DutyCycleChecker: Gateway RX2 time on air in hour " << hour + 1 << ": " << toaRx2 << " seconds");
+    if (toaRx2 <= maxToA_RX2) {
+        NS_LOG_INFO("DutyCycleChecker: Gateway RX2 compliant with ETSI 10% duty cycle.");
+    } else {
+        NS_LOG_INFO("DutyCycleChecker: Gateway RX2 non-compliant with ETSI 10% duty cycle (exceeds 360s).");
+    }
+}
+
+void CheckEndDeviceDutyCycle(uint32_t hour) {
+    double maxToA = 36.0;  // 1% of 3600 seconds (ETSI limit for EU868 sub-band)
+    hourlyEndDeviceToA.resize(std::max<size_t>(hourlyEndDeviceToA.size(), hour + 1), 0.0);
+    double toa = hourlyEndDeviceToA[hour];
+    NS_LOG_INFO("DutyCycleChecker: Furthest end device total time on air in hour " << hour + 1 << ": " << toa << " seconds");
+    if (toa <= maxToA) {
+        NS_LOG_INFO("DutyCycleChecker: Furthest end device compliant with ETSI 1% duty cycle.");
+    } else {
+        NS_LOG_INFO("DutyCycleChecker: Furthest end device non-compliant with ETSI 1% duty cycle (exceeds 36s).");
+    }
+}
+
+// Inline bookkeeping: check each hour as soon as it is over
+void ScheduleDutyCycleChecks(uint32_t hour) {
+    CheckGatewayDutyCycle(hour);
+    CheckEndDeviceDutyCycle(hour);
+    if (hour + 1 < SIM_END_HOURS) {
+        Simulator::Schedule(Seconds(3600.0), &ScheduleDutyCycleChecks, hour + 1);
+    }
+}
+
+/***************
+ * Callbacks for tracing packets at PHY layer
+ ***************/
+void OnTransmissionCallback(uint32_t deviceIndex, Ptr<const Packet> packet, uint32_t phyIndex) {
+    TraceRecord record = MakeTraceRecord(TRACE_ED_PHY_TX, deviceIndex, packet);
+    UniquePacketIdTag idTag;
+    if (packet->PeekPacketTag(idTag)) {
+        record.packetId = idTag.GetId();
+    }
+    DispatchTraceRecord(record);
+}
+
+void OnPacketReceptionCallback(Ptr<const Packet> packet, uint32_t phyIndex) {
+    TraceRecord record = MakeTraceRecord(TRACE_GW_PHY_RX, 0, packet);
+    UniquePacketIdTag idTag;
+    if (packet->PeekPacketTag(idTag)) {
+        record.packetId = idTag.GetId();
+    }
+    DispatchTraceRecord(record);
+}
+
+// Gateway losses, for the channel statistics and the interference analytics; kind is one of the TRACE_GW_PHY_LOST_* values
+void OnGatewayPhyLoss(uint8_t kind, Ptr<const Packet> packet, uint32_t phyIndex) {
+    TraceRecord record = MakeTraceRecord(kind, 0, packet);
+    UniquePacketIdTag idTag;
+    if (packet->PeekPacketTag(idTag)) {
+        record.packetId = idTag.GetId();
+    }
+    DispatchTraceRecord(record);
+}
+
+// Importance sampling: one sample per uplink transmission, one outcome per gateway
+void OnRareEventTransmission(uint32_t deviceIndex, Ptr<const Packet> packet, uint32_t phyIndex) {
+    UniquePacketIdTag idTag;
+    if (packet->PeekPacketTag(idTag)) {
+        rareEventEstimator.StartTransmission(idTag.GetId(), deviceIndex);
+    }
+}
+
+void OnRareEventOutcome(Ptr<BiasedNakagamiLossModel> fading, Ptr<MobilityModel> gateway, bool received,
+                        Ptr<const Packet> packet, uint32_t phyIndex) {
+    UniquePacketIdTag idTag;
+    if (packet->PeekPacketTag(idTag)) {
+        rareEventEstimator.AddOutcome(idTag.GetId(), received, fading->GetLogWeight(gateway, rareEventSpan));
+    }
+}
+
+void OnEventStorm(ApplicationContainer* apps, uint32_t deviceIndex) {
+    Ptr<TaggingPeriodicSender> sender = DynamicCast<TaggingPeriodicSender>(apps->Get(deviceIndex));
+    if (sender) {
+        sender->SendEventPacket();
+    }
+}
+
+void OnRephaseSender(ApplicationContainer* apps, uint32_t deviceIndex, Time period, Time phase) {
+    Ptr<TaggingPeriodicSender> sender = DynamicCast<TaggingPeriodicSender>(apps->Get(deviceIndex));
+    if (sender) {
+        sender->Rephase(period, phase);
+    }
+}
+
+void OnReplayArrival(ApplicationContainer* apps, uint32_t deviceId, uint32_t payloadSize) {
+    if (deviceId >= apps->GetN()) {
+        return;  // Field device without a simulated counterpart
+    }
+    Ptr<TaggingPeriodicSender> sender = DynamicCast<TaggingPeriodicSender>(apps->Get(deviceId));
+    if (sender) {
+        sender->SendExternalPacket(payloadSize);
+    }
+}
+
+void OnMacPacketOutcome(uint32_t deviceIndex, Ptr<EndDeviceLorawanMac> mac, uint8_t transmissions, bool successful, Time firstAttempt, Ptr<Packet> packet) {
+    uint8_t dr = mac->GetDataRate();
+    uint8_t sf = (dr <= 5) ? (12 - dr) : 7;
+    double toa = CalculateTimeOnAir(packet->GetSize(), sf, 125000.0, 1, true, true, 8);
+    retransmissionStats.RecordOutcome(deviceIndex, sf, transmissions, successful, Simulator::Now() - firstAttempt, toa);
+    NS_LOG_DEBUG("Uplink of end device " << deviceIndex << (successful ? " succeeded" : " failed")
+                 << " after " << unsigned(transmissions) << " attempts.");
+}
+
+/**********************
+ * Set-up steps redone after the fork point
+ **********************/
+// SF of every end device, from its data rate
+std::vector<uint8_t> GetSpreadingFactors(NodeContainer endDevices) {
+    std::vector<uint8_t> spreadingFactors;
+    for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevices.Get(i)->GetDevice(0));
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        uint8_t sf = 12 - mac->GetDataRate();
+        if (sf < 7 || sf > 12) {
+            NS_LOG_ERROR("Invalid SF for node " << i << ": " << unsigned(sf));
+            sf = 7;
+        }
+        spreadingFactors.push_back(sf);
+        NS_LOG_INFO("End device " << i << " assigned SF" << unsigned(sf));
+    }
+    return spreadingFactors;
+}
+
+// Channel mask of every end device, balancing the expected airtime at the given SFs
+std::vector<uint32_t> PlanChannels(ChannelPlan& channelPlan, ApplicationContainer& apps,
+                                   const std::vector<Ptr<ArrivalProcess>>& arrivalProcesses,
+                                   const std::vector<uint8_t>& spreadingFactors) {
+    std::vector<uint32_t> masks;
+    for (uint32_t i = 0; i < apps.GetN(); ++i) {
+        Ptr<TaggingPeriodicSender> app = DynamicCast<TaggingPeriodicSender>(apps.Get(i));
+        double load = CalculateTimeOnAir(app->GetUplinkSize(), spreadingFactors[i]) /
+                      arrivalProcesses[i]->GetMeanInterval().GetSeconds();
+        masks.push_back(channelPlan.AddDevice(load));
+    }
+    return masks;
+}
+
+/**********************
+ * Fork Check
+ **********************/
+// Legacy record name of this scenario, with the run when several runs write records
+std::string GetRecordName(bool withRun) {
+    std::ostringstream oss;
+    oss << "CT_dev_";
+    oss << (USE_CONFIRMED_UPLINK ? "confirmed" : "unconfirmed") << "_";
+    oss << (ENABLE_12TH_HOUR_POLLING ? "increasedPolling" : "noPolling") << "_";
+    oss << "gwX" << static_cast<int>(GATEWAY_X_POS)<< "m_";
+    oss << "Ndev" << static_cast<int>(N_END_DEVICES);
+    if (withRun) {
+        oss << "_run" << RngSeedManager::GetRun();  // Replications would overwrite each other
+    }
+    return oss.str();
+}
+
+// Whether two records hold the same results; NaN matches NaN
+bool SameValues(const std::vector<double>& a, const std::vector<double>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] != b[i] && !(std::isnan(a[i]) && std::isnan(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SameResults(const ResultRecord& a, const ResultRecord& b) {
+    if (a.GetScalars().size() != b.GetScalars().size() || a.GetTables().size() != b.GetTables().size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.GetScalars().size(); ++i) {
+        if (a.GetScalars()[i].first != b.GetScalars()[i].first
+            || !SameValues({a.GetScalars()[i].second}, {b.GetScalars()[i].second})) {
+            return false;
+        }
+    }
+    for (size_t t = 0; t < a.GetTables().size(); ++t) {
+        const ResultRecord::Table& ta = a.GetTables()[t];
+        const ResultRecord::Table& tb = b.GetTables()[t];
+        if (ta.name != tb.name || ta.rows.size() != tb.rows.size()) {
+            return false;
+        }
+        for (size_t r = 0; r < ta.rows.size(); ++r) {
+            if (!SameValues(ta.rows[r], tb.rows[r])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**********************
+ * Memory Accounting
+ **********************/
+// Fleet sizes the footprint is projected to
+static const std::vector<uint32_t> MEMORY_PROJECTION_FLEETS = {1000, 10000, 100000};
+
+void UpdateTrackedFootprint() {
+    memoryFootprint.SetTracked("receivedPacketIds", receivedPacketIds.GetBytes());
+    memoryFootprint.SetTracked("packetSenders", packetSenders.GetBytes());
+    memoryFootprint.SetTracked("per-node counters", MemoryFootprint::EstimateBytes(packetsReceivedPerNode));
+    memoryFootprint.SetTracked("hourly ToA", MemoryFootprint::EstimateBytes(hourlyToA_RX1)
+                               + MemoryFootprint::EstimateBytes(hourlyToA_RX2)
+                               + MemoryFootprint::EstimateBytes(hourlyEndDeviceToA));
+}
+
+void ReportMemoryFootprint() {
+    // The tracking structures belong to the trace processor thread until it is stopped
+    if (!ENABLE_ASYNC_TRACES) {
+        UpdateTrackedFootprint();
+    }
+    std::ostringstream label;
+    label << "t = " << Simulator::Now().GetHours() << " h";
+    memoryFootprint.Report(std::cout, label.str(), MEMORY_PROJECTION_FLEETS);
+    if (Simulator::Now() + MEMORY_REPORT_INTERVAL < Hours(SIM_END_HOURS)) {
+        Simulator::Schedule(MEMORY_REPORT_INTERVAL, &ReportMemoryFootprint);
+    }
+}
+
+/***************
+ * Main simulation code
+ ***************/
+int main(int argc, char *argv[]) {
+    std::string resultsStoreDir = "results-store";
+    bool forceRun = false;
+    bool checkOnly = false;
+    std::string keyFile;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("simHours", "Total simulation time in hours", SIM_END_HOURS);
+    cmd.AddValue("nDevices", "Number of end devices", N_END_DEVICES);
+    cmd.AddValue("nGateways", "Number of gateways", N_GATEWAYS);
+    cmd.AddValue("period", "Periodic sender interval", PERIOD_SENDER);
+    cmd.AddValue("gwX", "Gateway X coordinate in meters", GATEWAY_X_POS);
+    cmd.AddValue("gwY", "Gateway Y coordinate in meters", GATEWAY_Y_POS);
+    cmd.AddValue("confirmed", "Use confirmed uplinks", USE_CONFIRMED_UPLINK);
+    cmd.AddValue("polling", "Increase polling at the 12th hour", ENABLE_12TH_HOUR_POLLING);
+    cmd.AddValue("pollingPeriod", "Reporting period during the 12th hour", POLLING_PERIOD);
+    cmd.AddValue("periodGroups", "Device groups for the period schedule", N_PERIOD_GROUPS);
+    cmd.AddValue("rephaseMode", "Random or Slotted rephasing after a period change", PERIOD_REPHASE_MODE);
+    cmd.AddValue("trafficModel", "periodic, jitter, poisson or mmpp", TRAFFIC_MODEL);
+    cmd.AddValue("periodJitter", "Maximum deviation from the period for the jitter model", PERIOD_JITTER);
+    cmd.AddValue("storms", "Enable event storms", ENABLE_EVENT_STORMS);
+    cmd.AddValue("stormInterval", "Mean time between two storms", STORM_MEAN_INTERVAL);
+    cmd.AddValue("trafficStream", "First RNG stream used by the traffic models", TRAFFIC_STREAM_BASE);
+    cmd.AddValue("replayTrace", "Binary arrival trace to replay", REPLAY_TRACE_FILE);
+    cmd.AddValue("replayLookahead", "Replay scheduling window", REPLAY_LOOKAHEAD);
+    cmd.AddValue("downlinkBudget", "Enable the duty-cycle-aware downlink scheduler", ENABLE_DOWNLINK_BUDGET);
+    cmd.AddValue("asyncTraces", "Do the trace bookkeeping on a background thread", ENABLE_ASYNC_TRACES);
+    cmd.AddValue("traceRingSize", "Records the trace ring holds", TRACE_RING_SIZE);
+    cmd.AddValue("interference", "Classify gateway losses with the interference analytics", ENABLE_INTERFERENCE_TRACKING);
+    cmd.AddValue("interferenceWindow", "Statistics window of the interference analytics", INTERFERENCE_WINDOW);
+    cmd.AddValue("sfAllocation", "distance or airtime", SF_ALLOCATION);
+    cmd.AddValue("sfMargin", "Link margin kept by the airtime SF allocation (dB)", SF_LINK_MARGIN);
+    cmd.AddValue("channels", "EU868 uplink channels, 3 to 8", N_CHANNELS);
+    cmd.AddValue("channelsPerDevice", "Channels each device may use (0 = all)", CHANNELS_PER_DEVICE);
+    cmd.AddValue("forkRuns", "Replications forked from one set-up (0 = single run)", FORK_RUNS);
+    cmd.AddValue("forkJobs", "Replications running at the same time (0 = number of cores)", FORK_JOBS);
+    cmd.AddValue("forkCheck", "Also run every forked replication from its own set-up and check that the records match", FORK_CHECK);
+    cmd.AddValue("rareEventBias", "Uplink fading bias towards loss for importance sampling (dB, 0 = off)", RARE_EVENT_BIAS_DB);
+    cmd.AddValue("progressInterval", "Wall-clock seconds between two progress samples (0 = off)", PROGRESS_INTERVAL);
+    cmd.AddValue("progressFile", "Prometheus text file of the progress samples (empty = stderr only)", PROGRESS_FILE);
+    cmd.AddValue("scheduler", "Map, Heap, Calendar, List, PriorityQueue or auto", SCHEDULER);
+    cmd.AddValue("schedulerPrefix", "Simulated time each scheduler is timed on in auto mode", SCHEDULER_PREFIX);
+    cmd.AddValue("memoryReport", "Report the memory footprint per category", ENABLE_MEMORY_REPORT);
+    cmd.AddValue("memoryReportInterval", "Time between two footprint reports during the run", MEMORY_REPORT_INTERVAL);
+    cmd.AddValue("resultsStore", "Results store directory (empty = write to the working directory)", resultsStoreDir);
+    cmd.AddValue("force", "Run even if the results store already has this run", forceRun);
+    cmd.AddValue("checkOnly", "Only query the results store: exit 0 if the run is done, 1 otherwise", checkOnly);
+    cmd.AddValue("keyFile", "Write the results-store key of every run to this file, one per line", keyFile);
+    cmd.Parse(argc, argv);
+
+    /**********************
+     * Results Store Lookup
+     **********************/
+    // Every parameter that changes the outcome of the run goes into the key
+    ScenarioConfig config;
+    config.Set("scenario", std::string("CT_dev"));
+    config.Set("simHours", SIM_END_HOURS);
+    config.Set("nDevices", N_END_DEVICES);
+    config.Set("nGateways", N_GATEWAYS);
+    config.Set("period", PERIOD_SENDER);
+    config.Set("gwX", GATEWAY_X_POS);
+    config.Set("gwY", GATEWAY_Y_POS);
+    config.Set("confirmed", USE_CONFIRMED_UPLINK);
+    config.Set("polling", ENABLE_12TH_HOUR_POLLING);
+    config.Set("pollingPeriod", POLLING_PERIOD);
+    config.Set("periodGroups", N_PERIOD_GROUPS);
+    config.Set("rephaseMode", PERIOD_REPHASE_MODE);
+    config.Set("trafficModel", TRAFFIC_MODEL);
+    config.Set("periodJitter", PERIOD_JITTER);
+    config.Set("storms", ENABLE_EVENT_STORMS);
+    config.Set("stormInterval", STORM_MEAN_INTERVAL);
+    config.Set("trafficStream", TRAFFIC_STREAM_BASE);
+    config.Set("replayTrace", REPLAY_TRACE_FILE);
+    config.Set("replayLookahead", REPLAY_LOOKAHEAD);
+    config.Set("downlinkBudget", ENABLE_DOWNLINK_BUDGET);
+    config.Set("interference", ENABLE_INTERFERENCE_TRACKING);  // Adds tables to the record
+    config.Set("interferenceWindow", INTERFERENCE_WINDOW);
+    config.Set("sfAllocation", SF_ALLOCATION);
+    config.Set("sfMargin", SF_LINK_MARGIN);
+    config.Set("channels", N_CHANNELS);
+    config.Set("channelsPerDevice", CHANNELS_PER_DEVICE);
+    config.Set("rareEventBias", RARE_EVENT_BIAS_DB);  // Adds a table to the record
+    std::string runKey = config.GetKey(RngSeedManager::GetSeed(), RngSeedManager::GetRun(), LORA_BRIDGE_BUILD_ID);
+
+    std::unique_ptr<ResultsStore> resultsStore;
+    if (!resultsStoreDir.empty()) {
+        resultsStore = std::make_unique<ResultsStore>(resultsStoreDir);
+    }
+
+    // This run, or the FORK_RUNS replications starting at it, minus those already in the store
+    ForkServer forkServer;
+    forkServer.SetMaxChildren(FORK_JOBS);
+    ForkServer standaloneServer;
+    standaloneServer.SetMaxChildren(FORK_JOBS);
+    uint64_t firstRun = RngSeedManager::GetRun();
+    std::vector<std::string> runKeys;
+    for (uint64_t run = firstRun; run < firstRun + std::max<uint32_t>(FORK_RUNS, 1); ++run) {
+        std::string key = config.GetKey(RngSeedManager::GetSeed(), run, LORA_BRIDGE_BUILD_ID);
+        runKeys.push_back(key);
+        if (resultsStore && resultsStore->Contains(key) && (checkOnly || !forceRun)) {
+            if (!checkOnly) {
+                std::cout << "Run " << key << " already in " << resultsStoreDir << ": "
+                          << resultsStore->GetArtifact(key) << std::endl;
+            }
+            continue;
+        }
+        forkServer.AddRun(run);
+        standaloneServer.AddRun(run);
+    }
+    // Lets a sweep driver find the records of its runs, whether they were just simulated or already stored
+    if (!keyFile.empty()) {
+        std::ofstream keys(keyFile);
+        for (const auto& key : runKeys) {
+            keys << key << "\n";
+        }
+    }
+    if (checkOnly) {
+        return (resultsStore && forkServer.GetRunCount() == 0) ? 0 : 1;
+    }
+    if (forkServer.GetRunCount() == 0) {
+        return 0;
+    }
+
+    // The fork check first runs every replication as a single run, each in a child forked before
+    // anything is built; the records are compared once the forked replications are done
+    bool standalone = false;
+    if (FORK_RUNS > 0 && FORK_CHECK) {
+        if (standaloneServer.Serve()) {
+            standalone = true;
+            FORK_RUNS = 0;
+            runKey = config.GetKey(RngSeedManager::GetSeed(), RngSeedManager::GetRun(), LORA_BRIDGE_BUILD_ID);
+        } else if (standaloneServer.GetFailedCount() > 0) {
+            NS_LOG_ERROR(standaloneServer.GetFailedCount() << " single runs of the fork check failed");
+            return 1;
+        }
+    }
+
+    LogComponentEnable("CT_dev", LOG_LEVEL_INFO);
+    LogComponentEnable("LoraBridgeScenario", LOG_LEVEL_INFO);
+    //LogComponentEnable("NetworkServer", LOG_LEVEL_ALL);
+    //LogComponentEnable("GatewayLorawanMac", LOG_LEVEL_ALL);
+    //LogComponentEnableAll(LOG_PREFIX_FUNC);
+    //LogComponentEnableAll(LOG_PREFIX_NODE);
+    //LogComponentEnableAll(LOG_PREFIX_TIME);
+    NS_LOG_INFO("Starting CT_dev simulation...");
+    memoryFootprint.Start();
+    auto setupStart = std::chrono::steady_clock::now();
+    memoryFootprint.SetDeviceCount(N_END_DEVICES);
+
+    /**********************
+     * Channel Setup
+     **********************/
+    const double spacing = 5.0;
+    const double endDeviceHeight = 1.5; // Height for end devices (meters)
+    const double gatewayHeight = 10.0;  // Height for gateways (meters)
+    const double networkServerHeight = 10.0; // Height for network server (meters)
+
+    LoraBridgeScenario scenario;
+    scenario.SetEndDeviceCount(N_END_DEVICES);
+    scenario.SetDeviceLayout(spacing, endDeviceHeight);
+    for (uint32_t g = 0; g < N_GATEWAYS; ++g) {
+        scenario.AddGateway(Vector(GATEWAY_X_POS, GATEWAY_Y_POS, gatewayHeight));
+    }
+    scenario.SetNetworkServer(Vector(GATEWAY_X_POS + 10, GATEWAY_Y_POS + 10, networkServerHeight));
+
+    // Same fading as the scenario's; the bias only applies once the gateways are added, after the SF assignment
+    Ptr<BiasedNakagamiLossModel> rareEventFading = CreateObject<BiasedNakagamiLossModel>();
+    if (RARE_EVENT_BIAS_DB > 0) {
+        rareEventFading->SetAttribute("m0", DoubleValue(1.0));
+        rareEventFading->SetAttribute("m1", DoubleValue(1.5));
+        rareEventFading->SetAttribute("m2", DoubleValue(3.0));
+        rareEventFading->SetAttribute("Bias", DoubleValue(RARE_EVENT_BIAS_DB));
+        scenario.SetFadingModel(rareEventFading);
+    }
+
+    Ptr<LoraChannel> channel = scenario.BuildChannel();
+    memoryFootprint.Mark("Channel", false);
+
+    /**********************
+     * Nodes Creation
+     **********************/
+    scenario.BuildNodes();
+    NodeContainer endDevices = scenario.GetEndDevices();
+    NodeContainer gateways = scenario.GetGateways();
+    Ptr<Node> networkServer = scenario.GetNetworkServer();
+    memoryFootprint.Mark("Nodes and mobility", true);
+
+    // Compute distances to gateway
+    std::vector<double> distances(N_END_DEVICES);
+    Ptr<MobilityModel> gwMob = gateways.Get(0)->GetObject<MobilityModel>();
+    Vector gwPos = gwMob->GetPosition();
+    for (uint32_t i = 0; i < N_END_DEVICES; ++i) {
+        Ptr<MobilityModel> devMob = endDevices.Get(i)->GetObject<MobilityModel>();
+        Vector devPos = devMob->GetPosition();
+        double dx = devPos.x - gwPos.x;
+        double dy = devPos.y - gwPos.y;
+        double dz = devPos.z - gwPos.z;
+        distances[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+    NS_LOG_INFO("Distances to gateway computed.");
+
+    // Mean receive powers for the capture estimate: same path loss as the channel, without
+    // the fading, so that the channel's random streams are left untouched
+    Ptr<PropagationLossModel> meanLoss = scenario.CreateMeanLossModel();
+    meanRxPowerDbm.resize(N_END_DEVICES);
+    for (uint32_t i = 0; i < N_END_DEVICES; ++i) {
+        meanRxPowerDbm[i] = meanLoss->CalcRxPower(14.0, endDevices.Get(i)->GetObject<MobilityModel>(), gwMob);
+    }
+
+    FindFurthestDevice(endDevices, gateways);
+
+    packetsReceivedPerNode.resize(endDevices.GetN(), 0);
+
+    /**********************
+     * Devices Setup
+     **********************/
+    scenario.BuildDevices();
+    NetDeviceContainer endDevicesNet = scenario.GetEndDeviceNetDevices();
+    NetDeviceContainer gatewaysNet = scenario.GetGatewayNetDevices();
+
+    g_ackCount.resize(gatewaysNet.GetN(), 0);
+    for (uint32_t g = 0; g < gatewaysNet.GetN(); ++g) {
+        Ptr<LoraNetDevice> gwDevice = DynamicCast<LoraNetDevice>(gatewaysNet.Get(g));
+        gwDevice->GetPhy()->TraceConnectWithoutContext("StartSending", MakeBoundCallback(&OnGatewayPhyStartSending, g));
+    }
+
+    LorawanMacHeader::MType mType = USE_CONFIRMED_UPLINK ? LorawanMacHeader::CONFIRMED_DATA_UP
+                                                         : LorawanMacHeader::UNCONFIRMED_DATA_UP;
+    for (uint32_t i = 0; i < endDevicesNet.GetN(); ++i) {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevicesNet.Get(i));
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        mac->SetMType(mType);
+        mac->TraceConnectWithoutContext("RequiredTransmissions", MakeBoundCallback(&OnMacPacketOutcome, i, mac));
+        mac->TraceConnectWithoutContext("SentNewPacket", MakeBoundCallback(&OnEndDeviceSentNewPacket, i, mac));
+    }
+    retransmissionStats.SetDeviceCount(endDevicesNet.GetN());
+    NS_LOG_INFO("Devices setup...");
+    memoryFootprint.Mark("LoRa devices (PHY, MAC)", true);
+
+    /**********************
+     * Backbone, Forwarder and Network Server Setup
+     **********************/
+    ApplicationContainer nsApps = scenario.BuildNetworkServer();
+    Ptr<DownlinkBudgetComponent> downlinkBudget = CreateObject<DownlinkBudgetComponent>();
+    if (ENABLE_DOWNLINK_BUDGET) {
+        DynamicCast<NetworkServer>(nsApps.Get(0))->AddComponent(downlinkBudget);
+    }
+    memoryFootprint.Mark("Backhaul and network server", true);  // One status per end device
+
+    /**********************
+     * Applications Setup
+     **********************/
+    ApplicationContainer apps = scenario.InstallSenders(PERIOD_SENDER, 24, Hours(SIM_END_HOURS));
+    std::vector<Ptr<ArrivalProcess>> arrivalProcesses;
+    int64_t trafficStream = TRAFFIC_STREAM_BASE;
+    for (uint32_t i = 0; i < apps.GetN(); ++i)
+    {
+        Ptr<TaggingPeriodicSender> app = DynamicCast<TaggingPeriodicSender>(apps.Get(i));
+        app->SetMacHeader(mType);
+        app->SetSpreadingFactorTag(true);
+        Ptr<ArrivalProcess> arrivals = CreateArrivalProcess(TRAFFIC_MODEL, PERIOD_SENDER);
+        trafficStream += arrivals->AssignStreams(trafficStream);
+        app->SetArrivalProcess(arrivals);
+        arrivalProcesses.push_back(arrivals);
+    }
+    NS_LOG_INFO("Traffic model: " << TRAFFIC_MODEL);
+
+    // Trace replay replaces the generated schedule; records are streamed from the mapped file
+    Ptr<TraceReplayGenerator> replay = CreateObject<TraceReplayGenerator>();
+    if (!REPLAY_TRACE_FILE.empty()) {
+        if (!replay->Open(REPLAY_TRACE_FILE)) {
+            NS_LOG_ERROR("Could not open arrival trace " << REPLAY_TRACE_FILE);
+            return 1;
+        }
+        for (uint32_t i = 0; i < apps.GetN(); ++i) {
+            DynamicCast<TaggingPeriodicSender>(apps.Get(i))->SetSelfScheduling(false);
+            apps.Get(i)->SetStartTime(Seconds(0));
+        }
+        replay->SetAttribute("Lookahead", TimeValue(REPLAY_LOOKAHEAD));
+        replay->SetSendCallback(MakeBoundCallback(&OnReplayArrival, &apps));
+        replay->Start(Seconds(1), Hours(SIM_END_HOURS));  // After the senders have started
+        NS_LOG_INFO("Replaying " << replay->GetRecordCount() << " records from " << REPLAY_TRACE_FILE);
+    }
+
+    // Event storms trigger extra uplinks on every device they reach
+    Ptr<EventStormGenerator> storms = CreateObject<EventStormGenerator>();
+    if (ENABLE_EVENT_STORMS) {
+        storms->SetAttribute("MeanInterval", TimeValue(STORM_MEAN_INTERVAL));
+        storms->SetAttribute("MaxX", DoubleValue(N_END_DEVICES * spacing + 5));
+        for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+            storms->AddDevice(i, endDevices.Get(i)->GetObject<MobilityModel>()->GetPosition());
+        }
+        storms->SetTriggerCallback(MakeBoundCallback(&OnEventStorm, &apps));
+        trafficStream += storms->AssignStreams(trafficStream);
+        NS_LOG_INFO("Event storms enabled, mean interval " << STORM_MEAN_INTERVAL.GetSeconds() << " s");
+    }
+
+    // Schedule period change for hour 12 (39600s to 43200s) if enabled; devices are rephased
+    // with staggered offsets so that the change does not synchronise the fleet
+    Ptr<PeriodReconfigurator> reconfigurator = CreateObject<PeriodReconfigurator>();
+    if (ENABLE_12TH_HOUR_POLLING) {
+        reconfigurator->SetAttribute("RephaseMode", StringValue(PERIOD_REPHASE_MODE));
+        for (uint32_t i = 0; i < apps.GetN(); ++i) {
+            reconfigurator->AddDevice(i, i % N_PERIOD_GROUPS);
+        }
+        for (uint32_t g = 0; g < N_PERIOD_GROUPS; ++g) {
+            reconfigurator->AddChange(Seconds(39600.0), g, POLLING_PERIOD);
+            reconfigurator->AddChange(Seconds(43200.0), g, PERIOD_SENDER);
+        }
+        reconfigurator->SetRephaseCallback(MakeBoundCallback(&OnRephaseSender, &apps));
+        trafficStream += reconfigurator->AssignStreams(trafficStream);
+        reconfigurator->Start();
+    }
+    NS_LOG_INFO("Created application..");
+    memoryFootprint.Mark("Applications", true);
+
+    /**********************
+     * Energy Setup
+     **********************/
+    EnergySourceContainer sources = scenario.InstallEnergy();
+    const LoraBridgeScenario::EnergyConfig& energy = scenario.GetEnergyConfig();
+    retransmissionStats.SetRadioParameters(energy.supplyVoltageV, energy.txCurrentA, energy.rxCurrentA, 8);
+    memoryFootprint.Mark("Energy", true);
+
+    /**********************
+     * Spreading Factors
+     **********************/
+    NS_LOG_INFO("Setting spreading factors...");
+    SfAllocator sfAllocator;
+    if (SF_ALLOCATION == "airtime") {
+        // Mean receive power at the best gateway, and the mean rate and uplink size of each sender,
+        // spread over the uplink channels of the plan
+        sfAllocator.SetChannelCount(N_CHANNELS);
+        sfAllocator.SetLinkMargin(SF_LINK_MARGIN);
+        for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+            Ptr<MobilityModel> devMob = endDevices.Get(i)->GetObject<MobilityModel>();
+            double bestRxPower = -std::numeric_limits<double>::infinity();
+            for (uint32_t g = 0; g < gateways.GetN(); ++g) {
+                bestRxPower = std::max(bestRxPower, meanLoss->CalcRxPower(14.0, devMob, gateways.Get(g)->GetObject<MobilityModel>()));
+            }
+            Ptr<TaggingPeriodicSender> app = DynamicCast<TaggingPeriodicSender>(apps.Get(i));
+            sfAllocator.AddDevice(bestRxPower, 1.0 / arrivalProcesses[i]->GetMeanInterval().GetSeconds(),
+                                  app->GetUplinkSize());
+        }
+        sfAllocator.Solve();
+        for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+            Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevices.Get(i)->GetDevice(0));
+            DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac())->SetDataRate(12 - sfAllocator.GetSpreadingFactor(i));
+        }
+        if (sfAllocator.GetOutOfRangeCount() > 0) {
+            NS_LOG_WARN(sfAllocator.GetOutOfRangeCount() << " end devices miss the " << SF_LINK_MARGIN
+                        << " dB margin even at SF12");
+        }
+    } else if (SF_ALLOCATION == "distance") {
+        LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+    } else {
+        NS_LOG_ERROR("Unknown SF allocation " << SF_ALLOCATION << ", expected distance or airtime");
+        return 1;
+    }
+    NS_LOG_INFO("Spreading factors set (" << SF_ALLOCATION << ").");
+
+    std::vector<uint8_t> spreadingFactors = GetSpreadingFactors(endDevices);
+
+    /**********************
+     * Channel Plan
+     **********************/
+    // Extra EU868 channels on every MAC; devices restricted to a subset get the channels
+    // with the least expected airtime so far
+    ChannelPlan channelPlan;
+    channelPlan.SetChannelCount(N_CHANNELS);
+    channelPlan.SetChannelsPerDevice(CHANNELS_PER_DEVICE);
+    if (!channelPlan.IsDefault()) {
+        for (uint32_t g = 0; g < gateways.GetN(); ++g) {
+            Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(gateways.Get(g)->GetDevice(0));
+            channelPlan.ConfigureGateway(DynamicCast<GatewayLorawanMac>(loraNetDevice->GetMac()));
+        }
+        std::vector<uint32_t> masks = PlanChannels(channelPlan, apps, arrivalProcesses, spreadingFactors);
+        for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+            Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevices.Get(i)->GetDevice(0));
+            channelPlan.ConfigureEndDevice(DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac()), masks[i]);
+        }
+        NS_LOG_INFO("Channel plan: " << channelPlan.GetChannelCount() << " uplink channels, "
+                    << (CHANNELS_PER_DEVICE == 0 ? channelPlan.GetChannelCount() : CHANNELS_PER_DEVICE) << " per device");
+    }
+
+    /**********************
+     * Connect Traces for tracking on PHY
+     **********************/
+    for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevices.Get(i)->GetDevice(0));
+        loraNetDevice->GetPhy()->TraceConnectWithoutContext("StartSending", MakeBoundCallback(&OnTransmissionCallback, i));
+    }
+    for (uint32_t i = 0; i < gateways.GetN(); ++i) {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(gateways.Get(i)->GetDevice(0));
+        loraNetDevice->GetPhy()->TraceConnectWithoutContext("ReceivedPacket", MakeCallback(&OnPacketReceptionCallback));
+        Ptr<LoraPhy> gwPhy = loraNetDevice->GetPhy();
+        gwPhy->TraceConnectWithoutContext("LostPacketBecauseInterference",
+                                          MakeBoundCallback(&OnGatewayPhyLoss, uint8_t(TRACE_GW_PHY_LOST_INTERFERENCE)));
+        gwPhy->TraceConnectWithoutContext("LostPacketBecauseUnderSensitivity",
+                                          MakeBoundCallback(&OnGatewayPhyLoss, uint8_t(TRACE_GW_PHY_LOST_SENSITIVITY)));
+        gwPhy->TraceConnectWithoutContext("LostPacketBecauseNoMoreReceivers",
+                                          MakeBoundCallback(&OnGatewayPhyLoss, uint8_t(TRACE_GW_PHY_LOST_NO_RECEIVER)));
+    }
+    interferenceTracker.SetWindow(INTERFERENCE_WINDOW.GetNanoSeconds());
+
+    /**********************
+     * Event Scheduler
+     **********************/
+    // The backend only changes the speed, so it stays out of the key. In auto mode each one is timed
+    // on a prefix of this run in a forked child, before anything writes files or starts a thread, and
+    // without the rare event bias, which is only set up after the fork point.
+    std::string scheduler = SCHEDULER;
+    if (SCHEDULER == "auto") {
+        Time prefix = std::min(SCHEDULER_PREFIX, Hours(SIM_END_HOURS));
+        SchedulerTuner tuner;
+        tuner.SetPrefix(prefix);
+        scheduler = tuner.Calibrate();
+        std::cout << "============ SCHEDULER CALIBRATION ============\n";
+        for (const SchedulerTuner::Timing& timing : tuner.GetTimings()) {
+            std::cout << timing.backend << ": ";
+            if (timing.finished) {
+                std::cout << timing.wallSeconds << " s\n";
+            } else {
+                std::cout << "given up\n";
+            }
+        }
+        std::cout << "Timed on the first " << prefix.GetHours() << " h, selected: " << scheduler << "\n";
+        std::cout << "==============================================\n";
+    }
+    // With progress reports the backend is wrapped in a CountingScheduler
+    if (!SchedulerTuner::Install(scheduler, PROGRESS_INTERVAL > 0)) {
+        NS_LOG_ERROR("Unknown scheduler " << scheduler << ", expected Map, Heap, Calendar, List, PriorityQueue or auto");
+        return 1;
+    }
+    NS_LOG_INFO("Event scheduler: " << scheduler);
+
+    /**********************
+     * Fork Server
+     **********************/
+    // Everything above is shared by the replications
+    if (FORK_RUNS > 0) {
+        double setupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - setupStart).count();
+        NS_LOG_INFO("Set-up took " << setupSeconds << " s, forking " << forkServer.GetRunCount() << " replications");
+        if (!forkServer.Serve()) {
+            std::cout << "================= REPLICATIONS =================\n";
+            uint32_t mismatches = 0;
+            for (const ForkServer::Result& result : forkServer.GetResults()) {
+                std::cout << "Run " << result.run << ": ";
+                if (result.exitStatus == 0) {
+                    std::cout << "done";
+                } else {
+                    std::cout << "failed (exit status " << result.exitStatus << ")";
+                }
+                std::cout << " in " << result.wallSeconds << " s";
+                if (FORK_CHECK && result.exitStatus == 0) {
+                    RngSeedManager::SetRun(result.run);
+                    std::string forkedFile = GetRecordName(true) + ".rec";
+                    if (resultsStore) {
+                        std::string key = config.GetKey(RngSeedManager::GetSeed(), result.run, LORA_BRIDGE_BUILD_ID);
+                        forkedFile = resultsStore->GetPath(GetRecordName(true) + "_" + key + ".rec");
+                    }
+                    ResultRecord forked;
+                    ResultRecord single;
+                    bool same = forked.Read(forkedFile) && single.Read(GetRecordName(true) + "_single.rec")
+                                && SameResults(forked, single);
+                    std::cout << (same ? ", same as a single run" : ", DIFFERS from a single run");
+                    mismatches += same ? 0 : 1;
+                }
+                std::cout << "\n";
+            }
+            std::cout << "Set-up shared by the replications: " << setupSeconds << " s\n";
+            std::cout << "================================================\n";
+            Simulator::Destroy();
+            return (forkServer.GetFailedCount() > 0 || mismatches > 0) ? 1 : 0;
+        }
+        runKey = config.GetKey(RngSeedManager::GetSeed(), RngSeedManager::GetRun(), LORA_BRIDGE_BUILD_ID);
+        NS_LOG_INFO("Replication of run " << RngSeedManager::GetRun() << " started");
+    }
+
+    /**********************
+     * Random Streams
+     **********************/
+    // A single run takes the same path as a forked replication, whose random variables still carry the
+    // parent's run: every stream is assigned again, traffic first, then the fading, the MACs and the start
+    // times. The distance SF assignment drew from the fading before, so it is redone with the new streams,
+    // together with the channel masks that follow from the SFs.
+    int64_t stream = TRAFFIC_STREAM_BASE;
+    for (const auto& arrivals : arrivalProcesses) {
+        stream += arrivals->AssignStreams(stream);
+    }
+    if (ENABLE_EVENT_STORMS) {
+        stream += storms->AssignStreams(stream);
+    }
+    if (ENABLE_12TH_HOUR_POLLING) {
+        stream += reconfigurator->AssignStreams(stream);
+    }
+    stream += scenario.AssignStreams(stream);
+    if (!REPLAY_TRACE_FILE.empty()) {
+        for (uint32_t i = 0; i < apps.GetN(); ++i) {
+            apps.Get(i)->SetStartTime(Seconds(0));  // The replay drives the senders
+        }
+    }
+    if (SF_ALLOCATION == "distance") {
+        LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+        spreadingFactors = GetSpreadingFactors(endDevices);
+        if (!channelPlan.IsDefault()) {
+            ChannelPlan replan;
+            replan.SetChannelCount(N_CHANNELS);
+            replan.SetChannelsPerDevice(CHANNELS_PER_DEVICE);
+            std::vector<uint32_t> masks = PlanChannels(replan, apps, arrivalProcesses, spreadingFactors);
+            for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+                Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevices.Get(i)->GetDevice(0));
+                replan.SetMask(DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac()), masks[i]);
+            }
+        }
+    }
+
+    /**********************
+     * Rare Event Mode
+     **********************/
+    // After the last SF assignment, which must not be biased. Uplink fades towards the gateways are drawn
+    // deeper, and every gateway outcome is weighted with the likelihood ratios of the draws at that gateway
+    // in the last two SF12 airtimes: its own and those of any interferer. Sized for the 24-byte payload: an
+    // interferer longer than that, from a replayed trace, may start before the span and leave its draw out
+    // of the weight.
+    if (RARE_EVENT_BIAS_DB > 0) {
+        rareEventSpan = Seconds(2 * CalculateTimeOnAir(24 + 13, 12));
+        rareEventFading->SetAttribute("History", TimeValue(rareEventSpan));
+        rareEventEstimator.SetTopology(endDevices.GetN(), gateways.GetN());
+        for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+            Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevices.Get(i)->GetDevice(0));
+            loraNetDevice->GetPhy()->TraceConnectWithoutContext("StartSending", MakeBoundCallback(&OnRareEventTransmission, i));
+        }
+        for (uint32_t g = 0; g < gateways.GetN(); ++g) {
+            Ptr<MobilityModel> gwMobility = gateways.Get(g)->GetObject<MobilityModel>();
+            rareEventFading->AddBiasedReceiver(gwMobility);
+            Ptr<LoraPhy> gwPhy = DynamicCast<LoraNetDevice>(gateways.Get(g)->GetDevice(0))->GetPhy();
+            gwPhy->TraceConnectWithoutContext("ReceivedPacket", MakeBoundCallback(&OnRareEventOutcome, rareEventFading, gwMobility, true));
+            for (const char* loss : {"LostPacketBecauseInterference", "LostPacketBecauseUnderSensitivity",
+                                     "LostPacketBecauseNoMoreReceivers", "NoReceptionBecauseTransmitting"}) {
+                gwPhy->TraceConnectWithoutContext(loss, MakeBoundCallback(&OnRareEventOutcome, rareEventFading, gwMobility, false));
+            }
+        }
+        NS_LOG_INFO("Rare event mode: uplink fading biased by " << RARE_EVENT_BIAS_DB << " dB, outcomes weighted over "
+                    << rareEventSpan.GetSeconds() << " s");
+        if (USE_CONFIRMED_UPLINK) {
+            NS_LOG_WARN("Retransmissions react to the biased outcomes; use --confirmed=false for exact loss estimates");
+        }
+    }
+
+    // After the fork point, so that every replication draws its own first storm
+    if (ENABLE_EVENT_STORMS) {
+        storms->Start(Seconds(0), Hours(SIM_END_HOURS));
+    }
+
+    /**********************
+     * NetAnim Setup
+     **********************/
+    std::string animFile = "CT_dev.xml";
+    if (FORK_RUNS > 0 || standalone) {
+        animFile = "CT_dev_run" + std::to_string(RngSeedManager::GetRun()) + (standalone ? "_single" : "") + ".xml";
+    }
+    AnimationInterface anim(animFile);
+    for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+        anim.UpdateNodeDescription(endDevices.Get(i), "ED" + std::to_string(i));
+        anim.UpdateNodeColor(endDevices.Get(i), 0, 255, 0);
+    }
+    anim.UpdateNodeDescription(gateways.Get(0), "GW");
+    anim.UpdateNodeColor(gateways.Get(0), 255, 0, 0);
+    anim.UpdateNodeDescription(networkServer, "NS");
+    anim.UpdateNodeColor(networkServer, 0, 0, 255);
+    memoryFootprint.Mark("Trace sinks and NetAnim", true);
+    if (ENABLE_MEMORY_REPORT) {
+        memoryFootprint.Report(std::cout, "after setup", MEMORY_PROJECTION_FLEETS);
+        Simulator::Schedule(MEMORY_REPORT_INTERVAL, &ReportMemoryFootprint);
+    }
+
+    /**********************
+     * Schedule Duty Cycle Checks
+     **********************/
+    // With asynchronous traces the hours are only complete once the processor has drained
+    if (ENABLE_ASYNC_TRACES) {
+        traceProcessor.Start(TRACE_RING_SIZE, &ProcessTraceRecord);
+        NS_LOG_INFO("Trace bookkeeping on a background thread, ring of " << TRACE_RING_SIZE << " records");
+    } else {
+        Simulator::Schedule(Seconds(3600.0), &ScheduleDutyCycleChecks, 0);
+    }
+
+    // Progress from a wall-clock timer; the scheduler wrapper installed above only adds counter updates to the event loop
+    ProgressReporter progressReporter;
+    if (PROGRESS_INTERVAL > 0) {
+        std::string progressFile = PROGRESS_FILE;
+        if (FORK_RUNS > 0 && !progressFile.empty()) {
+            progressFile = "CT_dev_run" + std::to_string(RngSeedManager::GetRun()) + ".prom";
+        }
+        progressReporter.SetInterval(PROGRESS_INTERVAL);
+        progressReporter.SetMetricsFile(progressFile);
+        progressReporter.SetLabels("scenario=\"CT_dev\",run=\"" + std::to_string(RngSeedManager::GetRun())
+                                   + "\",key=\"" + runKey + "\"");
+        progressReporter.SetStopTime(Hours(SIM_END_HOURS));
+        progressReporter.Start();
+    }
+
+    Simulator::Stop(Hours(SIM_END_HOURS));
+    Simulator::Run();
+    progressReporter.Stop();
+
+    if (ENABLE_ASYNC_TRACES) {
+        traceProcessor.Stop();
+        NS_LOG_INFO("Trace processor handled " << traceProcessor.GetProcessedCount() << " records, producer waited on a full ring "
+                    << traceProcessor.GetStallCount() << " times");
+        for (uint32_t hour = 0; hour + 1 < SIM_END_HOURS; ++hour) {
+            CheckGatewayDutyCycle(hour);
+            CheckEndDeviceDutyCycle(hour);
+        }
+    }
+    interferenceTracker.Finish();
+    if (ENABLE_MEMORY_REPORT) {
+        UpdateTrackedFootprint();
+        memoryFootprint.Report(std::cout, "end of run", MEMORY_PROJECTION_FLEETS);
+    }
+
+    if (receivedPacketIds.GetStaleCount() > 0) {
+        NS_LOG_WARN(receivedPacketIds.GetStaleCount() << " receptions arrived more than " << receivedPacketIds.GetWindow()
+                    << " packet ids late and were not counted as unique");
+    }
+
+    // Packet stats
+    NS_LOG_INFO("Packets sent vs received per DR (SF7 -> SF12):");
+    for (int i = 0; i < 6; i++) {
+        std::cout << "DR" << (5 - i) << " (SF" << (7 + i) << "): Sent = "
+                  << packetsSent.at(i) << ", Received = " << packetsReceived.at(i) << std::endl;
+    }
+    NS_LOG_INFO("Successful transmission to Gateway per end device:");
+    for (uint32_t i = 0; i < packetsReceivedPerNode.size(); ++i) {
+        std::cout << "Node " << i << " (SF" << unsigned(spreadingFactors[i]) << "): "
+                  << packetsReceivedPerNode[i] << " packets received successfully by GW." << std::endl;
+    }
+    std::cout << "================= ACK SUMMARY =================\n";
+    for (uint32_t g = 0; g < g_ackCount.size(); ++g) {
+        std::cout << "Gateway " << g << " sent " << g_ackCount[g] << " ACKs\n";
+    }
+    std::cout << "==============================================\n";
+    const RetransmissionStats::Entry& retx = retransmissionStats.GetTotal();
+    std::cout << "============ RETRANSMISSION SUMMARY ============\n";
+    std::cout << "Uplinks: " << retx.successes + retx.failures << ", failed: " << retx.failures
+              << " (" << 100.0 * retx.GetFailureRate() << "%), mean attempts: " << retx.GetMeanAttempts() << "\n";
+    std::cout << "Mean time to success: " << retx.GetMeanTimeToSuccess() << " s, max: " << retx.timeToSuccessMax << " s\n";
+    std::cout << "Retry airtime: " << retx.retryAirtime << " s, retry energy: " << retx.retryEnergy << " J\n";
+    std::cout << "==============================================\n";
+    if (ENABLE_DOWNLINK_BUDGET) {
+        std::cout << "============ DOWNLINK BUDGET SUMMARY ============\n";
+        std::cout << "Replies in RX1: " << downlinkBudget->GetRx1Count()
+                  << ", in RX2: " << downlinkBudget->GetRx2Count()
+                  << " (" << downlinkBudget->GetDeferredCount() << " moved from RX1)"
+                  << ", dropped: " << downlinkBudget->GetDroppedCount()
+                  << ", confirmations left to retries: " << downlinkBudget->GetDeprioritisedCount() << "\n";
+        std::cout << "Budget left: RX1 " << downlinkBudget->GetRemainingBudget(868100000.0)
+                  << " s, RX2 " << downlinkBudget->GetRemainingBudget(869525000.0) << " s\n";
+        std::cout << "==============================================\n";
+    }
+    if (SF_ALLOCATION == "airtime") {
+        std::cout << "============ SF ALLOCATION SUMMARY ============\n";
+        for (uint8_t sf = 7; sf <= 12; ++sf) {
+            std::cout << "SF" << unsigned(sf) << ": " << sfAllocator.GetDeviceCount(sf) << " devices, load "
+                      << sfAllocator.GetLoad(sf) << " Erl/channel, expected collision probability "
+                      << 100.0 * sfAllocator.GetCollisionProbability(sf) << "%\n";
+        }
+        std::cout << "Improvement passes: " << sfAllocator.GetPassCount() << ", out of range: "
+                  << sfAllocator.GetOutOfRangeCount() << "\n";
+        std::cout << "==============================================\n";
+    }
+    std::cout << "============ CHANNEL USAGE SUMMARY ============\n";
+    for (const auto& channel : channelStats.GetChannels()) {
+        const ChannelStats::Entry& entry = channel.second;
+        std::cout << channel.first / 1e6 << " MHz: uplinks " << entry.uplinks << " (" << entry.uplinkAirtime << " s, "
+                  << 100.0 * entry.GetUplinkOccupancy(SIM_END_HOURS * 3600.0) << "% occupancy)"
+                  << ", received " << entry.received << ", lost to interference " << entry.lost[ChannelStats::LOST_INTERFERENCE]
+                  << " (" << 100.0 * entry.GetCollisionRate() << "%), under sensitivity " << entry.lost[ChannelStats::LOST_SENSITIVITY]
+                  << ", no receiver " << entry.lost[ChannelStats::LOST_NO_RECEIVER]
+                  << ", downlinks " << entry.downlinks << " (" << entry.downlinkAirtime << " s)\n";
+    }
+    std::cout << "Uplink airtime of the busiest channel over the mean: " << channelStats.GetUplinkImbalance() << "\n";
+    std::cout << "==============================================\n";
+    if (RARE_EVENT_BIAS_DB > 0) {
+        RareEventEstimator::Entry total = rareEventEstimator.GetTotal();
+        std::cout << "============ RARE EVENT ESTIMATES ============\n";
+        for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+            const RareEventEstimator::Entry& entry = rareEventEstimator.GetEntry(i);
+            std::cout << "Node " << i << ": loss probability " << entry.GetEstimate() << " +/- "
+                      << std::sqrt(entry.GetVariance()) << " (relative error " << entry.GetRelativeError()
+                      << ") from " << entry.samples << " transmissions, " << entry.losses << " lost under the bias\n";
+        }
+        std::cout << "All nodes: loss probability " << total.GetEstimate() << " +/- " << std::sqrt(total.GetVariance())
+                  << ", biased loss rate " << total.GetBiasedLossRate() << "\n";
+        std::cout << "Biased draws: " << rareEventFading->GetBiasedDrawCount() << ", transmissions still in the air: "
+                  << rareEventEstimator.GetPendingCount() << "\n";
+        std::cout << "The packet counters above were collected under the biased fading\n";
+        std::cout << "==============================================\n";
+    }
+    InterferenceTracker::WindowStats interference = interferenceTracker.GetTotal();
+    if (ENABLE_INTERFERENCE_TRACKING) {
+        std::cout << "============ INTERFERENCE SUMMARY ============\n";
+        std::cout << "Uplinks: " << interference.transmissions << ", same-SF overlaps: " << interference.sameSfOverlaps
+                  << " (" << interference.captured << " with capture, " << interference.destroyed << " without)"
+                  << ", inter-SF overlaps: " << interference.interSfOverlaps << "\n";
+        std::cout << "Collision clusters: " << interference.clusters << " holding " << interference.clusteredTransmissions
+                  << " uplinks, largest " << interference.maxClusterSize << "\n";
+        std::cout << "Gateway receptions: received " << interference.outcomes[InterferenceTracker::RECEIVED]
+                  << ", same-SF collision " << interference.outcomes[InterferenceTracker::LOST_SAME_SF]
+                  << ", inter-SF interference " << interference.outcomes[InterferenceTracker::LOST_INTER_SF]
+                  << ", other interference " << interference.outcomes[InterferenceTracker::LOST_UNATTRIBUTED]
+                  << ", under sensitivity " << interference.outcomes[InterferenceTracker::LOST_SENSITIVITY]
+                  << ", no free receiver " << interference.outcomes[InterferenceTracker::LOST_NO_RECEIVER] << "\n";
+        std::cout << "==============================================\n";
+    }
+
+    /**********************
+     * Energy Logging
+     **********************/
+    NS_LOG_INFO("Logging energy consumption...");
+    double simDuration = Simulator::Now().GetSeconds();
+    NS_LOG_INFO("Total simulation duration: " << simDuration << " seconds");
+
+    // Generate dynamic filename based on parameters
+    std::string recordName = GetRecordName(FORK_RUNS > 0 || standalone);
+    std::string filename = recordName + ".rec";
+    if (standalone) {
+        filename = recordName + "_single.rec";  // Only read by the fork check, never stored
+    } else if (resultsStore) {
+        // Seeds and variants that share the legacy name no longer overwrite each other
+        filename = resultsStore->GetPath(recordName + "_" + runKey + ".rec");
+    }
+
+    /**********************
+     * Result Record (rendered by lora-bridge-report)
+     **********************/
+    std::ostringstream runConfig;
+    runConfig << config.GetCanonical() << "seed=" << RngSeedManager::GetSeed() << "\n"
+              << "run=" << RngSeedManager::GetRun() << "\n"
+              << "build=" << LORA_BRIDGE_BUILD_ID << "\n";
+
+    ResultRecord record;
+    record.SetParameters(runConfig.str());
+    record.SetParameter("key", runKey);
+    record.SetParameter("scheduler", scheduler);
+    record.SetScalar("simDuration", simDuration);
+    record.SetScalar("uniqueReceived", receivedPacketIds.GetUniqueCount());
+    record.SetScalar("acksSent", g_ackCount[0]);
+    const RetransmissionStats::Entry& total = retransmissionStats.GetTotal();
+    record.SetScalar("uplinks", total.successes + total.failures);
+    record.SetScalar("failedUplinks", total.failures);
+    record.SetScalar("failureRate", total.GetFailureRate());
+    record.SetScalar("meanAttempts", total.GetMeanAttempts());
+    record.SetScalar("meanTimeToSuccess", total.GetMeanTimeToSuccess());
+    record.SetScalar("retryAirtime", total.retryAirtime);
+    record.SetScalar("retryEnergy", total.retryEnergy);
+    if (ENABLE_EVENT_STORMS) {
+        record.SetScalar("eventStorms", storms->GetStormCount());
+    }
+    if (ENABLE_DOWNLINK_BUDGET) {
+        record.SetScalar("downlinkRx1", downlinkBudget->GetRx1Count());
+        record.SetScalar("downlinkRx2", downlinkBudget->GetRx2Count());
+        record.SetScalar("downlinkDropped", downlinkBudget->GetDroppedCount());
+        record.SetScalar("downlinkDeprioritised", downlinkBudget->GetDeprioritisedCount());
+    }
+    if (ENABLE_INTERFERENCE_TRACKING) {
+        record.SetScalar("sameSfCollisions", interference.outcomes[InterferenceTracker::LOST_SAME_SF]);
+        record.SetScalar("interSfLosses", interference.outcomes[InterferenceTracker::LOST_INTER_SF]);
+        record.SetScalar("sensitivityLosses", interference.outcomes[InterferenceTracker::LOST_SENSITIVITY]);
+        record.SetScalar("collisionClusters", interference.clusters);
+        size_t interferenceTable = record.AddTable("interference", "Interference per Window",
+                                                   {"Window Start (h)", "Uplinks", "Same-SF Overlaps", "Captured",
+                                                    "Inter-SF Overlaps", "Clusters", "Largest Cluster",
+                                                    "Same-SF Losses", "Inter-SF Losses", "Sensitivity Losses"});
+        const auto& windows = interferenceTracker.GetWindows();
+        for (uint32_t w = 0; w < windows.size(); ++w) {
+            record.AddRow(interferenceTable, {w * INTERFERENCE_WINDOW.GetHours(), double(windows[w].transmissions),
+                                              double(windows[w].sameSfOverlaps), double(windows[w].captured),
+                                              double(windows[w].interSfOverlaps), double(windows[w].clusters),
+                                              double(windows[w].maxClusterSize),
+                                              double(windows[w].outcomes[InterferenceTracker::LOST_SAME_SF]),
+                                              double(windows[w].outcomes[InterferenceTracker::LOST_INTER_SF]),
+                                              double(windows[w].outcomes[InterferenceTracker::LOST_SENSITIVITY])});
+        }
+    }
+
+    if (RARE_EVENT_BIAS_DB > 0) {
+        RareEventEstimator::Entry total = rareEventEstimator.GetTotal();
+        record.SetScalar("rareEventLossEstimate", total.GetEstimate());
+        record.SetScalar("rareEventLossVariance", total.GetVariance());
+        record.SetScalar("rareEventBiasedLossRate", total.GetBiasedLossRate());
+        size_t rareEventTable = record.AddTable("rareEvents", "Importance Sampling Loss Estimates per Node",
+                                                {"Node ID", "Transmissions", "Biased Losses", "Loss Probability",
+                                                 "Variance", "Relative Error"});
+        for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+            const RareEventEstimator::Entry& entry = rareEventEstimator.GetEntry(i);
+            record.AddRow(rareEventTable, {double(i), double(entry.samples), double(entry.losses), entry.GetEstimate(),
+                                           entry.GetVariance(), entry.GetRelativeError()});
+        }
+    }
+
+    record.SetScalar("channelImbalance", channelStats.GetUplinkImbalance());
+    size_t channelTable = record.AddTable("channels", "Usage per Channel",
+                                          {"Frequency (MHz)", "Uplinks", "Uplink Airtime (s)", "Received",
+                                           "Interference Losses", "Sensitivity Losses", "No Receiver Losses",
+                                           "Downlinks", "Downlink Airtime (s)"});
+    for (const auto& channel : channelStats.GetChannels()) {
+        const ChannelStats::Entry& entry = channel.second;
+        record.AddRow(channelTable, {channel.first / 1e6, double(entry.uplinks), entry.uplinkAirtime,
+                                     double(entry.received), double(entry.lost[ChannelStats::LOST_INTERFERENCE]),
+                                     double(entry.lost[ChannelStats::LOST_SENSITIVITY]),
+                                     double(entry.lost[ChannelStats::LOST_NO_RECEIVER]), double(entry.downlinks),
+                                     entry.downlinkAirtime});
+    }
+
+    size_t distanceTable = record.AddTable("distances", "Gateway Distances to Nodes", {"Node ID", "Distance to GW (m)"});
+    for (uint32_t i = 0; i < distances.size(); ++i) {
+        record.AddRow(distanceTable, {double(i), distances[i]});
+    }
+    size_t sfTable = record.AddTable("perSf", "Packets per Spreading Factor", {"SF", "Sent", "Received"});
+    for (int i = 0; i < 6; ++i) {
+        record.AddRow(sfTable, {double(7 + i), double(packetsSent[i]), double(packetsReceived[i])});
+    }
+    size_t nodeTable = record.AddTable("perNode", "Packets per Node", {"Node ID", "SF", "Received"});
+    for (uint32_t i = 0; i < packetsReceivedPerNode.size(); ++i) {
+        record.AddRow(nodeTable, {double(i), double(spreadingFactors[i]), double(packetsReceivedPerNode[i])});
+    }
+    std::vector<std::string> attemptColumns{"SF"};
+    for (uint32_t n = 1; n <= RetransmissionStats::MAX_ATTEMPTS; ++n) {
+        attemptColumns.push_back(std::to_string(n));
+    }
+    size_t attemptTable = record.AddTable("attempts", "Attempts per Uplink", attemptColumns);
+    for (uint8_t sf = 7; sf <= 12; ++sf) {
+        const RetransmissionStats::Entry& entry = retransmissionStats.GetSpreadingFactor(sf);
+        std::vector<double> row{double(sf)};
+        for (uint32_t n = 1; n <= RetransmissionStats::MAX_ATTEMPTS; ++n) {
+            row.push_back(entry.attempts[n]);
+        }
+        record.AddRow(attemptTable, row);
+    }
+    size_t retryTable = record.AddTable("retryCost", "Retry Cost per Node",
+                                        {"Node ID", "Mean Attempts", "Failures", "Failure Rate",
+                                         "Mean Time to Success (s)", "Retry Airtime (s)", "Retry Energy (J)"});
+    for (uint32_t i = 0; i < retransmissionStats.GetDeviceCount(); ++i) {
+        const RetransmissionStats::Entry& entry = retransmissionStats.GetNode(i);
+        record.AddRow(retryTable, {double(i), entry.GetMeanAttempts(), double(entry.failures), entry.GetFailureRate(),
+                                   entry.GetMeanTimeToSuccess(), entry.retryAirtime, entry.retryEnergy});
+    }
+    size_t energyTable = record.AddTable("energy", "Energy Consumption Details",
+                                         {"Node ID", "Initial Energy (J)", "Energy Consumed (J)"});
+    double totalConsumed = 0.0;
+    for (uint32_t i = 0; i < sources.GetN(); ++i) {
+        Ptr<BasicEnergySource> src = sources.Get(i)->GetObject<BasicEnergySource>();
+        double initialEnergy = src->GetInitialEnergy();
+        double remainingEnergy = src->GetRemainingEnergy();
+        double consumed = initialEnergy - remainingEnergy;
+
+        NS_LOG_INFO("Node " << i << ": Initial=" << initialEnergy
+                    << " J, Consumed=" << consumed << " J, Remaining=" << remainingEnergy << " J");
+
+        record.AddRow(energyTable, {double(i), initialEnergy, consumed});
+        totalConsumed += consumed;
+    }
+    record.SetScalar("energyConsumed", totalConsumed);
+
+    if (!record.Write(filename)) {
+        NS_LOG_ERROR("Could not write result record " << filename);
+    } else {
+        NS_LOG_INFO("Result record saved to " << filename);
+        if (resultsStore && !standalone && !resultsStore->Commit(runKey, runConfig.str(), filename)) {
+            NS_LOG_ERROR("Could not record run " << runKey << " in " << resultsStoreDir);
+        }
+    }
+
+    Simulator::Destroy();
+    return 0;
+}
\ No newline at end of file
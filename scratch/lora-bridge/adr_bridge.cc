@@ -2,6 +2,7 @@
 #include "ns3/network-module.h"
 #include "ns3/mobility-module.h"
 #include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
 #include "ns3/lorawan-module.h"
 #include "ns3/lora-helper.h"
 #include "ns3/log.h"
@@ -9,6 +10,11 @@
 #include "ns3/application.h"
 #include <iostream>
 
+// Bridge network server components, packet id tag and tagging sender
+#include "lora-bridge/lib/adr-engine-component.h"
+#include "lora-bridge/lib/lora-bridge-scenario.h"
+#include "lora-bridge/lib/radio-timeline.h"
+
 using namespace ns3;
 using namespace ns3::lorawan;
 
@@ -18,141 +24,17 @@ NS_LOG_COMPONENT_DEFINE("BridgeExperimental");
  * Global variables
  **********************/
 static std::vector<uint32_t> g_ackCount;
+static const bool ENABLE_ADR = true;              // true = NS adapts SF and TX power, false = SF from setup only
+static const std::string ADR_MARGIN_POLICY = "Max"; // SNR history statistic: "Max", "Average" or "Min"
+static const uint32_t ADR_HISTORY_LENGTH = 20;    // Uplinks kept per device before ADR acts
+static const std::string RADIO_TIMELINE_FILE = "adr_bridge-radio.bin"; // End device radio states, read by lora-bridge-radio-timeline
 
-// ---- RX window callbacks ----
-void OnRxWindowStart(uint32_t nodeId) {
-    std::cout << "Node " << nodeId << " RX window opened at "
-              << Simulator::Now().GetSeconds() << "s" << std::endl;
-}
-void OnRxWindowEnd(uint32_t nodeId) {
-    std::cout << "Node " << nodeId << " RX window closed at "
-              << Simulator::Now().GetSeconds() << "s" << std::endl;
-}
-
-// ---- Trace callback for EndRx ----
-void RxWindowEndCallback(unsigned int nodeId) {
-    OnRxWindowEnd(nodeId);
-}
-void StartRxCallback(unsigned int nodeId) {
-    OnRxWindowStart(nodeId);
-}
-
-// ---- ACK reception callback ----
-void EdPacketReceived(ns3::Ptr<const ns3::Packet> packet, unsigned int nodeId)
-{
-    LorawanMacHeader macHdr;
-    Ptr<Packet> copy = packet->Copy();
-    if (copy->PeekHeader(macHdr)) {
-        if (macHdr.GetMType() == LorawanMacHeader::CONFIRMED_DATA_DOWN) {
-            std::cout << "Node " << nodeId << " received ACK at "
-                      << Simulator::Now().GetSeconds() << "s" << std::endl;
-        }
-    }
-}
-
-/***************
- * UniquePacketIdTag Definition
- ***************/
-class UniquePacketIdTag : public Tag {
-    public:
-        UniquePacketIdTag() : m_id(0) {}
-        UniquePacketIdTag(uint32_t id) : m_id(id) {}
-    
-        static TypeId GetTypeId(void) {
-            static TypeId tid = TypeId("UniquePacketIdTag")
-                .SetParent<Tag>()
-                .AddConstructor<UniquePacketIdTag>();
-            return tid;
-        }
-        virtual TypeId GetInstanceTypeId(void) const { return GetTypeId(); }
-        virtual void Serialize(TagBuffer i) const { i.WriteU32(m_id); }
-        virtual void Deserialize(TagBuffer i) { m_id = i.ReadU32(); }
-        virtual uint32_t GetSerializedSize(void) const { return 4; }
-        virtual void Print(std::ostream &os) const { os << "UniquePacketId=" << m_id; }
-        void SetId(uint32_t id) { m_id = id; }
-        uint32_t GetId() const { return m_id; }
-    private:
-        uint32_t m_id;
-    };
-    
-/***************
- * Custom PeriodicSender application adding UniquePacketIdTag
- ***************/
-// Declare global unique packet ID counter at top-level (before any class)
-static uint32_t globalPacketId = 0;
-    
-class TaggingPeriodicSender : public Application {
-    public:
-        TaggingPeriodicSender() : m_period(Seconds(60)), m_packetSize(20), m_packetsSent(0) {}
-        
-            void Setup(Ptr<Node> node, Ptr<NetDevice> device, Time period, uint32_t packetSize) {
-                m_node = node;
-                m_device = device;
-                m_period = period;
-                m_packetSize = packetSize;
-            }
-        
-            static TypeId GetTypeId(void) {
-                static TypeId tid = TypeId("TaggingPeriodicSender")
-                    .SetParent<Application>()
-                    .AddConstructor<TaggingPeriodicSender>();
-                return tid;
-            }
-        
-            virtual void StartApplication() override {
-                ScheduleNextTx(Seconds(0));
-            }
-        
-            virtual void StopApplication() override {
-                Simulator::Cancel(m_sendEvent);
-            }
-        
-        private:
-            void ScheduleNextTx(Time delay) {
-                m_sendEvent = Simulator::Schedule(delay, &TaggingPeriodicSender::SendPacket, this);
-            }
-        
-            void SendPacket() {
-                // Create packet
-                Ptr<Packet> packet = Create<Packet>(m_packetSize);
-                UniquePacketIdTag idTag(++globalPacketId);
-                packet->AddPacketTag(idTag);
-            
-                // Construct MAC header
-                LorawanMacHeader macHdr;
-                macHdr.SetMType(LorawanMacHeader::CONFIRMED_DATA_UP);
-            
-                // Add MAC header to packet
-                packet->AddHeader(macHdr);
-            
-                Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(m_device);
-                if (!loraNetDevice) {
-                    NS_LOG_ERROR("Device is not a LoraNetDevice");
-                    return;
-                }
-                loraNetDevice->GetMac()->Send(packet);
-            
-                m_packetsSent++;
-                ScheduleNextTx(m_period);
-            }
-            
-        
-            Ptr<Node> m_node;
-            Ptr<NetDevice> m_device;
-            Time m_period;
-            uint32_t m_packetSize;
-            EventId m_sendEvent;
-            uint32_t m_packetsSent;
-};
-        
-    
-    
 /***************
  * PACKET TRACKING
  ***************/
 std::vector<int> packetsSent(6, 0);     // DR5 -> DR0
 std::vector<int> packetsReceived(6, 0);
-std::map<uint32_t, uint32_t> packetSenderMap;  // unique packet id -> sender node id
+PacketSenderRing packetSenders;  // sender node id of the most recent packet ids
  std::vector<int> packetsReceivedPerNode;
     
 /***************
@@ -165,7 +47,7 @@ void OnTransmissionCallback(Ptr<const Packet> packet, uint32_t senderNodeId) {
     }
     UniquePacketIdTag idTag;
     if (packet->PeekPacketTag(idTag)) {
-        packetSenderMap[idTag.GetId()] = senderNodeId;
+        packetSenders.Set(idTag.GetId(), senderNodeId);
     }
 }
 
@@ -177,13 +59,9 @@ void OnPacketReceptionCallback(Ptr<const Packet> packet, uint32_t receiverNodeId
     }
     UniquePacketIdTag idTag;
     if (packet->PeekPacketTag(idTag)) {
-        uint32_t packetId = idTag.GetId();
-        auto it = packetSenderMap.find(packetId);
-        if (it != packetSenderMap.end()) {
-            uint32_t senderId = it->second;
-            if (senderId < packetsReceivedPerNode.size()) {
-                packetsReceivedPerNode[senderId]++;
-            }
+        uint32_t senderId;
+        if (packetSenders.Get(idTag.GetId(), senderId) && senderId < packetsReceivedPerNode.size()) {
+            packetsReceivedPerNode[senderId]++;
         }
     }
 }
@@ -195,6 +73,9 @@ int main(int argc, char *argv[]) {
     LogComponentEnable("BridgeExperimental", LOG_LEVEL_INFO);
     NS_LOG_INFO("Starting BridgeExperimental simulation...");
 
+    // End devices set the ADR bit in their uplinks
+    Config::SetDefault("ns3::EndDeviceLorawanMac::ADR", BooleanValue(ENABLE_ADR));
+
     // Lora Helper
     LoraHelper helper;
     helper.EnablePacketTracking();
@@ -205,6 +86,7 @@ int main(int argc, char *argv[]) {
     endDevices.Create(nDevices);
     NodeContainer gateways;
     gateways.Create(1);
+    Ptr<Node> networkServer = CreateObject<Node>();
 
     MobilityHelper mobility;
     Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
@@ -292,18 +174,52 @@ int main(int argc, char *argv[]) {
         loraNetDevice->GetPhy()->TraceConnectWithoutContext("ReceivedPacket", MakeCallback(OnPacketReceptionCallback));
     }
 
+    /**********************
+     * Network Server Setup (ADR runs here)
+     **********************/
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    pointToPoint.SetChannelAttribute("Delay", TimeValue(MilliSeconds(2)));
+
+    P2PGwRegistration_t gwRegistration;
+    for (uint32_t i = 0; i < gateways.GetN(); ++i) {
+        NetDeviceContainer p2pDevices = pointToPoint.Install(networkServer, gateways.Get(i));
+        Ptr<PointToPointNetDevice> serverP2PNetDev = DynamicCast<PointToPointNetDevice>(p2pDevices.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, gateways.Get(i));
+    }
+
+    ForwarderHelper forwarderHelper;
+    forwarderHelper.Install(gateways);
+
+    NetworkServerHelper networkServerHelper;
+    networkServerHelper.SetGatewaysP2P(gwRegistration);
+    networkServerHelper.SetEndDevices(endDevices);
+    ApplicationContainer nsApps = networkServerHelper.Install(networkServer);
+
+    Ptr<AdrEngineComponent> adr = CreateObject<AdrEngineComponent>();
+    adr->SetAttribute("MarginPolicy", StringValue(ADR_MARGIN_POLICY));
+    adr->SetAttribute("HistoryLength", UintegerValue(ADR_HISTORY_LENGTH));
+    adr->Reserve(endDevices.GetN());
+    if (ENABLE_ADR) {
+        DynamicCast<NetworkServer>(nsApps.Get(0))->AddComponent(adr);
+    }
+    NS_LOG_INFO("Network server setup complete.");
+
+    // Radio state timeline of the end devices, analysed offline
+    Ptr<RadioTimelineRecorder> radioTimeline = CreateObject<RadioTimelineRecorder>();
+    if (!radioTimeline->Open(RADIO_TIMELINE_FILE, endDevicesNet.GetN())) {
+        NS_LOG_ERROR("Could not create " << RADIO_TIMELINE_FILE);
+    }
+
     // Attach tracing and add periodic sender application for each end device
     for (uint32_t i = 0; i < endDevicesNet.GetN(); ++i) {
         Ptr<LoraNetDevice> dev = DynamicCast<LoraNetDevice>(endDevicesNet.Get(i));
-        Ptr<LoraPhy> phy = dev->GetPhy();
-
-        phy->TraceConnectWithoutContext("StartRx", MakeCallback(&StartRxCallback));
-        phy->TraceConnectWithoutContext("EndRx", MakeCallback(&RxWindowEndCallback));
-        phy->TraceConnectWithoutContext("ReceivedPacket", MakeCallback(&EdPacketReceived));
+        radioTimeline->AddDevice(i, DynamicCast<EndDeviceLoraPhy>(dev->GetPhy()));
 
         // Create and install a periodic sender app on the end device
         Ptr<TaggingPeriodicSender> app = CreateObject<TaggingPeriodicSender>();
         app->Setup(endDevices.Get(i), endDevicesNet.Get(i), Minutes(15), 24); // 24 byte packets
+        app->SetMacHeader(LorawanMacHeader::CONFIRMED_DATA_UP);
         endDevices.Get(i)->AddApplication(app);
         app->SetStartTime(Seconds(i * 20));
         app->SetStopTime(Hours(24));
@@ -313,6 +229,20 @@ int main(int argc, char *argv[]) {
 
     Simulator::Stop(Hours(3)); // 20 minutes simulation
     Simulator::Run();
+
+    // Settings the network server converged to, read before the devices are destroyed
+    std::vector<uint8_t> adrSpreadingFactors;
+    std::vector<double> adrTxPowers;
+    for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevices.Get(i)->GetDevice(0));
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        adrSpreadingFactors.push_back(adr->GetSpreadingFactor(mac->GetDeviceAddress()));
+        adrTxPowers.push_back(adr->GetTxPower(mac->GetDeviceAddress()));
+    }
+    uint64_t adrCommands = adr->GetCommandCount();
+    radioTimeline->Close();
+    std::cout << "Radio timeline: " << radioTimeline->GetRecordCount() << " records, "
+              << radioTimeline->GetBytesWritten() << " bytes in " << RADIO_TIMELINE_FILE << "\n";
     Simulator::Destroy();
 
     // Packet stats
@@ -331,7 +261,19 @@ int main(int argc, char *argv[]) {
         std::cout << "Gateway " << g << " sent " << g_ackCount[g] << " ACKs\n";
     }
     std::cout << "==============================================\n";
-    
+    if (ENABLE_ADR) {
+        std::cout << "================= ADR SUMMARY =================\n";
+        std::cout << "LinkADRReq commands sent: " << adrCommands << "\n";
+        for (uint32_t i = 0; i < adrSpreadingFactors.size(); ++i) {
+            std::cout << "Node " << i << ": SF" << unsigned(spreadingFactors[i]) << " -> ";
+            if (adrSpreadingFactors[i] == 0) {
+                std::cout << "no uplink seen\n";
+            } else {
+                std::cout << "SF" << unsigned(adrSpreadingFactors[i]) << ", " << adrTxPowers[i] << " dBm\n";
+            }
+        }
+        std::cout << "==============================================\n";
+    }
 
     return 0;
 }
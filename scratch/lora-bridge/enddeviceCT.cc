@@ -0,0 +1,245 @@
+//Utilities
+#include "ns3/log.h"
+#include "ns3/callback.h"
+#include "ns3/simulator.h"
+#include <iostream>
+#include <vector>
+//Device mobility and position
+#include "ns3/netanim-module.h"
+#include "ns3/animation-interface.h"
+//LoRa End Devices and Gateways
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/lora-phy.h"
+#include "ns3/lora-tag.h"
+// Bridge scenario: layout, channel, senders, energy, counters
+#include "lora-bridge/lib/lora-bridge-scenario.h"
+
+//Namespaces
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("enddeviceCT");
+
+/**********************
+ * Global simulation parameters
+ **********************/
+static const uint32_t SIM_END_HOURS = 24;          // Total simulation time in hours
+static const uint32_t N_END_DEVICES = 20;          // Number of end devices
+static const uint32_t N_GATEWAYS = 1;             // Number of gateways
+static const Time PERIOD_SENDER = Minutes(15);    // Periodic sender interval
+static const double GATEWAY_X_POS = -100.0;        // Gateway X coordinate in meters
+static const double GATEWAY_Y_POS = 100.0;          // Gateway Y coordinate in meters
+// Global variable to toggle confirmed/unconfirmed messages
+static const bool USE_CONFIRMED_UPLINK = true;    // true = confirmed, false = unconfirmed
+
+/**********************
+ * Global variables
+ **********************/
+static std::vector<uint32_t> g_ackCount;
+static double totalToA = 0.0;  // Total time on air in seconds for the current hour
+static std::vector<double> hourlyToA;  // Store ToA for each hour
+
+/**********************
+ * Ack tracing callback
+ **********************/
+// Function to check and log duty cycle compliance
+void CheckDutyCycle() {
+    double maxToA = 36.0;  // 1% of 3600 seconds (ETSI limit for EU868 sub-band)
+    hourlyToA.push_back(totalToA);
+    NS_LOG_INFO("DutyCycleChecker: Total time on air in hour " << hourlyToA.size() << ": " << totalToA << " seconds");
+    if (totalToA <= maxToA) {
+        NS_LOG_INFO("DutyCycleChecker: Compliant with ETSI 1% duty cycle.");
+    } else {
+        NS_LOG_INFO("DutyCycleChecker: Non-compliant with ETSI 1% duty cycle (exceeds 36s).");
+    }
+    totalToA = 0.0;  // Reset for next hour
+    if (Simulator::Now().GetSeconds() < SIM_END_HOURS * 3600.0) {
+        Simulator::Schedule(Seconds(3600.0), &CheckDutyCycle);
+    }
+}
+void OnGatewayAck(uint32_t gwIndex, Ptr<const Packet> p) {
+    if (gwIndex >= g_ackCount.size()) {
+        g_ackCount.resize(gwIndex + 1, 0);
+    }
+    g_ackCount[gwIndex]++;
+    //NS_LOG_INFO("Gateway " << gwIndex
+    //            << " sent ACK at " << Simulator::Now().GetSeconds() << "s");
+}
+
+/**********************
+ * Gateway PHY StartSending tracer (detect downlink ACKs)
+ **********************/
+// In OnGatewayPhyStartSending, add ToA calculation (assuming single gateway)
+void OnGatewayPhyStartSending(uint32_t gwIndex, Ptr<const Packet> packet, uint32_t phyIndex) {
+    Ptr<Packet> copy = packet->Copy();
+    lorawan::LorawanMacHeader macHdr;
+    copy->RemoveHeader(macHdr);
+
+    if (macHdr.GetMType() == lorawan::LorawanMacHeader::UNCONFIRMED_DATA_DOWN ||
+        macHdr.GetMType() == lorawan::LorawanMacHeader::CONFIRMED_DATA_DOWN) {
+        lorawan::LoraFrameHeader frameHdr;
+        copy->RemoveHeader(frameHdr);
+
+        if (frameHdr.GetAck()) {
+            if (gwIndex >= g_ackCount.size()) {
+                g_ackCount.resize(gwIndex + 1, 0);
+            }
+            g_ackCount[gwIndex]++;
+            //NS_LOG_INFO("Gateway " << gwIndex << " transmitted ACK at " << Simulator::Now().GetSeconds() << "s");
+        }
+    }
+
+    // Calculate ToA for this transmission
+    LoraTag tag;
+    uint8_t sf;
+    if (packet->PeekPacketTag(tag)) {
+        sf = tag.GetSpreadingFactor();
+        if (sf < 7 || sf > 12) {
+            //NS_LOG_ERROR("Invalid SF " << unsigned(sf) << " for gateway " << gwIndex << " packet, forcing SF7");
+            sf = 7;  // Force SF7 for invalid SFs
+            tag.SetSpreadingFactor(sf);
+            Ptr<Packet> packetCopy = packet->Copy();
+            packetCopy->ReplacePacketTag(tag);  // Update the tag
+        }
+    } else {
+        NS_LOG_ERROR("No LoraTag found for gateway " << gwIndex << " packet, forcing SF7");
+        sf = 7;  // Default to SF7 if no tag
+        tag.SetSpreadingFactor(sf);
+        Ptr<Packet> packetCopy = packet->Copy();
+        packetCopy->AddPacketTag(tag);  // Add tag to packet
+    }
+
+    uint32_t size = packet->GetSize();
+    double toa = CalculateTimeOnAir(size, sf, 125000.0, 1, true, true, 8);
+    totalToA += toa;
+    //NS_LOG_INFO("Gateway " << gwIndex << " transmitted packet with SF" << unsigned(sf) << ", ToA " << toa << "s, cumulative ToA " << totalToA << "s");
+}
+
+void OnMacPacketOutcome(uint8_t transmissions, bool successful, Time firstAttempt, Ptr<Packet> packet) {
+   // if (successful) {
+   //     NS_LOG_INFO("Confirmed uplink succeeded after " << unsigned(transmissions) << " attempts.");
+    //} else {
+    //    NS_LOG_INFO("Confirmed uplink failed after " << unsigned(transmissions) << " attempts.");
+   // }
+}
+
+/***************
+ * Main simulation code
+ ***************/
+int main(int argc, char *argv[]) {
+    LogComponentEnable("enddeviceCT", LOG_LEVEL_INFO);
+    LogComponentEnable("LoraBridgeScenario", LOG_LEVEL_INFO);
+    //LogComponentEnable("NetworkServer", LOG_LEVEL_ALL);
+    //LogComponentEnable("GatewayLorawanMac", LOG_LEVEL_ALL);
+    //LogComponentEnableAll(LOG_PREFIX_FUNC);
+    //LogComponentEnableAll(LOG_PREFIX_NODE);
+    //LogComponentEnableAll(LOG_PREFIX_TIME);
+    NS_LOG_INFO("Starting enddeviceCT simulation...");
+
+    /**********************
+     * Scenario Setup
+     **********************/
+    const double endDeviceHeight = 1.5; // Height for end devices (meters)
+    const double gatewayHeight = 10.0;  // Height for gateways (meters)
+    const double networkServerHeight = 10.0; // Height for network server (meters)
+
+    LoraBridgeScenario scenario;
+    scenario.SetEndDeviceCount(N_END_DEVICES);
+    scenario.SetDeviceLayout(5.0, endDeviceHeight);
+    for (uint32_t g = 0; g < N_GATEWAYS; ++g) {
+        scenario.AddGateway(Vector(GATEWAY_X_POS, GATEWAY_Y_POS, gatewayHeight));
+    }
+    scenario.SetNetworkServer(Vector(GATEWAY_X_POS + 10, GATEWAY_Y_POS + 10, networkServerHeight));
+    scenario.Build();
+
+    NodeContainer endDevices = scenario.GetEndDevices();
+    NodeContainer gateways = scenario.GetGateways();
+    Ptr<Node> networkServer = scenario.GetNetworkServer();
+    NetDeviceContainer endDevicesNet = scenario.GetEndDeviceNetDevices();
+    NetDeviceContainer gatewaysNet = scenario.GetGatewayNetDevices();
+
+    g_ackCount.resize(gatewaysNet.GetN(), 0);
+    for (uint32_t g = 0; g < gatewaysNet.GetN(); ++g) {
+        Ptr<LoraNetDevice> gwDevice = DynamicCast<LoraNetDevice>(gatewaysNet.Get(g));
+        gwDevice->GetPhy()->TraceConnectWithoutContext("StartSending", MakeBoundCallback(&OnGatewayPhyStartSending, g));
+    }
+
+    LorawanMacHeader::MType mType = USE_CONFIRMED_UPLINK ? LorawanMacHeader::CONFIRMED_DATA_UP
+                                                         : LorawanMacHeader::UNCONFIRMED_DATA_UP;
+    for (uint32_t i = 0; i < endDevicesNet.GetN(); ++i) {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(endDevicesNet.Get(i));
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        mac->SetMType(mType);
+        //mac->SetAdrEnabled(false); // Disable ADR
+        mac->TraceConnectWithoutContext("RequiredTransmissions", MakeCallback(&OnMacPacketOutcome));
+    }
+    NS_LOG_INFO("Devices setup...");
+
+    /**********************
+     * Applications Setup
+     **********************/
+    ApplicationContainer apps = scenario.InstallSenders(PERIOD_SENDER, 24, Hours(SIM_END_HOURS));
+    for (uint32_t i = 0; i < apps.GetN(); ++i) {
+        DynamicCast<TaggingPeriodicSender>(apps.Get(i))->SetMacHeader(mType);
+    }
+    NS_LOG_INFO("Created application..");
+
+    /**********************
+     * Energy Setup
+     **********************/
+    EnergySourceContainer sources = scenario.InstallEnergy();
+
+    /**********************
+     * Spreading Factors
+     **********************/
+    NS_LOG_INFO("Setting spreading factors...");
+    scenario.SetSpreadingFactorsUp();
+    NS_LOG_INFO("Spreading factors set.");
+
+    /**********************
+     * Connect Traces for tracking on PHY
+     **********************/
+    scenario.ConnectPacketCounters();
+
+    /**********************
+     * NetAnim Setup
+     **********************/
+    AnimationInterface anim("enddeviceCT.xml");
+    for (uint32_t i = 0; i < endDevices.GetN(); ++i) {
+        anim.UpdateNodeDescription(endDevices.Get(i), "ED" + std::to_string(i));
+        anim.UpdateNodeColor(endDevices.Get(i), 0, 255, 0);
+    }
+    anim.UpdateNodeDescription(gateways.Get(0), "GW");
+    anim.UpdateNodeColor(gateways.Get(0), 255, 0, 0);
+    anim.UpdateNodeDescription(networkServer, "NS");
+    anim.UpdateNodeColor(networkServer, 0, 0, 255);
+
+    Simulator::Stop(Hours(SIM_END_HOURS));
+    Simulator::Schedule (Seconds (3600.0), &CheckDutyCycle);
+    Simulator::Run();
+    
+    CheckDutyCycle();  // Check the last partial hour if needed
+
+    // Packet stats
+    scenario.PrintPacketStats(std::cout);
+    std::cout << "================= ACK SUMMARY =================\n";
+    for (uint32_t g = 0; g < g_ackCount.size(); ++g) {
+        std::cout << "Gateway " << g << " sent " << g_ackCount[g] << " ACKs\n";
+    }
+    std::cout << "==============================================\n";
+
+    /**********************
+     * Energy Logging
+     **********************/
+    NS_LOG_INFO("Logging energy consumption...");
+    double simDuration = Simulator::Now().GetSeconds();
+    NS_LOG_INFO("Total simulation duration: " << simDuration << " seconds");
+
+    WriteEnergyTex("enddeviceCT.tex", simDuration, sources);
+
+    Simulator::Destroy();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "lora-bridge/lib/lora-bridge-scenario.h"
+
+#include "ns3/animation-interface.h"
+#include "ns3/log.h"
+#include "ns3/netanim-module.h"
+#include "ns3/simulator.h"
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("BridgeLorawanNetworkNLOST");
+
+/***************
+ * Main simulation code
+ ***************/
+int main(int argc, char *argv[]) {
+    LogComponentEnable("BridgeLorawanNetworkNLOST", LOG_LEVEL_INFO);
+    LogComponentEnable("LoraBridgeScenario", LOG_LEVEL_INFO);
+    NS_LOG_INFO("Starting BridgeLorawanNetworkNLOST simulation...");
+
+    /**********************
+     * Scenario Setup
+     **********************/
+    // 20 devices 5 m apart on the deck, gateway 100 m before the bridge
+    LoraBridgeScenario scenario;
+    scenario.SetEndDeviceCount(20);
+    scenario.SetDeviceLayout(5.0, 0.0);
+    scenario.AddGateway(Vector(-100, -5, 0));
+    scenario.SetStaggeredStart(Seconds(20));
+    scenario.Build();
+
+    NodeContainer endDevices = scenario.GetEndDevices();
+    NodeContainer gateways = scenario.GetGateways();
+
+    /**********************
+     * Applications Setup - Use custom TaggingPeriodicSender
+     **********************/
+    scenario.InstallSenders(Minutes(15), 24, Hours(24)); // 24 byte packets
+
+    /**********************
+     *  Energy Setup      *
+     **********************/
+    EnergySourceContainer sources = scenario.InstallEnergy();
+
+    /**********************
+     *  Spreading Factors *
+     **********************/
+    NS_LOG_INFO("Setting spreading factors...");
+    scenario.SetSpreadingFactorsUp();
+    NS_LOG_INFO("Spreading factors set.");
+
+    /**********************
+     * Connect Traces for tracking on PHY
+     **********************/
+    scenario.ConnectPacketCounters();
+
+    /**********************
+     *  NetAnim Setup     *
+     **********************/
+    AnimationInterface anim("BridgeLorawanNetworkNLOST.xml");
+    for (uint32_t i = 0; i < endDevices.GetN(); ++i)
+    {
+        anim.UpdateNodeDescription(endDevices.Get(i), "ED" + std::to_string(i));
+        anim.UpdateNodeColor(endDevices.Get(i), 0, 255, 0);
+    }
+    anim.UpdateNodeDescription(gateways.Get(0), "GW");
+    anim.UpdateNodeColor(gateways.Get(0), 255, 0, 0);
+
+
+    Simulator::Stop(Hours(24));
+    Simulator::Run();
+
+    // Packet stats
+    scenario.PrintPacketStats(std::cout);
+
+    /**********************
+     *  Energy Logging    *
+     **********************/
+    NS_LOG_INFO("Logging energy consumption...");
+    double simDuration = Simulator::Now().GetSeconds();
+    NS_LOG_INFO("Total simulation duration: " << simDuration << " seconds");
+    WriteEnergyTex("EndNodeTimeDrivenNLOST.tex", simDuration, sources);
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -0,0 +1,571 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Adaptive design of experiments over the scenario parameters.
+//
+// A grid sweep spends most of its runs where the metric is flat. The sampler
+// starts from a maximin Latin hypercube, so that every parameter range is
+// covered evenly with few points, then refines batch by batch where the
+// metric changes or is uncertain. Each point links to its 2d nearest
+// neighbours in the unit cube, and each link is scored by the metric
+// difference across it over the combined standard error of its two means
+// (points with a single result borrow the pooled variance). A link scoring at
+// least 2, a difference that is real, is a candidate for a new point at its
+// midpoint. A link below that may only be noise: its noisier end is a
+// candidate for more replications, with the same score, so that a nearly
+// significant difference gets resolved before a flat one. A batch takes the
+// best candidates whose new points lie at least the resolution apart. Links shorter than
+// twice the resolution, or between neighbouring integer values, are not
+// split again, so the refinement stops at the cliffs rather than inside them.
+//
+// The sampler only proposes points and aggregates the results; running the
+// scenario is up to the caller.
+
+#ifndef LORA_BRIDGE_ADAPTIVE_SAMPLER_H
+#define LORA_BRIDGE_ADAPTIVE_SAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Space-filling start and gradient/variance driven refinement of a
+ * parameter sweep.
+ */
+class AdaptiveSampler
+{
+  public:
+    /// One parameter of the sweep
+    struct Dimension
+    {
+        std::string name; //!< Parameter name
+        double min = 0.0; //!< Lowest value
+        double max = 1.0; //!< Highest value
+        bool integer = false; //!< Whether the values are rounded to integers
+    };
+
+    /// A point of the design and its results
+    struct Sample
+    {
+        std::vector<double> x;      //!< Parameter values, in the order of the dimensions
+        std::vector<double> values; //!< Metric of each replication
+
+        /// @return The mean of the metric, NaN without results
+        double GetMean() const;
+
+        /// @return The sample variance of the metric, 0 below two results
+        double GetVariance() const;
+
+        /// @return The standard error of the mean, 0 below two results
+        double GetStandardError() const;
+    };
+
+    /// A proposed batch entry: a point and how many more replications it needs
+    struct Proposal
+    {
+        size_t sample = 0;       //!< Index of the sample
+        uint32_t replications = 0; //!< Replications to run
+    };
+
+    /// A link between two neighbouring samples
+    struct Edge
+    {
+        size_t a = 0;          //!< First sample
+        size_t b = 0;          //!< Second sample
+        double length = 0.0;   //!< Length in the unit cube
+        double difference = 0.0; //!< Absolute difference of the means
+        double error = 0.0;    //!< Combined standard error of the two means
+        /// @return The difference over its standard error, infinity if the error is 0
+        double GetSignificance() const;
+    };
+
+    AdaptiveSampler();
+
+    /**
+     * Add a dimension; dimensions are numbered in the order they are added.
+     *
+     * @param name Parameter name.
+     * @param min Lowest value.
+     * @param max Highest value.
+     * @param integer Whether to round the values to integers.
+     */
+    void AddDimension(const std::string& name, double min, double max, bool integer);
+
+    /// @return The dimensions
+    const std::vector<Dimension>& GetDimensions() const;
+
+    /// @param seed Seed of the initial design.
+    void SetSeed(uint64_t seed);
+
+    /**
+     * @param resolution Smallest spacing between two points, as a fraction of each range.
+     */
+    void SetResolution(double resolution);
+
+    /**
+     * Create the initial design: the Latin hypercube of @p nPoints with the
+     * largest smallest distance among a few random ones.
+     *
+     * @param nPoints Points of the design.
+     * @param replications Replications of each point.
+     * @return The proposals of the design.
+     */
+    std::vector<Proposal> Start(uint32_t nPoints, uint32_t replications);
+
+    /**
+     * Propose the next batch from the results so far.
+     *
+     * @param batchSize Largest number of proposals.
+     * @param replications Replications of a new point, or added to an uncertain one.
+     * @return The proposals, empty when nothing is left to refine.
+     */
+    std::vector<Proposal> Refine(uint32_t batchSize, uint32_t replications);
+
+    /**
+     * @param sample Index of a sample.
+     * @param value Metric of one more replication.
+     */
+    void AddResult(size_t sample, double value);
+
+    /// @return The samples, initial design first
+    const std::vector<Sample>& GetSamples() const;
+
+    /// @return The links between the samples that have results, steepest first
+    std::vector<Edge> GetEdges() const;
+
+  private:
+    /// @return @p x scaled to the unit cube
+    std::vector<double> Normalize(const std::vector<double>& x) const;
+
+    /// @return @p unit scaled to the parameter ranges, integers rounded
+    std::vector<double> Denormalize(const std::vector<double>& unit) const;
+
+    /// @return The Euclidean distance between @p a and @p b
+    static double Distance(const std::vector<double>& a, const std::vector<double>& b);
+
+    /// @return Whether @p x is closer than the resolution to a sample or to one of @p extra
+    bool IsCovered(const std::vector<double>& x, const std::vector<std::vector<double>>& extra) const;
+
+    /// @return Whether the midpoint of @p a and @p b can still be told apart from both
+    bool IsSplittable(const Sample& a, const Sample& b) const;
+
+    /// @return The mean variance of the samples with at least two results, 0 if none
+    double GetPooledVariance() const;
+
+    /// @return The standard error of @p sample, from @p pooledVariance below two results
+    static double GetError(const Sample& sample, double pooledVariance);
+
+    std::vector<Dimension> m_dimensions; //!< Parameters of the sweep
+    std::vector<Sample> m_samples;       //!< Points and their results
+    std::mt19937_64 m_rng;               //!< Random source of the initial design
+    double m_resolution;                 //!< Smallest spacing, as a fraction of each range
+};
+
+inline double
+AdaptiveSampler::Sample::GetMean() const
+{
+    if (values.empty())
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+}
+
+inline double
+AdaptiveSampler::Sample::GetVariance() const
+{
+    if (values.size() < 2)
+    {
+        return 0.0;
+    }
+    double mean = GetMean();
+    double sum = 0.0;
+    for (double value : values)
+    {
+        sum += (value - mean) * (value - mean);
+    }
+    return sum / (values.size() - 1);
+}
+
+inline double
+AdaptiveSampler::Sample::GetStandardError() const
+{
+    return values.size() < 2 ? 0.0 : std::sqrt(GetVariance() / values.size());
+}
+
+inline double
+AdaptiveSampler::Edge::GetSignificance() const
+{
+    if (error > 0.0)
+    {
+        return difference / error;
+    }
+    return difference > 0.0 ? std::numeric_limits<double>::infinity() : 0.0;
+}
+
+inline AdaptiveSampler::AdaptiveSampler()
+    : m_rng(1),
+      m_resolution(1.0 / 64)
+{
+}
+
+inline void
+AdaptiveSampler::AddDimension(const std::string& name, double min, double max, bool integer)
+{
+    Dimension dimension;
+    dimension.name = name;
+    dimension.min = std::min(min, max);
+    dimension.max = std::max(min, max);
+    dimension.integer = integer;
+    m_dimensions.push_back(dimension);
+}
+
+inline const std::vector<AdaptiveSampler::Dimension>&
+AdaptiveSampler::GetDimensions() const
+{
+    return m_dimensions;
+}
+
+inline void
+AdaptiveSampler::SetSeed(uint64_t seed)
+{
+    m_rng.seed(seed);
+}
+
+inline void
+AdaptiveSampler::SetResolution(double resolution)
+{
+    m_resolution = resolution;
+}
+
+inline std::vector<AdaptiveSampler::Proposal>
+AdaptiveSampler::Start(uint32_t nPoints, uint32_t replications)
+{
+    const uint32_t tries = 32;
+    size_t d = m_dimensions.size();
+    std::uniform_real_distribution<double> jitter(0.0, 1.0);
+
+    std::vector<std::vector<double>> best;
+    double bestSpread = -1.0;
+    for (uint32_t t = 0; t < tries; ++t)
+    {
+        // One point per stratum of every dimension, strata paired at random
+        std::vector<std::vector<double>> design(nPoints, std::vector<double>(d));
+        for (size_t k = 0; k < d; ++k)
+        {
+            std::vector<uint32_t> strata(nPoints);
+            std::iota(strata.begin(), strata.end(), 0);
+            std::shuffle(strata.begin(), strata.end(), m_rng);
+            for (uint32_t i = 0; i < nPoints; ++i)
+            {
+                design[i][k] = (strata[i] + jitter(m_rng)) / nPoints;
+            }
+        }
+        double spread = std::numeric_limits<double>::infinity();
+        for (uint32_t i = 0; i < nPoints; ++i)
+        {
+            for (uint32_t j = i + 1; j < nPoints; ++j)
+            {
+                spread = std::min(spread, Distance(design[i], design[j]));
+            }
+        }
+        if (spread > bestSpread)
+        {
+            bestSpread = spread;
+            best = design;
+        }
+    }
+
+    std::vector<Proposal> proposals;
+    std::vector<std::vector<double>> added;
+    for (const auto& unit : best)
+    {
+        std::vector<double> x = Denormalize(unit);
+        if (IsCovered(x, added))
+        {
+            continue; // Integer rounding merged two points
+        }
+        added.push_back(x);
+        Sample sample;
+        sample.x = x;
+        m_samples.push_back(sample);
+        Proposal proposal;
+        proposal.sample = m_samples.size() - 1;
+        proposal.replications = replications;
+        proposals.push_back(proposal);
+    }
+    return proposals;
+}
+
+inline std::vector<AdaptiveSampler::Proposal>
+AdaptiveSampler::Refine(uint32_t batchSize, uint32_t replications)
+{
+    // Candidates: (score, sample to replicate or SIZE_MAX, midpoint)
+    struct Candidate
+    {
+        double score;
+        size_t sample;
+        std::vector<double> x;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<double> replicationScore(m_samples.size(), 0.0);
+    double pooledVariance = GetPooledVariance();
+    for (const Edge& edge : GetEdges())
+    {
+        double score = edge.GetSignificance();
+        if (score < 2.0)
+        {
+            // Not told apart from noise yet: replicate the end that contributes most of the error
+            size_t noisier = GetError(m_samples[edge.a], pooledVariance) >=
+                                     GetError(m_samples[edge.b], pooledVariance)
+                                 ? edge.a
+                                 : edge.b;
+            replicationScore[noisier] = std::max(replicationScore[noisier], score);
+            continue;
+        }
+        if (IsSplittable(m_samples[edge.a], m_samples[edge.b]))
+        {
+            std::vector<double> unit = Normalize(m_samples[edge.a].x);
+            std::vector<double> other = Normalize(m_samples[edge.b].x);
+            for (size_t k = 0; k < unit.size(); ++k)
+            {
+                unit[k] = (unit[k] + other[k]) / 2;
+            }
+            candidates.push_back({score, SIZE_MAX, Denormalize(unit)});
+        }
+    }
+    for (size_t i = 0; i < m_samples.size(); ++i)
+    {
+        if (replicationScore[i] > 0.0)
+        {
+            candidates.push_back({replicationScore[i], i, m_samples[i].x});
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.score > b.score;
+    });
+
+    std::vector<Proposal> proposals;
+    std::vector<std::vector<double>> added;
+    std::vector<bool> replicated(m_samples.size(), false);
+    for (const Candidate& candidate : candidates)
+    {
+        if (proposals.size() >= batchSize)
+        {
+            break;
+        }
+        Proposal proposal;
+        proposal.replications = replications;
+        if (candidate.sample != SIZE_MAX)
+        {
+            if (replicated[candidate.sample])
+            {
+                continue;
+            }
+            replicated[candidate.sample] = true;
+            proposal.sample = candidate.sample;
+        }
+        else
+        {
+            if (IsCovered(candidate.x, added))
+            {
+                continue;
+            }
+            added.push_back(candidate.x);
+            Sample sample;
+            sample.x = candidate.x;
+            m_samples.push_back(sample);
+            proposal.sample = m_samples.size() - 1;
+        }
+        proposals.push_back(proposal);
+    }
+    return proposals;
+}
+
+inline void
+AdaptiveSampler::AddResult(size_t sample, double value)
+{
+    m_samples.at(sample).values.push_back(value);
+}
+
+inline const std::vector<AdaptiveSampler::Sample>&
+AdaptiveSampler::GetSamples() const
+{
+    return m_samples;
+}
+
+inline std::vector<AdaptiveSampler::Edge>
+AdaptiveSampler::GetEdges() const
+{
+    std::vector<size_t> done;
+    std::vector<std::vector<double>> units;
+    for (size_t i = 0; i < m_samples.size(); ++i)
+    {
+        if (!m_samples[i].values.empty())
+        {
+            done.push_back(i);
+            units.push_back(Normalize(m_samples[i].x));
+        }
+    }
+
+    double pooledVariance = GetPooledVariance();
+    size_t k = std::min(2 * m_dimensions.size(), done.size() > 0 ? done.size() - 1 : 0);
+    std::vector<Edge> edges;
+    for (size_t i = 0; i < done.size(); ++i)
+    {
+        std::vector<std::pair<double, size_t>> neighbours;
+        for (size_t j = 0; j < done.size(); ++j)
+        {
+            if (j != i)
+            {
+                neighbours.emplace_back(Distance(units[i], units[j]), j);
+            }
+        }
+        std::partial_sort(neighbours.begin(), neighbours.begin() + k, neighbours.end());
+        for (size_t n = 0; n < k; ++n)
+        {
+            size_t j = neighbours[n].second;
+            bool duplicate = false;
+            for (const Edge& edge : edges)
+            {
+                duplicate = duplicate || (edge.a == done[j] && edge.b == done[i]);
+            }
+            if (duplicate)
+            {
+                continue;
+            }
+            Edge edge;
+            edge.a = done[i];
+            edge.b = done[j];
+            edge.length = neighbours[n].first;
+            edge.difference = std::fabs(m_samples[edge.a].GetMean() - m_samples[edge.b].GetMean());
+            double errorA = GetError(m_samples[edge.a], pooledVariance);
+            double errorB = GetError(m_samples[edge.b], pooledVariance);
+            edge.error = std::sqrt(errorA * errorA + errorB * errorB);
+            edges.push_back(edge);
+        }
+    }
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+        return a.difference > b.difference;
+    });
+    return edges;
+}
+
+inline std::vector<double>
+AdaptiveSampler::Normalize(const std::vector<double>& x) const
+{
+    std::vector<double> unit(x.size());
+    for (size_t k = 0; k < x.size(); ++k)
+    {
+        double range = m_dimensions[k].max - m_dimensions[k].min;
+        unit[k] = range > 0.0 ? (x[k] - m_dimensions[k].min) / range : 0.0;
+    }
+    return unit;
+}
+
+inline std::vector<double>
+AdaptiveSampler::Denormalize(const std::vector<double>& unit) const
+{
+    std::vector<double> x(unit.size());
+    for (size_t k = 0; k < unit.size(); ++k)
+    {
+        const Dimension& dimension = m_dimensions[k];
+        x[k] = dimension.min + unit[k] * (dimension.max - dimension.min);
+        if (dimension.integer)
+        {
+            x[k] = std::round(x[k]);
+        }
+        x[k] = std::min(std::max(x[k], dimension.min), dimension.max);
+    }
+    return x;
+}
+
+inline double
+AdaptiveSampler::Distance(const std::vector<double>& a, const std::vector<double>& b)
+{
+    double sum = 0.0;
+    for (size_t k = 0; k < a.size(); ++k)
+    {
+        sum += (a[k] - b[k]) * (a[k] - b[k]);
+    }
+    return std::sqrt(sum);
+}
+
+inline bool
+AdaptiveSampler::IsCovered(const std::vector<double>& x, const std::vector<std::vector<double>>& extra) const
+{
+    std::vector<double> unit = Normalize(x);
+    for (const Sample& sample : m_samples)
+    {
+        if (Distance(unit, Normalize(sample.x)) < m_resolution)
+        {
+            return true;
+        }
+    }
+    for (const auto& other : extra)
+    {
+        if (Distance(unit, Normalize(other)) < m_resolution)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool
+AdaptiveSampler::IsSplittable(const Sample& a, const Sample& b) const
+{
+    if (Distance(Normalize(a.x), Normalize(b.x)) < 2 * m_resolution)
+    {
+        return false;
+    }
+    // Some dimension must have room for a value strictly between the two
+    for (size_t k = 0; k < m_dimensions.size(); ++k)
+    {
+        double gap = std::fabs(a.x[k] - b.x[k]);
+        if (m_dimensions[k].integer ? gap >= 2.0 : gap > 0.0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline double
+AdaptiveSampler::GetPooledVariance() const
+{
+    double sum = 0.0;
+    size_t degrees = 0;
+    for (const Sample& sample : m_samples)
+    {
+        if (sample.values.size() >= 2)
+        {
+            sum += sample.GetVariance() * (sample.values.size() - 1);
+            degrees += sample.values.size() - 1;
+        }
+    }
+    return degrees > 0 ? sum / degrees : 0.0;
+}
+
+inline double
+AdaptiveSampler::GetError(const Sample& sample, double pooledVariance)
+{
+    if (sample.values.size() >= 2)
+    {
+        return sample.GetStandardError();
+    }
+    return sample.values.empty() ? 0.0 : std::sqrt(pooledVariance);
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_ADAPTIVE_SAMPLER_H */
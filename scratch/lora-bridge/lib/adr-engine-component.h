@@ -0,0 +1,543 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Network-server ADR engine with ring-buffered per-device link history.
+//
+// Every device gets a slot in flat, preallocated arrays holding its last N
+// SNR and gateway-count samples. Once a slot is full, the engine compares the
+// SNR margin selected by the policy (max, average or min of the history) with
+// the demodulation floor of the current SF and converts the margin into 3 dB
+// steps: steps first lower the SF, then the TX power; a negative margin raises
+// the TX power back. Changes go out as a LinkADRReq in the next reply, whose
+// channel mask keeps the channels the device has enabled.
+//
+// Every gateway copy of an uplink reaches OnReceivedPacket, which only peeks
+// the FCnt and ADR bit. The sample of an FCnt is taken once, when the reply
+// is prepared (or fails) and every copy is in the received-packet info, so a
+// device heard by several gateways gets one sample per uplink with the right
+// gateway count.
+
+#ifndef LORA_BRIDGE_ADR_ENGINE_COMPONENT_H
+#define LORA_BRIDGE_ADR_ENGINE_COMPONENT_H
+
+#include "ns3/double.h"
+#include "ns3/end-device-status.h"
+#include "ns3/enum.h"
+#include "ns3/header.h"
+#include "ns3/logical-lora-channel-helper.h"
+#include "ns3/logical-lora-channel.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/network-controller-components.h"
+#include "ns3/network-status.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * The MAC and frame headers of an uplink, so that both can be peeked from a
+ * const packet without copying it.
+ */
+class AdrUplinkHeader : public Header
+{
+  public:
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+
+    uint32_t GetSerializedSize() const override;
+    void Serialize(Buffer::Iterator start) const override;
+    uint32_t Deserialize(Buffer::Iterator start) override;
+    void Print(std::ostream& os) const override;
+
+    /// @return The MAC header
+    const lorawan::LorawanMacHeader& GetMacHeader() const;
+
+    /// @return The frame header
+    const lorawan::LoraFrameHeader& GetFrameHeader() const;
+
+  private:
+    lorawan::LorawanMacHeader m_macHeader;  //!< MAC header
+    lorawan::LoraFrameHeader m_frameHeader; //!< Frame header, read as uplink
+};
+
+/**
+ * ADR network controller component keeping a fixed-size link history per
+ * device.
+ */
+class AdrEngineComponent : public lorawan::NetworkControllerComponent
+{
+  public:
+    /// Statistic of the SNR history used to compute the link margin
+    enum MarginPolicy
+    {
+        MARGIN_MAX,     //!< Best sample: aggressive
+        MARGIN_AVERAGE, //!< Mean of the samples
+        MARGIN_MIN,     //!< Worst sample: conservative
+    };
+
+    static TypeId GetTypeId();
+
+    AdrEngineComponent();
+
+    /**
+     * Size the history arrays for @p nDevices devices up front. Devices
+     * beyond this number still get a slot, at the cost of a reallocation.
+     *
+     * @param nDevices The expected number of devices.
+     */
+    void Reserve(uint32_t nDevices);
+
+    void OnReceivedPacket(Ptr<const Packet> packet,
+                          Ptr<lorawan::EndDeviceStatus> status,
+                          Ptr<lorawan::NetworkStatus> networkStatus) override;
+
+    void BeforeSendingReply(Ptr<lorawan::EndDeviceStatus> status,
+                            Ptr<lorawan::NetworkStatus> networkStatus) override;
+
+    void OnFailedReply(Ptr<lorawan::EndDeviceStatus> status,
+                       Ptr<lorawan::NetworkStatus> networkStatus) override;
+
+    /// @return The number of LinkADRReq commands issued
+    uint64_t GetCommandCount() const;
+
+    /// @return The number of devices with a history slot
+    uint32_t GetDeviceCount() const;
+
+    /// @return The last spreading factor commanded to @p address, or 0 if none
+    uint8_t GetSpreadingFactor(lorawan::LoraDeviceAddress address) const;
+
+    /// @return The last TX power commanded to @p address (dBm)
+    double GetTxPower(lorawan::LoraDeviceAddress address) const;
+
+  private:
+    /// @return The slot of @p address, allocating one if needed
+    uint32_t GetSlot(uint32_t address);
+
+    /// @return The SNR selected by the margin policy from the history of @p slot
+    double PolicySnr(uint32_t slot) const;
+
+    /// @return The mean gateway count in the history of @p slot
+    double MeanGatewayCount(uint32_t slot) const;
+
+    /**
+     * Take the sample of the last uplink of @p slot, once all of its gateway
+     * copies are in.
+     *
+     * @param slot The slot of the device.
+     * @param status The status of the device.
+     */
+    void RecordSample(uint32_t slot, Ptr<lorawan::EndDeviceStatus> status);
+
+    /// @return The TX power in dBm of TX power index @p index
+    double TxPowerForIndex(uint8_t index) const;
+
+    /// @return The uplink channels enabled on the device of @p status
+    static std::list<int> GetEnabledChannels(Ptr<lorawan::EndDeviceStatus> status);
+
+    MarginPolicy m_policy;       //!< Statistic used for the margin
+    uint32_t m_historyLength;    //!< Samples kept per device
+    double m_deviceMargin;       //!< Installation margin (dB)
+    double m_noiseFloor;         //!< Gateway noise floor (dBm)
+    double m_diversityGain;      //!< Margin credited per extra receiving gateway (dB)
+    double m_maxTxPower;         //!< TX power of index 0 (dBm)
+    double m_minTxPower;         //!< Lowest allowed TX power (dBm)
+
+    std::unordered_map<uint32_t, uint32_t> m_slots; //!< Device address to slot
+    std::vector<float> m_snr;       //!< SNR samples, m_historyLength per slot
+    std::vector<uint8_t> m_gateways; //!< Gateway-count samples, m_historyLength per slot
+    std::vector<uint16_t> m_head;   //!< Next write position of each slot
+    std::vector<uint16_t> m_fill;   //!< Valid samples of each slot
+    std::vector<uint8_t> m_sf;      //!< Current SF of each slot
+    std::vector<uint8_t> m_txIndex; //!< Current TX power index of each slot
+    std::vector<bool> m_adr;        //!< ADR bit of the last uplink of each slot
+    std::vector<uint32_t> m_fcnt;   //!< FCnt of the last uplink of each slot, NO_FCNT if none
+    std::vector<bool> m_pending;    //!< Last uplink of each slot not sampled yet
+    uint64_t m_commands;            //!< LinkADRReq commands issued
+
+    static constexpr uint32_t NO_FCNT = 0x10000; //!< Above any 16-bit FCnt
+};
+
+inline TypeId
+AdrUplinkHeader::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::AdrUplinkHeader")
+                            .SetParent<Header>()
+                            .SetGroupName("LoraBridge")
+                            .AddConstructor<AdrUplinkHeader>();
+    return tid;
+}
+
+inline TypeId
+AdrUplinkHeader::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+inline uint32_t
+AdrUplinkHeader::GetSerializedSize() const
+{
+    return m_macHeader.GetSerializedSize() + m_frameHeader.GetSerializedSize();
+}
+
+inline void
+AdrUplinkHeader::Serialize(Buffer::Iterator start) const
+{
+    m_macHeader.Serialize(start);
+    start.Next(m_macHeader.GetSerializedSize());
+    m_frameHeader.Serialize(start);
+}
+
+inline uint32_t
+AdrUplinkHeader::Deserialize(Buffer::Iterator start)
+{
+    uint32_t size = m_macHeader.Deserialize(start);
+    start.Next(size);
+    m_frameHeader.SetAsUplink();
+    return size + m_frameHeader.Deserialize(start);
+}
+
+inline void
+AdrUplinkHeader::Print(std::ostream& os) const
+{
+    m_macHeader.Print(os);
+    os << " ";
+    m_frameHeader.Print(os);
+}
+
+inline const lorawan::LorawanMacHeader&
+AdrUplinkHeader::GetMacHeader() const
+{
+    return m_macHeader;
+}
+
+inline const lorawan::LoraFrameHeader&
+AdrUplinkHeader::GetFrameHeader() const
+{
+    return m_frameHeader;
+}
+
+inline TypeId
+AdrEngineComponent::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::AdrEngineComponent")
+            .SetParent<lorawan::NetworkControllerComponent>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<AdrEngineComponent>()
+            .AddAttribute("MarginPolicy",
+                          "Statistic of the SNR history used to compute the link margin",
+                          EnumValue(AdrEngineComponent::MARGIN_MAX),
+                          MakeEnumAccessor<MarginPolicy>(&AdrEngineComponent::m_policy),
+                          MakeEnumChecker(AdrEngineComponent::MARGIN_MAX,
+                                          "Max",
+                                          AdrEngineComponent::MARGIN_AVERAGE,
+                                          "Average",
+                                          AdrEngineComponent::MARGIN_MIN,
+                                          "Min"))
+            .AddAttribute("HistoryLength",
+                          "Number of uplinks kept per device before ADR acts",
+                          UintegerValue(20),
+                          MakeUintegerAccessor(&AdrEngineComponent::m_historyLength),
+                          MakeUintegerChecker<uint32_t>(1, 255))
+            .AddAttribute("DeviceMargin",
+                          "Installation margin kept above the demodulation floor (dB)",
+                          DoubleValue(10.0),
+                          MakeDoubleAccessor(&AdrEngineComponent::m_deviceMargin),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("NoiseFloor",
+                          "Gateway noise floor over 125 kHz (dBm)",
+                          DoubleValue(-117.0),
+                          MakeDoubleAccessor(&AdrEngineComponent::m_noiseFloor),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("DiversityGain",
+                          "Margin credited for each gateway beyond the first (dB)",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&AdrEngineComponent::m_diversityGain),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("MaxTxPower",
+                          "TX power of index 0 (dBm)",
+                          DoubleValue(14.0),
+                          MakeDoubleAccessor(&AdrEngineComponent::m_maxTxPower),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("MinTxPower",
+                          "Lowest TX power the engine may command (dBm)",
+                          DoubleValue(2.0),
+                          MakeDoubleAccessor(&AdrEngineComponent::m_minTxPower),
+                          MakeDoubleChecker<double>());
+    return tid;
+}
+
+inline AdrEngineComponent::AdrEngineComponent()
+    : m_policy(MARGIN_MAX),
+      m_historyLength(20),
+      m_deviceMargin(10.0),
+      m_noiseFloor(-117.0),
+      m_diversityGain(0.0),
+      m_maxTxPower(14.0),
+      m_minTxPower(2.0),
+      m_commands(0)
+{
+}
+
+inline void
+AdrEngineComponent::Reserve(uint32_t nDevices)
+{
+    m_slots.reserve(nDevices);
+    m_snr.reserve(static_cast<size_t>(nDevices) * m_historyLength);
+    m_gateways.reserve(static_cast<size_t>(nDevices) * m_historyLength);
+    m_head.reserve(nDevices);
+    m_fill.reserve(nDevices);
+    m_sf.reserve(nDevices);
+    m_txIndex.reserve(nDevices);
+    m_adr.reserve(nDevices);
+    m_fcnt.reserve(nDevices);
+    m_pending.reserve(nDevices);
+}
+
+inline uint32_t
+AdrEngineComponent::GetSlot(uint32_t address)
+{
+    auto it = m_slots.find(address);
+    if (it != m_slots.end())
+    {
+        return it->second;
+    }
+    uint32_t slot = m_head.size();
+    m_slots.emplace(address, slot);
+    m_snr.resize(m_snr.size() + m_historyLength, 0.0f);
+    m_gateways.resize(m_gateways.size() + m_historyLength, 0);
+    m_head.push_back(0);
+    m_fill.push_back(0);
+    m_sf.push_back(0);
+    m_txIndex.push_back(0);
+    m_adr.push_back(false);
+    m_fcnt.push_back(NO_FCNT);
+    m_pending.push_back(false);
+    return slot;
+}
+
+inline void
+AdrEngineComponent::OnReceivedPacket(Ptr<const Packet> packet,
+                                     Ptr<lorawan::EndDeviceStatus> status,
+                                     Ptr<lorawan::NetworkStatus> networkStatus)
+{
+    uint32_t slot = GetSlot(status->GetMac()->GetDeviceAddress().Get());
+    if (m_sf[slot] == 0)
+    {
+        m_sf[slot] = status->GetFirstReceiveWindowSpreadingFactor();
+    }
+
+    AdrUplinkHeader header;
+    if (packet->PeekHeader(header) == 0 || !header.GetMacHeader().IsUplink())
+    {
+        return;
+    }
+    // Further copies of this uplink, from other gateways
+    uint16_t fcnt = header.GetFrameHeader().GetFCnt();
+    if (fcnt == m_fcnt[slot])
+    {
+        return;
+    }
+    m_fcnt[slot] = fcnt;
+    m_adr[slot] = header.GetFrameHeader().GetAdr();
+    m_pending[slot] = true;
+}
+
+inline void
+AdrEngineComponent::RecordSample(uint32_t slot, Ptr<lorawan::EndDeviceStatus> status)
+{
+    if (!m_pending[slot])
+    {
+        return;
+    }
+    m_pending[slot] = false;
+
+    double bestRxPower = -1000.0;
+    uint32_t nGateways = 0;
+    const lorawan::EndDeviceStatus::ReceivedPacketInfo& info = status->GetLastReceivedPacketInfo();
+    for (const auto& gw : info.gwList)
+    {
+        bestRxPower = std::max(bestRxPower, gw.second.rxPower);
+        nGateways++;
+    }
+    if (nGateways == 0)
+    {
+        return;
+    }
+
+    size_t base = static_cast<size_t>(slot) * m_historyLength;
+    m_snr[base + m_head[slot]] = static_cast<float>(bestRxPower - m_noiseFloor);
+    m_gateways[base + m_head[slot]] = std::min<uint32_t>(nGateways, 255);
+    m_head[slot] = (m_head[slot] + 1) % m_historyLength;
+    m_fill[slot] = std::min<uint32_t>(m_fill[slot] + 1, m_historyLength);
+}
+
+inline void
+AdrEngineComponent::BeforeSendingReply(Ptr<lorawan::EndDeviceStatus> status,
+                                       Ptr<lorawan::NetworkStatus> networkStatus)
+{
+    auto it = m_slots.find(status->GetMac()->GetDeviceAddress().Get());
+    if (it == m_slots.end())
+    {
+        return;
+    }
+    uint32_t slot = it->second;
+    RecordSample(slot, status);
+    if (!m_adr[slot] || m_fill[slot] < m_historyLength)
+    {
+        return;
+    }
+
+    // Demodulation floor of SF7 to SF12
+    static const double requiredSnr[6] = {-7.5, -10.0, -12.5, -15.0, -17.5, -20.0};
+
+    uint8_t sf = std::min<uint8_t>(std::max<uint8_t>(m_sf[slot], 7), 12);
+    uint8_t txIndex = m_txIndex[slot];
+    double margin = PolicySnr(slot) - requiredSnr[sf - 7] - m_deviceMargin +
+                    m_diversityGain * (MeanGatewayCount(slot) - 1.0);
+    int steps = static_cast<int>(std::floor(margin / 3.0));
+
+    while (steps > 0 && sf > 7)
+    {
+        sf--;
+        steps--;
+    }
+    while (steps > 0 && TxPowerForIndex(txIndex + 1) >= m_minTxPower)
+    {
+        txIndex++;
+        steps--;
+    }
+    while (steps < 0 && txIndex > 0)
+    {
+        txIndex--;
+        steps++;
+    }
+
+    if (sf == m_sf[slot] && txIndex == m_txIndex[slot])
+    {
+        return;
+    }
+
+    // Data rates are 12 - SF in EU868; the device disables any channel left out of the mask
+    status->m_reply.frameHeader.SetAsDownlink();
+    status->m_reply.frameHeader.AddLinkAdrReq(12 - sf, txIndex, GetEnabledChannels(status), 0);
+    if (!status->m_reply.needsReply)
+    {
+        status->m_reply.macHeader.SetMType(lorawan::LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+        status->m_reply.needsReply = true;
+    }
+    m_sf[slot] = sf;
+    m_txIndex[slot] = txIndex;
+    m_commands++;
+
+    // Samples taken with the old settings no longer describe the link
+    m_fill[slot] = 0;
+    m_head[slot] = 0;
+}
+
+inline void
+AdrEngineComponent::OnFailedReply(Ptr<lorawan::EndDeviceStatus> status,
+                                  Ptr<lorawan::NetworkStatus> networkStatus)
+{
+    auto it = m_slots.find(status->GetMac()->GetDeviceAddress().Get());
+    if (it != m_slots.end())
+    {
+        RecordSample(it->second, status);
+    }
+}
+
+inline double
+AdrEngineComponent::PolicySnr(uint32_t slot) const
+{
+    size_t base = static_cast<size_t>(slot) * m_historyLength;
+    double best = m_snr[base];
+    double worst = m_snr[base];
+    double sum = 0.0;
+    for (uint32_t k = 0; k < m_fill[slot]; ++k)
+    {
+        best = std::max<double>(best, m_snr[base + k]);
+        worst = std::min<double>(worst, m_snr[base + k]);
+        sum += m_snr[base + k];
+    }
+    switch (m_policy)
+    {
+    case MARGIN_MIN:
+        return worst;
+    case MARGIN_AVERAGE:
+        return sum / m_fill[slot];
+    default:
+        return best;
+    }
+}
+
+inline double
+AdrEngineComponent::MeanGatewayCount(uint32_t slot) const
+{
+    size_t base = static_cast<size_t>(slot) * m_historyLength;
+    double sum = 0.0;
+    for (uint32_t k = 0; k < m_fill[slot]; ++k)
+    {
+        sum += m_gateways[base + k];
+    }
+    return m_fill[slot] ? sum / m_fill[slot] : 0.0;
+}
+
+inline double
+AdrEngineComponent::TxPowerForIndex(uint8_t index) const
+{
+    return m_maxTxPower - 2.0 * index;
+}
+
+inline std::list<int>
+AdrEngineComponent::GetEnabledChannels(Ptr<lorawan::EndDeviceStatus> status)
+{
+    std::list<int> enabled;
+    std::vector<Ptr<lorawan::LogicalLoraChannel>> channels =
+        status->GetMac()->GetLogicalLoraChannelHelper()->GetRawChannelArray();
+    for (size_t i = 0; i < channels.size(); ++i)
+    {
+        if (channels[i] && channels[i]->IsEnabledForUplink())
+        {
+            enabled.push_back(i);
+        }
+    }
+    return enabled;
+}
+
+inline uint64_t
+AdrEngineComponent::GetCommandCount() const
+{
+    return m_commands;
+}
+
+inline uint32_t
+AdrEngineComponent::GetDeviceCount() const
+{
+    return m_head.size();
+}
+
+inline uint8_t
+AdrEngineComponent::GetSpreadingFactor(lorawan::LoraDeviceAddress address) const
+{
+    auto it = m_slots.find(address.Get());
+    return it == m_slots.end() ? 0 : m_sf[it->second];
+}
+
+inline double
+AdrEngineComponent::GetTxPower(lorawan::LoraDeviceAddress address) const
+{
+    auto it = m_slots.find(address.Get());
+    return TxPowerForIndex(it == m_slots.end() ? 0 : m_txIndex[it->second]);
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_ADR_ENGINE_COMPONENT_H */
@@ -0,0 +1,668 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Stochastic arrival processes for the bridge end-device senders.
+//
+// Every process owns its random variables, so a device's traffic can be pinned
+// to a dedicated RNG stream with AssignStreams(). Inter-arrival times are drawn
+// in blocks of BlockSize values and handed out one by one, which keeps the RNG
+// calls out of the per-packet path.
+
+#ifndef LORA_BRIDGE_ARRIVAL_PROCESS_H
+#define LORA_BRIDGE_ARRIVAL_PROCESS_H
+
+#include "ns3/callback.h"
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Base class of the inter-arrival time generators.
+ *
+ * Subclasses only implement FillBlock(); the base class takes care of handing
+ * out the pre-generated values and of refilling the block when it runs dry.
+ */
+class ArrivalProcess : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    ArrivalProcess();
+
+    /**
+     * @return The time until the next arrival.
+     */
+    Time NextInterArrival();
+
+    /**
+     * Change the mean inter-arrival time. Values already drawn for the current
+     * block are discarded.
+     *
+     * @param mean The new mean inter-arrival time.
+     */
+    virtual void SetMeanInterval(Time mean) = 0;
+
+    /**
+     * @return The mean inter-arrival time.
+     */
+    virtual Time GetMeanInterval() const = 0;
+
+    /**
+     * Assign fixed random variable streams.
+     *
+     * @param stream The first stream index to use.
+     * @return The number of streams assigned.
+     */
+    virtual int64_t AssignStreams(int64_t stream) = 0;
+
+  protected:
+    /**
+     * Draw a new block of inter-arrival times, in seconds.
+     *
+     * @param block The block to fill; it is already sized to BlockSize.
+     */
+    virtual void FillBlock(std::vector<double>& block) = 0;
+
+    /**
+     * Drop the values left in the current block, e.g. after a parameter change.
+     */
+    void ResetBlock();
+
+  private:
+    std::vector<double> m_block; //!< Pre-generated inter-arrival times (s)
+    uint32_t m_blockSize;        //!< Number of values drawn per refill
+    size_t m_next;               //!< Index of the next value to hand out
+};
+
+/**
+ * Fixed period with a uniform jitter of +/- Jitter around it. With a zero
+ * jitter this is the plain periodic sender.
+ */
+class PeriodicArrivalProcess : public ArrivalProcess
+{
+  public:
+    static TypeId GetTypeId();
+
+    PeriodicArrivalProcess();
+
+    void SetMeanInterval(Time mean) override;
+    Time GetMeanInterval() const override;
+    int64_t AssignStreams(int64_t stream) override;
+
+  protected:
+    void FillBlock(std::vector<double>& block) override;
+
+  private:
+    Time m_period;                        //!< Nominal period
+    Time m_jitter;                        //!< Maximum deviation from the period
+    Ptr<UniformRandomVariable> m_uniform; //!< Jitter draws
+};
+
+/**
+ * Poisson arrivals: exponentially distributed inter-arrival times.
+ */
+class PoissonArrivalProcess : public ArrivalProcess
+{
+  public:
+    static TypeId GetTypeId();
+
+    PoissonArrivalProcess();
+
+    void SetMeanInterval(Time mean) override;
+    Time GetMeanInterval() const override;
+    int64_t AssignStreams(int64_t stream) override;
+
+  protected:
+    void FillBlock(std::vector<double>& block) override;
+
+  private:
+    Time m_mean;                                //!< Mean inter-arrival time
+    Ptr<ExponentialRandomVariable> m_exponential; //!< Inter-arrival draws
+};
+
+/**
+ * Two-state Markov-modulated Poisson process.
+ *
+ * The device alternates between a quiet state and a burst state, with
+ * exponentially distributed sojourn times. Each state emits Poisson arrivals
+ * at its own rate; the burst rate is BurstRateFactor times the quiet rate.
+ */
+class MmppArrivalProcess : public ArrivalProcess
+{
+  public:
+    static TypeId GetTypeId();
+
+    MmppArrivalProcess();
+
+    /**
+     * Scales both state rates so that the long-run mean interval becomes
+     * @p mean, keeping the burst-to-quiet ratio and the sojourn times.
+     */
+    void SetMeanInterval(Time mean) override;
+    Time GetMeanInterval() const override;
+    int64_t AssignStreams(int64_t stream) override;
+
+  protected:
+    void FillBlock(std::vector<double>& block) override;
+
+  private:
+    Time m_quietInterval;    //!< Mean inter-arrival time in the quiet state
+    double m_burstFactor;    //!< Burst rate / quiet rate
+    Time m_quietSojourn;     //!< Mean time spent in the quiet state
+    Time m_burstSojourn;     //!< Mean time spent in the burst state
+    bool m_inBurst;          //!< Current modulating state
+    Ptr<UniformRandomVariable> m_uniform; //!< Competing-clock draws
+};
+
+/**
+ * Spatially correlated event storms, e.g. a truck crossing the bridge.
+ *
+ * Storms arrive as a Poisson process. Each storm has a random epicenter along
+ * the x axis of the bridge and a random radius; every registered device within
+ * the radius fires its trigger callback after a delay proportional to its
+ * distance from the epicenter, plus a small per-device jitter.
+ */
+class EventStormGenerator : public Object
+{
+  public:
+    static TypeId GetTypeId();
+
+    EventStormGenerator();
+
+    /// Callback invoked for every device hit by a storm, with its index
+    typedef Callback<void, uint32_t> TriggerCallback;
+
+    /**
+     * Register a device.
+     *
+     * @param index The index passed back to the trigger callback.
+     * @param position The position of the device.
+     */
+    void AddDevice(uint32_t index, Vector position);
+
+    /**
+     * @param trigger The callback run when a storm reaches a device.
+     */
+    void SetTriggerCallback(TriggerCallback trigger);
+
+    /**
+     * Schedule the first storm and keep generating them until @p stop.
+     *
+     * @param start Earliest time of the first storm.
+     * @param stop No storm starts after this time.
+     */
+    void Start(Time start, Time stop);
+
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * @return The number of storms generated so far.
+     */
+    uint32_t GetStormCount() const;
+
+  private:
+    /// Run one storm and schedule the next one
+    void Storm();
+
+    /// Time until the next storm, from the pre-generated block
+    Time NextStormInterval();
+
+    Time m_meanInterval;      //!< Mean time between storms
+    double m_minX;            //!< Lower bound of the epicenter position (m)
+    double m_maxX;            //!< Upper bound of the epicenter position (m)
+    double m_minRadius;       //!< Smallest storm radius (m)
+    double m_maxRadius;       //!< Largest storm radius (m)
+    double m_speed;           //!< Propagation speed of the storm front (m/s)
+    Time m_jitter;            //!< Maximum per-device trigger jitter
+    uint32_t m_blockSize;     //!< Storm intervals drawn per refill
+    Time m_stop;              //!< No storm starts after this time
+    uint32_t m_storms;        //!< Storms generated so far
+
+    std::vector<uint32_t> m_indices; //!< Registered device indices
+    std::vector<double> m_x;         //!< Registered device x coordinates
+    std::vector<double> m_intervals; //!< Pre-generated storm intervals (s)
+    size_t m_nextInterval;           //!< Next value in m_intervals
+    TriggerCallback m_trigger;       //!< Per-device trigger
+
+    Ptr<ExponentialRandomVariable> m_interval; //!< Storm inter-arrival draws
+    Ptr<UniformRandomVariable> m_uniform;      //!< Epicenter, radius and jitter draws
+};
+
+/***************
+ * ArrivalProcess
+ ***************/
+
+inline TypeId
+ArrivalProcess::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ArrivalProcess")
+            .SetParent<Object>()
+            .SetGroupName("LoraBridge")
+            .AddAttribute("BlockSize",
+                          "Number of inter-arrival times drawn at once",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&ArrivalProcess::m_blockSize),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+inline ArrivalProcess::ArrivalProcess()
+    : m_blockSize(64),
+      m_next(0)
+{
+}
+
+inline Time
+ArrivalProcess::NextInterArrival()
+{
+    if (m_next >= m_block.size())
+    {
+        m_block.assign(m_blockSize, 0.0);
+        FillBlock(m_block);
+        m_next = 0;
+    }
+    return Seconds(m_block[m_next++]);
+}
+
+inline void
+ArrivalProcess::ResetBlock()
+{
+    m_block.clear();
+    m_next = 0;
+}
+
+/***************
+ * PeriodicArrivalProcess
+ ***************/
+
+inline TypeId
+PeriodicArrivalProcess::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PeriodicArrivalProcess")
+            .SetParent<ArrivalProcess>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<PeriodicArrivalProcess>()
+            .AddAttribute("Period",
+                          "Nominal time between two packets",
+                          TimeValue(Minutes(15)),
+                          MakeTimeAccessor(&PeriodicArrivalProcess::m_period),
+                          MakeTimeChecker())
+            .AddAttribute("Jitter",
+                          "Maximum deviation from the nominal period",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&PeriodicArrivalProcess::m_jitter),
+                          MakeTimeChecker());
+    return tid;
+}
+
+inline PeriodicArrivalProcess::PeriodicArrivalProcess()
+    : m_period(Minutes(15)),
+      m_jitter(Seconds(0)),
+      m_uniform(CreateObject<UniformRandomVariable>())
+{
+}
+
+inline void
+PeriodicArrivalProcess::SetMeanInterval(Time mean)
+{
+    m_period = mean;
+    ResetBlock();
+}
+
+inline Time
+PeriodicArrivalProcess::GetMeanInterval() const
+{
+    return m_period;
+}
+
+inline int64_t
+PeriodicArrivalProcess::AssignStreams(int64_t stream)
+{
+    m_uniform->SetStream(stream);
+    return 1;
+}
+
+inline void
+PeriodicArrivalProcess::FillBlock(std::vector<double>& block)
+{
+    double period = m_period.GetSeconds();
+    double jitter = m_jitter.GetSeconds();
+    for (auto& value : block)
+    {
+        value = period;
+        if (jitter > 0)
+        {
+            value = std::max(0.0, period + m_uniform->GetValue(-jitter, jitter));
+        }
+    }
+}
+
+/***************
+ * PoissonArrivalProcess
+ ***************/
+
+inline TypeId
+PoissonArrivalProcess::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PoissonArrivalProcess")
+            .SetParent<ArrivalProcess>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<PoissonArrivalProcess>()
+            .AddAttribute("MeanInterval",
+                          "Mean time between two packets",
+                          TimeValue(Minutes(15)),
+                          MakeTimeAccessor(&PoissonArrivalProcess::m_mean),
+                          MakeTimeChecker());
+    return tid;
+}
+
+inline PoissonArrivalProcess::PoissonArrivalProcess()
+    : m_mean(Minutes(15)),
+      m_exponential(CreateObject<ExponentialRandomVariable>())
+{
+}
+
+inline void
+PoissonArrivalProcess::SetMeanInterval(Time mean)
+{
+    m_mean = mean;
+    ResetBlock();
+}
+
+inline Time
+PoissonArrivalProcess::GetMeanInterval() const
+{
+    return m_mean;
+}
+
+inline int64_t
+PoissonArrivalProcess::AssignStreams(int64_t stream)
+{
+    m_exponential->SetStream(stream);
+    return 1;
+}
+
+inline void
+PoissonArrivalProcess::FillBlock(std::vector<double>& block)
+{
+    double mean = m_mean.GetSeconds();
+    for (auto& value : block)
+    {
+        // No bound: the tail of the distribution is what produces the bursts
+        value = m_exponential->GetValue(mean, 0);
+    }
+}
+
+/***************
+ * MmppArrivalProcess
+ ***************/
+
+inline TypeId
+MmppArrivalProcess::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MmppArrivalProcess")
+            .SetParent<ArrivalProcess>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<MmppArrivalProcess>()
+            .AddAttribute("QuietInterval",
+                          "Mean time between two packets in the quiet state",
+                          TimeValue(Minutes(15)),
+                          MakeTimeAccessor(&MmppArrivalProcess::m_quietInterval),
+                          MakeTimeChecker())
+            .AddAttribute("BurstRateFactor",
+                          "Ratio between the burst-state and the quiet-state packet rates",
+                          DoubleValue(30.0),
+                          MakeDoubleAccessor(&MmppArrivalProcess::m_burstFactor),
+                          MakeDoubleChecker<double>(1.0))
+            .AddAttribute("QuietSojourn",
+                          "Mean time spent in the quiet state",
+                          TimeValue(Hours(2)),
+                          MakeTimeAccessor(&MmppArrivalProcess::m_quietSojourn),
+                          MakeTimeChecker())
+            .AddAttribute("BurstSojourn",
+                          "Mean time spent in the burst state",
+                          TimeValue(Minutes(5)),
+                          MakeTimeAccessor(&MmppArrivalProcess::m_burstSojourn),
+                          MakeTimeChecker());
+    return tid;
+}
+
+inline MmppArrivalProcess::MmppArrivalProcess()
+    : m_quietInterval(Minutes(15)),
+      m_burstFactor(30.0),
+      m_quietSojourn(Hours(2)),
+      m_burstSojourn(Minutes(5)),
+      m_inBurst(false),
+      m_uniform(CreateObject<UniformRandomVariable>())
+{
+}
+
+inline void
+MmppArrivalProcess::SetMeanInterval(Time mean)
+{
+    m_quietInterval = Seconds(m_quietInterval.GetSeconds() * mean.GetSeconds() /
+                              GetMeanInterval().GetSeconds());
+    ResetBlock();
+}
+
+inline Time
+MmppArrivalProcess::GetMeanInterval() const
+{
+    double quiet = m_quietSojourn.GetSeconds();
+    double burst = m_burstSojourn.GetSeconds();
+    double quietRate = 1.0 / m_quietInterval.GetSeconds();
+    double meanRate = (quiet * quietRate + burst * quietRate * m_burstFactor) / (quiet + burst);
+    return Seconds(1.0 / meanRate);
+}
+
+inline int64_t
+MmppArrivalProcess::AssignStreams(int64_t stream)
+{
+    m_uniform->SetStream(stream);
+    return 1;
+}
+
+inline void
+MmppArrivalProcess::FillBlock(std::vector<double>& block)
+{
+    double quietRate = 1.0 / m_quietInterval.GetSeconds();
+    double burstRate = quietRate * m_burstFactor;
+    double leaveQuiet = 1.0 / m_quietSojourn.GetSeconds();
+    double leaveBurst = 1.0 / m_burstSojourn.GetSeconds();
+
+    for (auto& value : block)
+    {
+        // Race the arrival clock against the state-switch clock until an
+        // arrival wins; switches only add to the elapsed time.
+        double elapsed = 0;
+        while (true)
+        {
+            double arrivalRate = m_inBurst ? burstRate : quietRate;
+            double switchRate = m_inBurst ? leaveBurst : leaveQuiet;
+            double totalRate = arrivalRate + switchRate;
+            elapsed += -std::log(1.0 - m_uniform->GetValue()) / totalRate;
+            if (m_uniform->GetValue() * totalRate < arrivalRate)
+            {
+                break;
+            }
+            m_inBurst = !m_inBurst;
+        }
+        value = elapsed;
+    }
+}
+
+/***************
+ * EventStormGenerator
+ ***************/
+
+inline TypeId
+EventStormGenerator::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::EventStormGenerator")
+            .SetParent<Object>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<EventStormGenerator>()
+            .AddAttribute("MeanInterval",
+                          "Mean time between two storms",
+                          TimeValue(Hours(1)),
+                          MakeTimeAccessor(&EventStormGenerator::m_meanInterval),
+                          MakeTimeChecker())
+            .AddAttribute("MinX",
+                          "Lower bound of the storm epicenter along the bridge (m)",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&EventStormGenerator::m_minX),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("MaxX",
+                          "Upper bound of the storm epicenter along the bridge (m)",
+                          DoubleValue(100.0),
+                          MakeDoubleAccessor(&EventStormGenerator::m_maxX),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("MinRadius",
+                          "Smallest distance from the epicenter that a storm reaches (m)",
+                          DoubleValue(20.0),
+                          MakeDoubleAccessor(&EventStormGenerator::m_minRadius),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("MaxRadius",
+                          "Largest distance from the epicenter that a storm reaches (m)",
+                          DoubleValue(200.0),
+                          MakeDoubleAccessor(&EventStormGenerator::m_maxRadius),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("Speed",
+                          "Propagation speed of the storm front, e.g. a vehicle (m/s)",
+                          DoubleValue(20.0),
+                          MakeDoubleAccessor(&EventStormGenerator::m_speed),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("Jitter",
+                          "Maximum extra delay before a reached device reports",
+                          TimeValue(Seconds(2)),
+                          MakeTimeAccessor(&EventStormGenerator::m_jitter),
+                          MakeTimeChecker())
+            .AddAttribute("BlockSize",
+                          "Number of storm intervals drawn at once",
+                          UintegerValue(16),
+                          MakeUintegerAccessor(&EventStormGenerator::m_blockSize),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+inline EventStormGenerator::EventStormGenerator()
+    : m_meanInterval(Hours(1)),
+      m_minX(0.0),
+      m_maxX(100.0),
+      m_minRadius(20.0),
+      m_maxRadius(200.0),
+      m_speed(20.0),
+      m_jitter(Seconds(2)),
+      m_blockSize(16),
+      m_stop(Seconds(0)),
+      m_storms(0),
+      m_nextInterval(0),
+      m_interval(CreateObject<ExponentialRandomVariable>()),
+      m_uniform(CreateObject<UniformRandomVariable>())
+{
+}
+
+inline void
+EventStormGenerator::AddDevice(uint32_t index, Vector position)
+{
+    m_indices.push_back(index);
+    m_x.push_back(position.x);
+}
+
+inline void
+EventStormGenerator::SetTriggerCallback(TriggerCallback trigger)
+{
+    m_trigger = trigger;
+}
+
+inline void
+EventStormGenerator::Start(Time start, Time stop)
+{
+    m_stop = stop;
+    Time first = start + NextStormInterval();
+    if (first < m_stop)
+    {
+        Simulator::Schedule(first - Simulator::Now(), &EventStormGenerator::Storm, this);
+    }
+}
+
+inline int64_t
+EventStormGenerator::AssignStreams(int64_t stream)
+{
+    m_interval->SetStream(stream);
+    m_uniform->SetStream(stream + 1);
+    return 2;
+}
+
+inline uint32_t
+EventStormGenerator::GetStormCount() const
+{
+    return m_storms;
+}
+
+inline Time
+EventStormGenerator::NextStormInterval()
+{
+    if (m_nextInterval >= m_intervals.size())
+    {
+        double mean = m_meanInterval.GetSeconds();
+        m_intervals.resize(m_blockSize);
+        for (auto& value : m_intervals)
+        {
+            value = m_interval->GetValue(mean, 0);
+        }
+        m_nextInterval = 0;
+    }
+    return Seconds(m_intervals[m_nextInterval++]);
+}
+
+inline void
+EventStormGenerator::Storm()
+{
+    m_storms++;
+    double epicenter = m_uniform->GetValue(m_minX, m_maxX);
+    double radius = m_uniform->GetValue(m_minRadius, m_maxRadius);
+    double jitter = m_jitter.GetSeconds();
+
+    for (size_t i = 0; i < m_x.size(); ++i)
+    {
+        double distance = std::abs(m_x[i] - epicenter);
+        if (distance > radius || m_trigger.IsNull())
+        {
+            continue;
+        }
+        double delay = (m_speed > 0 ? distance / m_speed : 0.0) + m_uniform->GetValue(0, jitter);
+        Simulator::Schedule(Seconds(delay), m_trigger, m_indices[i]);
+    }
+
+    Time next = NextStormInterval();
+    if (Simulator::Now() + next < m_stop)
+    {
+        Simulator::Schedule(next, &EventStormGenerator::Storm, this);
+    }
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_ARRIVAL_PROCESS_H */
@@ -0,0 +1,325 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Asynchronous processing of trace events.
+//
+// In the asynchronous mode a trace sink only fills a fixed-size TraceRecord
+// and pushes it into a lock-free single-producer/single-consumer ring. A
+// background thread pops the records and runs the scenario bookkeeping
+// (ledgers, histograms, duty-cycle windows) off the simulator thread.
+//
+// The handler runs on the background thread: it may only touch the state it
+// owns, never ns-3 objects or the simulator, and that state may only be read
+// by the simulator thread after Stop(). A full ring makes the producer wait,
+// so no record is ever dropped.
+
+#ifndef LORA_BRIDGE_ASYNC_TRACE_H
+#define LORA_BRIDGE_ASYNC_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * One trace event, as copied out of the packet by the sink.
+ */
+struct TraceRecord
+{
+    int64_t timeNs;     //!< Simulation time of the event (ns)
+    uint32_t node;      //!< Device or gateway index
+    uint32_t packetId;  //!< Scenario packet id, 0 if untagged
+    uint32_t frequency; //!< Frequency from the LoraTag (Hz), 0 if untagged
+    uint16_t size;      //!< Packet size (bytes)
+    uint8_t kind;       //!< Scenario-defined event kind
+    uint8_t sf;         //!< Spreading factor from the LoraTag, 0 if untagged
+    uint8_t header[8];  //!< First bytes of the packet: MHDR, DevAddr, FCtrl, FCnt
+};
+
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord must stay half a cache line");
+
+/**
+ * Bounded lock-free single-producer/single-consumer queue.
+ *
+ * The producer and consumer indices live on separate cache lines, each next
+ * to a cached copy of the other index, so that the two threads only share a
+ * line when the ring looks full or empty.
+ */
+template <typename T>
+class SpscRing
+{
+  public:
+    /// @param capacity Number of slots, rounded up to a power of two.
+    explicit SpscRing(size_t capacity = 1024);
+
+    /**
+     * Resize and empty the ring; neither thread may use it meanwhile.
+     *
+     * @param capacity Number of slots, rounded up to a power of two.
+     */
+    void Reset(size_t capacity);
+
+    /**
+     * Producer side.
+     *
+     * @param item Item to append.
+     * @return False if the ring is full.
+     */
+    bool TryPush(const T& item);
+
+    /**
+     * Consumer side.
+     *
+     * @param item Set to the oldest item.
+     * @return False if the ring is empty.
+     */
+    bool TryPop(T& item);
+
+    /// @return The number of slots
+    size_t GetCapacity() const;
+
+  private:
+    std::vector<T> m_slots; //!< Storage
+    size_t m_mask;          //!< Capacity - 1
+
+    alignas(64) std::atomic<size_t> m_head; //!< Next slot to write, owned by the producer
+    size_t m_cachedTail;                    //!< Producer's copy of m_tail
+
+    alignas(64) std::atomic<size_t> m_tail; //!< Next slot to read, owned by the consumer
+    size_t m_cachedHead;                    //!< Consumer's copy of m_head
+};
+
+/**
+ * Background consumer of TraceRecords.
+ */
+class AsyncTraceProcessor
+{
+  public:
+    /// Function run on the background thread for every record
+    typedef std::function<void(const TraceRecord&)> Handler;
+
+    AsyncTraceProcessor();
+    ~AsyncTraceProcessor();
+
+    /**
+     * Start the background thread.
+     *
+     * @param capacity Records the ring holds.
+     * @param handler Bookkeeping run for every record.
+     */
+    void Start(size_t capacity, Handler handler);
+
+    /**
+     * Queue a record; waits while the ring is full.
+     *
+     * @param record The record.
+     */
+    void Push(const TraceRecord& record);
+
+    /// Process the queued records and join the background thread
+    void Stop();
+
+    /// @return Whether the background thread runs
+    bool IsRunning() const;
+
+    /// @return The number of records processed, valid after Stop()
+    uint64_t GetProcessedCount() const;
+
+    /// @return The number of pushes that found the ring full
+    uint64_t GetStallCount() const;
+
+  private:
+    /// Body of the background thread
+    void Run();
+
+    SpscRing<TraceRecord> m_ring; //!< Records not yet processed
+    Handler m_handler;            //!< Bookkeeping
+    std::thread m_thread;         //!< Background thread
+    std::atomic<bool> m_stop;     //!< Set by Stop()
+    uint64_t m_processed;         //!< Written by the background thread only
+    uint64_t m_stalls;            //!< Written by the producer only
+};
+
+template <typename T>
+SpscRing<T>::SpscRing(size_t capacity)
+    : m_mask(0),
+      m_head(0),
+      m_cachedTail(0),
+      m_tail(0),
+      m_cachedHead(0)
+{
+    Reset(capacity);
+}
+
+template <typename T>
+void
+SpscRing<T>::Reset(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    m_slots.assign(size, T());
+    m_mask = size - 1;
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_cachedTail = 0;
+    m_cachedHead = 0;
+}
+
+template <typename T>
+bool
+SpscRing<T>::TryPush(const T& item)
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_cachedTail > m_mask)
+    {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        if (head - m_cachedTail > m_mask)
+        {
+            return false;
+        }
+    }
+    m_slots[head & m_mask] = item;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool
+SpscRing<T>::TryPop(T& item)
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_cachedHead)
+    {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        if (tail == m_cachedHead)
+        {
+            return false;
+        }
+    }
+    item = m_slots[tail & m_mask];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+size_t
+SpscRing<T>::GetCapacity() const
+{
+    return m_mask + 1;
+}
+
+inline AsyncTraceProcessor::AsyncTraceProcessor()
+    : m_stop(false),
+      m_processed(0),
+      m_stalls(0)
+{
+}
+
+inline AsyncTraceProcessor::~AsyncTraceProcessor()
+{
+    Stop();
+}
+
+inline void
+AsyncTraceProcessor::Start(size_t capacity, Handler handler)
+{
+    Stop();
+    m_ring.Reset(capacity);
+    m_handler = handler;
+    m_stop.store(false, std::memory_order_relaxed);
+    m_processed = 0;
+    m_stalls = 0;
+    m_thread = std::thread(&AsyncTraceProcessor::Run, this);
+}
+
+inline void
+AsyncTraceProcessor::Push(const TraceRecord& record)
+{
+    if (m_ring.TryPush(record))
+    {
+        return;
+    }
+    m_stalls++;
+    while (!m_ring.TryPush(record))
+    {
+        std::this_thread::yield();
+    }
+}
+
+inline void
+AsyncTraceProcessor::Stop()
+{
+    if (m_thread.joinable())
+    {
+        m_stop.store(true, std::memory_order_release);
+        m_thread.join();
+    }
+}
+
+inline bool
+AsyncTraceProcessor::IsRunning() const
+{
+    return m_thread.joinable();
+}
+
+inline uint64_t
+AsyncTraceProcessor::GetProcessedCount() const
+{
+    return m_processed;
+}
+
+inline uint64_t
+AsyncTraceProcessor::GetStallCount() const
+{
+    return m_stalls;
+}
+
+inline void
+AsyncTraceProcessor::Run()
+{
+    TraceRecord record;
+    uint32_t idlePolls = 0;
+    while (true)
+    {
+        if (m_ring.TryPop(record))
+        {
+            m_handler(record);
+            m_processed++;
+            idlePolls = 0;
+            continue;
+        }
+        if (m_stop.load(std::memory_order_acquire))
+        {
+            // Every push happened before the stop flag was set
+            while (m_ring.TryPop(record))
+            {
+                m_handler(record);
+                m_processed++;
+            }
+            return;
+        }
+        // Spin briefly, then back off so an idle consumer does not hold a core
+        if (++idlePolls < 64)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_ASYNC_TRACE_H */
@@ -0,0 +1,245 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Nakagami-m fading with an importance sampling bias towards deep fades.
+//
+// The model draws the received power like NakagamiPropagationLossModel
+// (same Distance1/Distance2 and m0/m1/m2 attributes): a Gamma variable of
+// shape m whose mean is the power given by the models before it. On the
+// links towards the biased receivers (the gateways), the mean is lowered by
+// the Bias attribute, in dB. Fades below the gateway sensitivity become
+// common, and every draw records the log of its likelihood ratio
+//
+//   ln(f(G) / f_biased(G)) = m ln(b) + (G / theta) (1 / b - 1),
+//
+// where G is the drawn power, theta = mean / m and b = 10^(-Bias / 10).
+// Multiplying a reception outcome by the likelihood ratios of all the draws
+// it depends on (its own and those of the transmissions it overlapped at
+// the same receiver) gives an unbiased estimate of its probability under the
+// unbiased fading. GetLogWeight() sums the ratios recorded at a receiver
+// over a time span that covers those draws. Extra draws that do not affect
+// the outcome keep the estimate unbiased and only widen its variance.
+//
+// Only the draws from a transmitter that is not itself a biased receiver are
+// biased, so the downlinks, and through them the ACKs, keep the plain fading.
+// A scale tilt cannot favour collisions, since it cancels in the signal to
+// interference ratio; collision losses are still weighted exactly through
+// the draws of the interferers. The estimate is exact when the traffic does
+// not react to the outcomes. Retransmissions of confirmed uplinks do, through
+// draws older than the span, and slightly bias it.
+//
+// With a zero Bias, or for receivers not added with AddBiasedReceiver(), the
+// model is plain Nakagami fading and records nothing.
+
+#ifndef LORA_BRIDGE_BIASED_NAKAGAMI_LOSS_MODEL_H
+#define LORA_BRIDGE_BIASED_NAKAGAMI_LOSS_MODEL_H
+
+#include "ns3/double.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <utility>
+
+namespace ns3
+{
+
+/**
+ * Nakagami-m fading biased towards deep fades at selected receivers, with
+ * the likelihood ratio of every biased draw.
+ */
+class BiasedNakagamiLossModel : public PropagationLossModel
+{
+  public:
+    static TypeId GetTypeId();
+
+    BiasedNakagamiLossModel();
+
+    /**
+     * Bias the draws of the links towards @p receiver and record their
+     * likelihood ratios.
+     *
+     * @param receiver Mobility model of the receiver, usually a gateway.
+     */
+    void AddBiasedReceiver(Ptr<MobilityModel> receiver);
+
+    /**
+     * @param receiver A biased receiver.
+     * @param span How far back to sum.
+     * @return The sum of the log likelihood ratios of the draws towards
+     *         @p receiver during the last @p span, 0 if none
+     */
+    double GetLogWeight(Ptr<MobilityModel> receiver, Time span) const;
+
+    /// @return The number of biased draws
+    uint64_t GetBiasedDrawCount() const;
+
+    /**
+     * @param m Shape of the Gamma draw.
+     * @param theta Its scale under the unbiased fading (W).
+     * @param bias Scale factor of the biased draw, 10^(-Bias / 10).
+     * @param gain The drawn power (W).
+     * @return ln(f(gain) / f_biased(gain)), the log likelihood ratio of the draw
+     */
+    static double GetLogLikelihoodRatio(double m, double theta, double bias, double gain);
+
+  private:
+    double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /// Draws towards one receiver: time (ns) and log likelihood ratio, oldest first
+    typedef std::deque<std::pair<int64_t, double>> DrawHistory;
+
+    double m_distance1;                          //!< End of the m0 region (m)
+    double m_distance2;                          //!< End of the m1 region (m)
+    double m_m0;                                 //!< Shape below Distance1
+    double m_m1;                                 //!< Shape up to Distance2
+    double m_m2;                                 //!< Shape beyond Distance2
+    double m_biasDb;                             //!< Mean power reduction of the biased draws (dB)
+    Time m_history;                              //!< How long draws are kept for GetLogWeight()
+    Ptr<GammaRandomVariable> m_gamma;            //!< Gamma draws
+    mutable std::map<const MobilityModel*, DrawHistory> m_draws; //!< Draws per biased receiver
+    mutable uint64_t m_biasedDraws;              //!< Biased draws so far
+};
+
+inline TypeId
+BiasedNakagamiLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::BiasedNakagamiLossModel")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<BiasedNakagamiLossModel>()
+            .AddAttribute("Distance1",
+                          "Beginning of the second distance field (m)",
+                          DoubleValue(80.0),
+                          MakeDoubleAccessor(&BiasedNakagamiLossModel::m_distance1),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("Distance2",
+                          "Beginning of the third distance field (m)",
+                          DoubleValue(200.0),
+                          MakeDoubleAccessor(&BiasedNakagamiLossModel::m_distance2),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("m0",
+                          "m0 for distances smaller than Distance1",
+                          DoubleValue(1.5),
+                          MakeDoubleAccessor(&BiasedNakagamiLossModel::m_m0),
+                          MakeDoubleChecker<double>(0.5))
+            .AddAttribute("m1",
+                          "m1 for distances smaller than Distance2",
+                          DoubleValue(0.75),
+                          MakeDoubleAccessor(&BiasedNakagamiLossModel::m_m1),
+                          MakeDoubleChecker<double>(0.5))
+            .AddAttribute("m2",
+                          "m2 for distances greater than Distance2",
+                          DoubleValue(0.75),
+                          MakeDoubleAccessor(&BiasedNakagamiLossModel::m_m2),
+                          MakeDoubleChecker<double>(0.5))
+            .AddAttribute("Bias",
+                          "Mean power reduction of the draws towards the biased receivers (dB)",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&BiasedNakagamiLossModel::m_biasDb),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("History",
+                          "How long the likelihood ratios of the draws are kept",
+                          TimeValue(Seconds(10)),
+                          MakeTimeAccessor(&BiasedNakagamiLossModel::m_history),
+                          MakeTimeChecker());
+    return tid;
+}
+
+inline BiasedNakagamiLossModel::BiasedNakagamiLossModel()
+    : m_distance1(80.0),
+      m_distance2(200.0),
+      m_m0(1.5),
+      m_m1(0.75),
+      m_m2(0.75),
+      m_biasDb(0.0),
+      m_history(Seconds(10)),
+      m_gamma(CreateObject<GammaRandomVariable>()),
+      m_biasedDraws(0)
+{
+}
+
+inline void
+BiasedNakagamiLossModel::AddBiasedReceiver(Ptr<MobilityModel> receiver)
+{
+    m_draws[PeekPointer(receiver)];
+}
+
+inline double
+BiasedNakagamiLossModel::GetLogWeight(Ptr<MobilityModel> receiver, Time span) const
+{
+    auto it = m_draws.find(PeekPointer(receiver));
+    if (it == m_draws.end())
+    {
+        return 0.0;
+    }
+    int64_t from = (Simulator::Now() - span).GetNanoSeconds();
+    double logWeight = 0.0;
+    for (auto draw = it->second.rbegin(); draw != it->second.rend() && draw->first >= from; ++draw)
+    {
+        logWeight += draw->second;
+    }
+    return logWeight;
+}
+
+inline uint64_t
+BiasedNakagamiLossModel::GetBiasedDrawCount() const
+{
+    return m_biasedDraws;
+}
+
+inline double
+BiasedNakagamiLossModel::GetLogLikelihoodRatio(double m, double theta, double bias, double gain)
+{
+    return m * std::log(bias) + (gain / theta) * (1.0 / bias - 1.0);
+}
+
+inline double
+BiasedNakagamiLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+    double distance = a->GetDistanceFrom(b);
+    double m = distance < m_distance1 ? m_m0 : (distance < m_distance2 ? m_m1 : m_m2);
+    double powerW = std::pow(10, (txPowerDbm - 30) / 10);
+    double theta = powerW / m;
+
+    // Uplinks only: downlinks and gateway-to-gateway links keep the plain fading
+    auto it = m_draws.find(PeekPointer(b));
+    if (m_biasDb <= 0.0 || it == m_draws.end() || m_draws.count(PeekPointer(a)))
+    {
+        return 10 * std::log10(m_gamma->GetValue(m, theta)) + 30;
+    }
+
+    double bias = std::pow(10, -m_biasDb / 10);
+    double gain = m_gamma->GetValue(m, theta * bias);
+    double logRatio = GetLogLikelihoodRatio(m, theta, bias, gain);
+
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    DrawHistory& history = it->second;
+    while (!history.empty() && history.front().first < now - m_history.GetNanoSeconds())
+    {
+        history.pop_front();
+    }
+    history.emplace_back(now, logRatio);
+    m_biasedDraws++;
+    return 10 * std::log10(gain) + 30;
+}
+
+inline int64_t
+BiasedNakagamiLossModel::DoAssignStreams(int64_t stream)
+{
+    m_gamma->SetStream(stream);
+    return 1;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_BIASED_NAKAGAMI_LOSS_MODEL_H */
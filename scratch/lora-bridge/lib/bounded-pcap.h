@@ -0,0 +1,225 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Size-bounded packet capture.
+//
+// A BoundedPcapCapture taps the promiscuous sniffer of one device, like
+// EnablePcap does, but writes at most SnapLen bytes of every frame and,
+// when MaxFileBytes is set, rotates through MaxFiles files used as a ring:
+// the capture of a long soak test never exceeds MaxFiles * MaxFileBytes and
+// always holds the most recent frames.
+
+#ifndef LORA_BRIDGE_BOUNDED_PCAP_H
+#define LORA_BRIDGE_BOUNDED_PCAP_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/object.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-helper.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Snaplen-limited, optionally rotating pcap capture of one device.
+ */
+class BoundedPcapCapture : public Object
+{
+  public:
+    static TypeId GetTypeId();
+
+    BoundedPcapCapture();
+
+    /**
+     * Start capturing the frames sniffed by @p device.
+     *
+     * @param device A device with a "PromiscSniffer" trace source.
+     * @param prefix Prefix of the capture file names.
+     * @return Whether the trace source was found.
+     */
+    bool Install(Ptr<NetDevice> device, const std::string& prefix);
+
+    /// @return The number of frames written
+    uint64_t GetFrameCount() const;
+
+    /// @return The number of bytes written to all files, headers included
+    uint64_t GetBytesWritten() const;
+
+    /// @return The number of files opened so far
+    uint32_t GetFileCount() const;
+
+  private:
+    void DoDispose() override;
+
+    /// Open the next file of the ring
+    void OpenNext();
+
+    /// Write one sniffed frame
+    void Sniff(Ptr<const Packet> packet);
+
+    uint32_t m_snapLen;          //!< Bytes kept per frame
+    uint64_t m_maxFileBytes;     //!< Rotation threshold, 0 for a single file
+    uint32_t m_maxFiles;         //!< Files in the ring
+    std::string m_baseName;      //!< File name without index and extension
+    Ptr<PcapFileWrapper> m_file; //!< File being written
+    uint64_t m_fileBytes;        //!< Bytes in the current file
+    uint64_t m_totalBytes;       //!< Bytes written overall
+    uint64_t m_frames;           //!< Frames written
+    uint32_t m_files;            //!< Files opened
+};
+
+inline TypeId
+BoundedPcapCapture::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::BoundedPcapCapture")
+            .SetParent<Object>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<BoundedPcapCapture>()
+            .AddAttribute("SnapLen",
+                          "Bytes kept per frame (Ethernet, IPv4, UDP and poll headers fit in 64)",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&BoundedPcapCapture::m_snapLen),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxFileBytes",
+                          "Size after which the next file of the ring is used; 0 disables rotation",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&BoundedPcapCapture::m_maxFileBytes),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("MaxFiles",
+                          "Number of files in the ring",
+                          UintegerValue(4),
+                          MakeUintegerAccessor(&BoundedPcapCapture::m_maxFiles),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+inline BoundedPcapCapture::BoundedPcapCapture()
+    : m_snapLen(64),
+      m_maxFileBytes(0),
+      m_maxFiles(4),
+      m_fileBytes(0),
+      m_totalBytes(0),
+      m_frames(0),
+      m_files(0)
+{
+}
+
+inline bool
+BoundedPcapCapture::Install(Ptr<NetDevice> device, const std::string& prefix)
+{
+    std::ostringstream oss;
+    oss << prefix << "-" << device->GetNode()->GetId() << "-" << device->GetIfIndex();
+    m_baseName = oss.str();
+    OpenNext();
+    return device->TraceConnectWithoutContext("PromiscSniffer",
+                                              MakeCallback(&BoundedPcapCapture::Sniff, this));
+}
+
+inline uint64_t
+BoundedPcapCapture::GetFrameCount() const
+{
+    return m_frames;
+}
+
+inline uint64_t
+BoundedPcapCapture::GetBytesWritten() const
+{
+    return m_totalBytes;
+}
+
+inline uint32_t
+BoundedPcapCapture::GetFileCount() const
+{
+    return m_files;
+}
+
+inline void
+BoundedPcapCapture::DoDispose()
+{
+    m_file = nullptr;
+    Object::DoDispose();
+}
+
+inline void
+BoundedPcapCapture::OpenNext()
+{
+    std::string name = m_baseName + ".pcap";
+    if (m_maxFileBytes > 0)
+    {
+        name = m_baseName + "-" + std::to_string(m_files % m_maxFiles) + ".pcap";
+    }
+    PcapHelper pcapHelper;
+    m_file = pcapHelper.CreateFile(name, std::ios::out, PcapHelper::DLT_EN10MB, m_snapLen);
+    m_fileBytes = 24; // Global pcap header
+    m_totalBytes += 24;
+    m_files++;
+}
+
+inline void
+BoundedPcapCapture::Sniff(Ptr<const Packet> packet)
+{
+    uint64_t bytes = 16 + std::min(packet->GetSize(), m_snapLen); // Record header and data
+    if (m_maxFileBytes > 0 && m_fileBytes + bytes > m_maxFileBytes && m_fileBytes > 24)
+    {
+        OpenNext();
+    }
+    m_file->Write(Simulator::Now(), packet);
+    m_fileBytes += bytes;
+    m_totalBytes += bytes;
+    m_frames++;
+}
+
+/**
+ * Capture the devices whose node id is in @p nodeIds (all devices if empty).
+ *
+ * @param devices Candidate devices.
+ * @param nodeIds Node ids to capture.
+ * @param prefix Prefix of the capture file names.
+ * @param snapLen Bytes kept per frame.
+ * @param maxFileBytes Rotation threshold, 0 for a single file per device.
+ * @param maxFiles Files in each ring.
+ * @return One capture per captured device.
+ */
+inline std::vector<Ptr<BoundedPcapCapture>>
+EnableBoundedPcap(const NetDeviceContainer& devices,
+                  const std::set<uint32_t>& nodeIds,
+                  const std::string& prefix,
+                  uint32_t snapLen,
+                  uint64_t maxFileBytes,
+                  uint32_t maxFiles)
+{
+    std::vector<Ptr<BoundedPcapCapture>> captures;
+    for (uint32_t i = 0; i < devices.GetN(); ++i)
+    {
+        Ptr<NetDevice> device = devices.Get(i);
+        if (!nodeIds.empty() && nodeIds.count(device->GetNode()->GetId()) == 0)
+        {
+            continue;
+        }
+        Ptr<BoundedPcapCapture> capture = CreateObject<BoundedPcapCapture>();
+        capture->SetAttribute("SnapLen", UintegerValue(snapLen));
+        capture->SetAttribute("MaxFileBytes", UintegerValue(maxFileBytes));
+        capture->SetAttribute("MaxFiles", UintegerValue(maxFiles));
+        if (capture->Install(device, prefix))
+        {
+            captures.push_back(capture);
+        }
+    }
+    return captures;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_BOUNDED_PCAP_H */
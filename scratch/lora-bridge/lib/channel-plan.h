@@ -0,0 +1,225 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// EU868 uplink channel plan with more than the three default channels.
+//
+// The MAC helper only sets up the mandatory 868.1, 868.3 and 868.5 MHz
+// channels. The plan adds up to five more at 867.1 to 867.9 MHz, the usual
+// eight-channel plan of an EU868 gateway, together with the 865-868 MHz
+// sub-band (1% duty cycle) they fall in. It is installed on the gateways too,
+// whose RX1 replies go out on the uplink frequency.
+//
+// Devices may be restricted to a subset of the channels, as a network server
+// would do with the ChMask of a LinkADRReq. The subsets are chosen greedily
+// so that every channel carries the same share of the expected airtime.
+
+#ifndef LORA_BRIDGE_CHANNEL_PLAN_H
+#define LORA_BRIDGE_CHANNEL_PLAN_H
+
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/gateway-lorawan-mac.h"
+#include "ns3/logical-lora-channel-helper.h"
+#include "ns3/logical-lora-channel.h"
+#include "ns3/sub-band.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * EU868 channel plan of up to eight uplink channels, balanced over the devices.
+ */
+class ChannelPlan
+{
+  public:
+    /// Largest number of uplink channels
+    static constexpr uint32_t MAX_CHANNELS = 8;
+
+    ChannelPlan();
+
+    /// @return The frequency of uplink channel @p index (Hz)
+    static uint32_t GetFrequency(uint32_t index);
+
+    /**
+     * @param nChannels Uplink channels, 3 (the default plan) to MAX_CHANNELS.
+     */
+    void SetChannelCount(uint32_t nChannels);
+
+    /// @return The number of uplink channels
+    uint32_t GetChannelCount() const;
+
+    /**
+     * @param nChannels Channels each device may use, 0 for all of them.
+     */
+    void SetChannelsPerDevice(uint32_t nChannels);
+
+    /// @return Whether the plan is the default one of the MAC helper: three channels, all of them per device
+    bool IsDefault() const;
+
+    /**
+     * Choose the channels of the next device: those with the least airtime so far.
+     *
+     * @param airtimeLoad Expected airtime of the device per second (Erlang).
+     * @return The channel mask of the device, bit i for channel i.
+     */
+    uint32_t AddDevice(double airtimeLoad);
+
+    /// @return The expected airtime per second assigned to channel @p index (Erlang)
+    double GetLoad(uint32_t index) const;
+
+    /**
+     * Add the extra channels and their sub-band to an end device and
+     * disable the channels outside its mask.
+     *
+     * @param mac The MAC of the end device.
+     * @param mask Its channel mask, as returned by AddDevice().
+     */
+    void ConfigureEndDevice(Ptr<lorawan::EndDeviceLorawanMac> mac, uint32_t mask) const;
+
+    /**
+     * Enable the channels of a new mask on an end device already configured
+     * by ConfigureEndDevice() and disable the others.
+     *
+     * @param mac The MAC of the end device.
+     * @param mask Its channel mask, as returned by AddDevice().
+     */
+    void SetMask(Ptr<lorawan::EndDeviceLorawanMac> mac, uint32_t mask) const;
+
+    /**
+     * Add the extra channels and their sub-band to a gateway.
+     *
+     * @param mac The MAC of the gateway.
+     */
+    void ConfigureGateway(Ptr<lorawan::GatewayLorawanMac> mac) const;
+
+  private:
+    /// Add the channels beyond the default three and their sub-band to @p helper
+    void AddChannels(Ptr<lorawan::LogicalLoraChannelHelper> helper) const;
+
+    uint32_t m_channels;         //!< Uplink channels
+    uint32_t m_perDevice;        //!< Channels per device, 0 for all
+    std::vector<double> m_load;  //!< Expected airtime per channel (Erlang)
+};
+
+inline ChannelPlan::ChannelPlan()
+    : m_channels(3),
+      m_perDevice(0),
+      m_load(MAX_CHANNELS, 0.0)
+{
+}
+
+inline uint32_t
+ChannelPlan::GetFrequency(uint32_t index)
+{
+    static const uint32_t frequencies[MAX_CHANNELS] =
+        {868100000, 868300000, 868500000, 867100000, 867300000, 867500000, 867700000, 867900000};
+    return frequencies[std::min(index, MAX_CHANNELS - 1)];
+}
+
+inline void
+ChannelPlan::SetChannelCount(uint32_t nChannels)
+{
+    m_channels = std::min(std::max<uint32_t>(nChannels, 3), MAX_CHANNELS);
+}
+
+inline uint32_t
+ChannelPlan::GetChannelCount() const
+{
+    return m_channels;
+}
+
+inline void
+ChannelPlan::SetChannelsPerDevice(uint32_t nChannels)
+{
+    m_perDevice = nChannels;
+}
+
+inline bool
+ChannelPlan::IsDefault() const
+{
+    return m_channels == 3 && (m_perDevice == 0 || m_perDevice >= 3);
+}
+
+inline uint32_t
+ChannelPlan::AddDevice(double airtimeLoad)
+{
+    uint32_t perDevice = (m_perDevice == 0 || m_perDevice > m_channels) ? m_channels : m_perDevice;
+    std::vector<uint32_t> order(m_channels);
+    for (uint32_t i = 0; i < m_channels; ++i)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return m_load[a] < m_load[b];
+    });
+    // A device picks uniformly among its enabled channels
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < perDevice; ++i)
+    {
+        mask |= 1u << order[i];
+        m_load[order[i]] += airtimeLoad / perDevice;
+    }
+    return mask;
+}
+
+inline double
+ChannelPlan::GetLoad(uint32_t index) const
+{
+    return index < m_channels ? m_load[index] : 0.0;
+}
+
+inline void
+ChannelPlan::ConfigureEndDevice(Ptr<lorawan::EndDeviceLorawanMac> mac, uint32_t mask) const
+{
+    AddChannels(mac->GetLogicalLoraChannelHelper());
+    SetMask(mac, mask);
+}
+
+inline void
+ChannelPlan::SetMask(Ptr<lorawan::EndDeviceLorawanMac> mac, uint32_t mask) const
+{
+    std::vector<Ptr<lorawan::LogicalLoraChannel>> channels = mac->GetLogicalLoraChannelHelper()->GetRawChannelArray();
+    for (uint32_t i = 0; i < m_channels && i < channels.size(); ++i)
+    {
+        if (!channels[i])
+        {
+            continue;
+        }
+        if (mask & (1u << i))
+        {
+            channels[i]->EnableForUplink();
+        }
+        else
+        {
+            channels[i]->DisableForUplink();
+        }
+    }
+}
+
+inline void
+ChannelPlan::ConfigureGateway(Ptr<lorawan::GatewayLorawanMac> mac) const
+{
+    AddChannels(mac->GetLogicalLoraChannelHelper());
+}
+
+inline void
+ChannelPlan::AddChannels(Ptr<lorawan::LogicalLoraChannelHelper> helper) const
+{
+    if (m_channels <= 3)
+    {
+        return;
+    }
+    helper->AddSubBand(Create<lorawan::SubBand>(865000000, 868000000, 0.01, 14));
+    for (uint32_t i = 3; i < m_channels; ++i)
+    {
+        helper->SetChannel(i, Create<lorawan::LogicalLoraChannel>(GetFrequency(i), 0, 5));
+    }
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_CHANNEL_PLAN_H */
@@ -0,0 +1,156 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Usage of the radio channels.
+//
+// Fed with the frequency of the LoraTag of every uplink sent by the end
+// devices, every gateway reception and loss, and every gateway transmission.
+// Uplink airtime is counted once per transmission; receptions and losses once
+// per gateway that saw the uplink, so with several gateways they add up to
+// more than the uplinks sent.
+
+#ifndef LORA_BRIDGE_CHANNEL_STATS_H
+#define LORA_BRIDGE_CHANNEL_STATS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+
+namespace ns3
+{
+
+/**
+ * Airtime and outcome counters per channel frequency.
+ */
+class ChannelStats
+{
+  public:
+    /// Why a gateway lost an uplink
+    enum Loss
+    {
+        LOST_INTERFERENCE = 0, //!< Interference from another uplink
+        LOST_SENSITIVITY,      //!< Below the gateway sensitivity
+        LOST_NO_RECEIVER,      //!< All reception paths busy
+        LOSS_KINDS             //!< Number of loss kinds
+    };
+
+    /// Counters of one channel
+    struct Entry
+    {
+        uint64_t uplinks = 0;                   //!< Uplink transmissions
+        double uplinkAirtime = 0;               //!< Airtime of the uplinks (s)
+        uint64_t received = 0;                  //!< Gateway receptions
+        uint64_t lost[LOSS_KINDS] = {0, 0, 0};  //!< Gateway losses per kind
+        uint64_t downlinks = 0;                 //!< Gateway transmissions
+        double downlinkAirtime = 0;             //!< Airtime of the gateway transmissions (s)
+
+        /**
+         * @param duration Observation time (s).
+         * @return The fraction of @p duration the channel carried uplinks.
+         */
+        double GetUplinkOccupancy(double duration) const;
+
+        /// @return The fraction of the gateway receptions lost to interference
+        double GetCollisionRate() const;
+    };
+
+    /**
+     * @param frequencyHz Channel of the uplink.
+     * @param airtime Time on air (s).
+     */
+    void AddUplink(uint32_t frequencyHz, double airtime);
+
+    /// @param frequencyHz Channel of an uplink a gateway received.
+    void AddReception(uint32_t frequencyHz);
+
+    /**
+     * @param frequencyHz Channel of an uplink a gateway lost.
+     * @param loss Why it was lost.
+     */
+    void AddLoss(uint32_t frequencyHz, Loss loss);
+
+    /**
+     * @param frequencyHz Channel of the gateway transmission.
+     * @param airtime Time on air (s).
+     */
+    void AddDownlink(uint32_t frequencyHz, double airtime);
+
+    /// @return The counters per frequency (Hz), in increasing frequency
+    const std::map<uint32_t, Entry>& GetChannels() const;
+
+    /// @return The uplink airtime of the busiest channel over the mean of the channels with uplinks, 0 if none
+    double GetUplinkImbalance() const;
+
+  private:
+    std::map<uint32_t, Entry> m_channels; //!< Counters per frequency
+};
+
+inline double
+ChannelStats::Entry::GetUplinkOccupancy(double duration) const
+{
+    return duration > 0 ? uplinkAirtime / duration : 0.0;
+}
+
+inline double
+ChannelStats::Entry::GetCollisionRate() const
+{
+    uint64_t total = received + lost[LOST_INTERFERENCE] + lost[LOST_SENSITIVITY] + lost[LOST_NO_RECEIVER];
+    return total > 0 ? static_cast<double>(lost[LOST_INTERFERENCE]) / total : 0.0;
+}
+
+inline void
+ChannelStats::AddUplink(uint32_t frequencyHz, double airtime)
+{
+    Entry& entry = m_channels[frequencyHz];
+    entry.uplinks++;
+    entry.uplinkAirtime += airtime;
+}
+
+inline void
+ChannelStats::AddReception(uint32_t frequencyHz)
+{
+    m_channels[frequencyHz].received++;
+}
+
+inline void
+ChannelStats::AddLoss(uint32_t frequencyHz, Loss loss)
+{
+    m_channels[frequencyHz].lost[loss]++;
+}
+
+inline void
+ChannelStats::AddDownlink(uint32_t frequencyHz, double airtime)
+{
+    Entry& entry = m_channels[frequencyHz];
+    entry.downlinks++;
+    entry.downlinkAirtime += airtime;
+}
+
+inline const std::map<uint32_t, ChannelStats::Entry>&
+ChannelStats::GetChannels() const
+{
+    return m_channels;
+}
+
+inline double
+ChannelStats::GetUplinkImbalance() const
+{
+    double total = 0.0;
+    double busiest = 0.0;
+    uint32_t channels = 0;
+    for (const auto& channel : m_channels)
+    {
+        if (channel.second.uplinks > 0)
+        {
+            total += channel.second.uplinkAirtime;
+            busiest = std::max(busiest, channel.second.uplinkAirtime);
+            channels++;
+        }
+    }
+    return total > 0 ? busiest * channels / total : 0.0;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_CHANNEL_STATS_H */
@@ -0,0 +1,177 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Event scheduler that publishes its activity to other threads.
+//
+// The simulator offers no thread-safe way to read the current time or the
+// size of the event queue while Run() is executing. CountingScheduler wraps
+// the real scheduler (InnerType, a MapScheduler by default) and, on every
+// insert and removal, updates a few process-wide counters: events inserted,
+// events dequeued, events removed before expiry and the timestamp of the
+// last event dequeued. Only the simulator thread writes them, so each update
+// is a plain relaxed load and store, with no locked instruction. A monitor
+// thread reads them with relaxed loads; the figures may lag by an event,
+// which is harmless for progress reporting.
+//
+// Install it before Simulator::Run():
+//
+//   ObjectFactory factory;
+//   factory.SetTypeId(CountingScheduler::GetTypeId());
+//   Simulator::SetScheduler(factory);
+
+#ifndef LORA_BRIDGE_COUNTING_SCHEDULER_H
+#define LORA_BRIDGE_COUNTING_SCHEDULER_H
+
+#include "ns3/object-factory.h"
+#include "ns3/scheduler.h"
+#include "ns3/string.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Scheduler decorator that counts the events of the simulation.
+ */
+class CountingScheduler : public Scheduler
+{
+  public:
+    /// Counters shared with the monitoring threads
+    struct Counters
+    {
+        std::atomic<uint64_t> inserted{0}; //!< Events inserted
+        std::atomic<uint64_t> dequeued{0}; //!< Events taken for execution, cancelled ones included
+        std::atomic<uint64_t> removed{0};  //!< Events removed before expiry
+        std::atomic<uint64_t> lastTs{0};   //!< Timestamp of the last event dequeued (time steps)
+    };
+
+    static TypeId GetTypeId();
+
+    CountingScheduler();
+
+    /// @return The counters of the scheduler of this process
+    static const Counters& GetCounters();
+
+    /**
+     * @param typeName TypeId name of the scheduler to wrap.
+     */
+    void SetInnerType(std::string typeName);
+
+    /// @return The TypeId name of the wrapped scheduler
+    std::string GetInnerType() const;
+
+    void Insert(const Event& ev) override;
+    bool IsEmpty() const override;
+    Event PeekNext() const override;
+    Event RemoveNext() override;
+    void Remove(const Event& ev) override;
+
+  private:
+    /// @return The counters, writable
+    static Counters& GetMutableCounters();
+
+    /// Single-writer increment: no read-modify-write instruction needed
+    static void Increment(std::atomic<uint64_t>& counter);
+
+    Ptr<Scheduler> m_inner;   //!< Wrapped scheduler
+    std::string m_innerType;  //!< Its TypeId name
+};
+
+inline TypeId
+CountingScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CountingScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<CountingScheduler>()
+            .AddAttribute("InnerType",
+                          "TypeId name of the scheduler that holds the events",
+                          StringValue("ns3::MapScheduler"),
+                          MakeStringAccessor(&CountingScheduler::SetInnerType,
+                                             &CountingScheduler::GetInnerType),
+                          MakeStringChecker());
+    return tid;
+}
+
+inline CountingScheduler::CountingScheduler()
+{
+}
+
+inline const CountingScheduler::Counters&
+CountingScheduler::GetCounters()
+{
+    return GetMutableCounters();
+}
+
+inline CountingScheduler::Counters&
+CountingScheduler::GetMutableCounters()
+{
+    static Counters counters;
+    return counters;
+}
+
+inline void
+CountingScheduler::Increment(std::atomic<uint64_t>& counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline void
+CountingScheduler::SetInnerType(std::string typeName)
+{
+    // Only set while the queue is still empty: the simulator moves its events in afterwards
+    ObjectFactory factory(typeName);
+    m_inner = factory.Create<Scheduler>();
+    m_innerType = typeName;
+}
+
+inline std::string
+CountingScheduler::GetInnerType() const
+{
+    return m_innerType;
+}
+
+inline void
+CountingScheduler::Insert(const Event& ev)
+{
+    m_inner->Insert(ev);
+    Increment(GetMutableCounters().inserted);
+}
+
+inline bool
+CountingScheduler::IsEmpty() const
+{
+    return m_inner->IsEmpty();
+}
+
+inline Scheduler::Event
+CountingScheduler::PeekNext() const
+{
+    return m_inner->PeekNext();
+}
+
+inline Scheduler::Event
+CountingScheduler::RemoveNext()
+{
+    Event ev = m_inner->RemoveNext();
+    Counters& counters = GetMutableCounters();
+    Increment(counters.dequeued);
+    counters.lastTs.store(ev.key.m_ts, std::memory_order_relaxed);
+    return ev;
+}
+
+inline void
+CountingScheduler::Remove(const Event& ev)
+{
+    m_inner->Remove(ev);
+    Increment(GetMutableCounters().removed);
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_COUNTING_SCHEDULER_H */
@@ -0,0 +1,250 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Bounded-memory duplicate filter for the gateway reception sinks.
+//
+// The scenarios tag every uplink with an id from a global counter, so the ids
+// arrive almost in order: copies of one uplink reach the gateways within
+// milliseconds and retransmissions follow within minutes. A sliding bitmap
+// over the most recent ids answers "seen before?" in O(1) with constant
+// memory (window / 8 bytes), where a set of every id ever received grows
+// with the run. An id that has fallen out of the window is treated as a
+// duplicate and counted as stale; with the default window of 2^20 ids that
+// needs an uplink to arrive hours after a million newer ones were sent.
+//
+// PacketSenderRing keeps the sender of the same recent ids, for the
+// per-device counts, in one slot per id of the window (8 bytes each): an id
+// overwrites the slot of the id one window older, so a lookup of an id that
+// old finds nothing.
+
+#ifndef LORA_BRIDGE_DEDUP_WINDOW_H
+#define LORA_BRIDGE_DEDUP_WINDOW_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Sliding bitmap of the ids seen among the most recent ones.
+ */
+class DedupWindow
+{
+  public:
+    /**
+     * @param window Number of ids covered, rounded up to a power of two (at least 64).
+     */
+    explicit DedupWindow(uint32_t window = 1u << 20);
+
+    /**
+     * Mark @p id as seen.
+     *
+     * @param id A non-zero packet id.
+     * @return True if @p id was not seen before, false for duplicates and stale ids.
+     */
+    bool Insert(uint32_t id);
+
+    /**
+     * @param id A packet id.
+     * @return Whether @p id was seen, or is too old to tell.
+     */
+    bool Contains(uint32_t id) const;
+
+    /// @return The number of distinct ids inserted
+    uint64_t GetUniqueCount() const;
+
+    /// @return The number of ids that arrived after leaving the window
+    uint64_t GetStaleCount() const;
+
+    /// @return The number of ids covered
+    uint32_t GetWindow() const;
+
+    /// @return The memory used by the bitmap (bytes)
+    uint64_t GetBytes() const;
+
+    /**
+     * @param window A requested window.
+     * @return The window actually covered: a power of two, at least 64
+     */
+    static uint32_t RoundWindow(uint32_t window);
+
+  private:
+    /// Clear the bits of the ids in (m_highest, id] and make @p id the highest
+    void Advance(uint32_t id);
+
+    std::vector<uint64_t> m_bits; //!< Bit (id & m_mask) is set if id was seen
+    uint32_t m_mask;              //!< Window - 1
+    uint32_t m_highest;           //!< Highest id seen, 0 if none
+    uint64_t m_unique;            //!< Distinct ids inserted
+    uint64_t m_stale;             //!< Ids older than the window
+};
+
+/**
+ * Sender of each of the most recent packet ids.
+ */
+class PacketSenderRing
+{
+  public:
+    /**
+     * @param window Number of ids covered, rounded as by DedupWindow.
+     */
+    explicit PacketSenderRing(uint32_t window = 1u << 20);
+
+    /**
+     * @param id A non-zero packet id.
+     * @param sender Index of the device that sent it.
+     */
+    void Set(uint32_t id, uint32_t sender);
+
+    /**
+     * @param id A packet id.
+     * @param sender Set to the sender of @p id if known.
+     * @return Whether the sender of @p id is still in the ring.
+     */
+    bool Get(uint32_t id, uint32_t& sender) const;
+
+    /// @return The memory used by the ring (bytes)
+    uint64_t GetBytes() const;
+
+  private:
+    std::vector<std::pair<uint32_t, uint32_t>> m_slots; //!< Id and sender, in slot id & m_mask
+    uint32_t m_mask;                                    //!< Window - 1
+};
+
+inline DedupWindow::DedupWindow(uint32_t window)
+    : m_highest(0),
+      m_unique(0),
+      m_stale(0)
+{
+    uint32_t size = RoundWindow(window);
+    m_bits.assign(size / 64, 0);
+    m_mask = size - 1;
+}
+
+inline bool
+DedupWindow::Insert(uint32_t id)
+{
+    if (id > m_highest)
+    {
+        Advance(id);
+    }
+    else if (m_highest - id > m_mask)
+    {
+        m_stale++;
+        return false;
+    }
+    uint64_t& word = m_bits[(id & m_mask) >> 6];
+    uint64_t bit = uint64_t(1) << (id & 63);
+    if (word & bit)
+    {
+        return false;
+    }
+    word |= bit;
+    m_unique++;
+    return true;
+}
+
+inline bool
+DedupWindow::Contains(uint32_t id) const
+{
+    if (id > m_highest)
+    {
+        return false;
+    }
+    if (m_highest - id > m_mask)
+    {
+        return true;
+    }
+    return m_bits[(id & m_mask) >> 6] & (uint64_t(1) << (id & 63));
+}
+
+inline uint64_t
+DedupWindow::GetUniqueCount() const
+{
+    return m_unique;
+}
+
+inline uint64_t
+DedupWindow::GetStaleCount() const
+{
+    return m_stale;
+}
+
+inline uint32_t
+DedupWindow::GetWindow() const
+{
+    return m_mask + 1;
+}
+
+inline uint64_t
+DedupWindow::GetBytes() const
+{
+    return m_bits.size() * sizeof(uint64_t);
+}
+
+inline uint32_t
+DedupWindow::RoundWindow(uint32_t window)
+{
+    uint32_t size = 64;
+    while (size < window && size < (1u << 31))
+    {
+        size <<= 1;
+    }
+    return size;
+}
+
+inline void
+DedupWindow::Advance(uint32_t id)
+{
+    if (id - m_highest > m_mask)
+    {
+        std::fill(m_bits.begin(), m_bits.end(), 0);
+    }
+    else
+    {
+        // The slots of the new ids still hold ids one window older
+        for (uint32_t k = m_highest + 1; k != id + 1; ++k)
+        {
+            m_bits[(k & m_mask) >> 6] &= ~(uint64_t(1) << (k & 63));
+        }
+    }
+    m_highest = id;
+}
+
+inline PacketSenderRing::PacketSenderRing(uint32_t window)
+    : m_slots(DedupWindow::RoundWindow(window), std::make_pair(0u, 0u)),
+      m_mask(DedupWindow::RoundWindow(window) - 1)
+{
+}
+
+inline void
+PacketSenderRing::Set(uint32_t id, uint32_t sender)
+{
+    m_slots[id & m_mask] = std::make_pair(id, sender);
+}
+
+inline bool
+PacketSenderRing::Get(uint32_t id, uint32_t& sender) const
+{
+    const auto& slot = m_slots[id & m_mask];
+    if (id == 0 || slot.first != id)
+    {
+        return false;
+    }
+    sender = slot.second;
+    return true;
+}
+
+inline uint64_t
+PacketSenderRing::GetBytes() const
+{
+    return m_slots.size() * sizeof(m_slots[0]);
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_DEDUP_WINDOW_H */
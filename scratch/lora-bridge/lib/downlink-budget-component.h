@@ -0,0 +1,425 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Duty-cycle-aware downlink scheduling at the network server.
+//
+// The component keeps a sliding one-hour ledger of the gateway airtime spent
+// in each EU868 sub-band. When the network server is about to answer a device
+// in RX1, it prices the reply in both receive windows as a fraction of the
+// remaining sub-band budget and picks the cheaper window that still fits:
+// RX2 replies are deferred and sent by the component itself one window delay
+// later. Replies that fit in neither window are dropped instead of pushing the
+// gateway over its duty cycle.
+//
+// The window being served is known from the network scheduler's timing: it
+// opens RX1 one window delay after the first copy of an uplink reaches the
+// server, and RX2 one delay after that. Once a sub-band is down to its
+// reserve, confirmations for devices that will retry anyway (fewer
+// receptions of the frame than the device's transmission limit) are dropped,
+// which keeps the rest of the budget for devices on their last transmission.
+
+#ifndef LORA_BRIDGE_DOWNLINK_BUDGET_COMPONENT_H
+#define LORA_BRIDGE_DOWNLINK_BUDGET_COMPONENT_H
+
+#include "ns3/double.h"
+#include "ns3/end-device-status.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-phy.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/network-controller-components.h"
+#include "ns3/network-status.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Network controller component enforcing the gateway downlink duty cycle
+ * per sub-band and choosing RX1 or RX2 for every reply.
+ */
+class DownlinkBudgetComponent : public lorawan::NetworkControllerComponent
+{
+  public:
+    static TypeId GetTypeId();
+
+    DownlinkBudgetComponent();
+
+    void OnReceivedPacket(Ptr<const Packet> packet,
+                          Ptr<lorawan::EndDeviceStatus> status,
+                          Ptr<lorawan::NetworkStatus> networkStatus) override;
+
+    void BeforeSendingReply(Ptr<lorawan::EndDeviceStatus> status,
+                            Ptr<lorawan::NetworkStatus> networkStatus) override;
+
+    void OnFailedReply(Ptr<lorawan::EndDeviceStatus> status,
+                       Ptr<lorawan::NetworkStatus> networkStatus) override;
+
+    /// @return Replies sent in RX1
+    uint64_t GetRx1Count() const;
+
+    /// @return Replies sent in RX2, including those moved there by the component
+    uint64_t GetRx2Count() const;
+
+    /// @return Replies moved from RX1 to RX2 because RX2 was cheaper
+    uint64_t GetDeferredCount() const;
+
+    /// @return Replies dropped because no window had budget left
+    uint64_t GetDroppedCount() const;
+
+    /// @return Confirmations dropped to keep the reserve, for devices that retry without one
+    uint64_t GetDeprioritisedCount() const;
+
+    /**
+     * @param frequencyHz A downlink frequency.
+     * @return The airtime still available in its sub-band over the window (s).
+     */
+    double GetRemainingBudget(double frequencyHz);
+
+  private:
+    /// An EU868 sub-band and the downlinks sent in it during the last window
+    struct SubBand
+    {
+        double firstHz;          //!< Lowest frequency of the band
+        double lastHz;           //!< Highest frequency of the band
+        double dutyCycle;        //!< Allowed fraction of the window
+        std::deque<std::pair<Time, double>> sent; //!< Start time and airtime of each downlink
+        double used;             //!< Sum of the airtimes in @c sent
+    };
+
+    /// The last uplink heard from a device
+    struct DeviceState
+    {
+        uint16_t fCnt = 0;       //!< Frame counter of the uplink
+        uint8_t receptions = 0;  //!< Receptions of that frame, retransmissions included
+        Time firstCopy;          //!< Arrival of the first copy of the last reception
+        Time rx1;                //!< When the network scheduler serves RX1 for it
+    };
+
+    /// @return The sub-band containing @p frequencyHz, or nullptr
+    SubBand* FindSubBand(double frequencyHz);
+
+    /// Forget the downlinks that left the sliding window
+    void Expire(SubBand& band);
+
+    /// @return The airtime the sub-band of @p frequencyHz allows over the window (s)
+    double GetAllowance(double frequencyHz);
+
+    /// @return The airtime of @p packet at @p sf (s)
+    static double AirTime(Ptr<const Packet> packet, uint8_t sf);
+
+    /// Charge a downlink to the sub-band of @p frequencyHz
+    void Charge(double frequencyHz, double airtime);
+
+    /// Restore a deferred reply and send it in RX2
+    void SendInRx2(Ptr<lorawan::EndDeviceStatus> status,
+                   Ptr<lorawan::NetworkStatus> networkStatus,
+                   lorawan::LorawanMacHeader macHeader,
+                   lorawan::LoraFrameHeader frameHeader,
+                   Ptr<Packet> payload,
+                   double airtime);
+
+    Time m_window;                 //!< Length of the duty-cycle window
+    Time m_windowDelay;            //!< Delay of the network scheduler before RX1, and from RX1 to RX2
+    double m_reserve;              //!< Fraction of each sub-band kept from devices that will retry
+    std::vector<SubBand> m_bands;  //!< EU868 sub-bands
+    std::unordered_map<uint32_t, DeviceState> m_devices; //!< Device address to its last uplink
+    uint64_t m_rx1;                //!< Replies sent in RX1
+    uint64_t m_rx2;                //!< Replies sent in RX2
+    uint64_t m_deferred;           //!< Replies moved to RX2
+    uint64_t m_dropped;            //!< Replies dropped for lack of budget
+    uint64_t m_deprioritised;      //!< Confirmations dropped to keep the reserve
+};
+
+inline TypeId
+DownlinkBudgetComponent::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::DownlinkBudgetComponent")
+                            .SetParent<lorawan::NetworkControllerComponent>()
+                            .SetGroupName("LoraBridge")
+                            .AddConstructor<DownlinkBudgetComponent>()
+                            .AddAttribute("Window",
+                                          "Length of the duty-cycle observation window",
+                                          TimeValue(Hours(1)),
+                                          MakeTimeAccessor(&DownlinkBudgetComponent::m_window),
+                                          MakeTimeChecker())
+                            .AddAttribute("WindowDelay",
+                                          "Delay of the network scheduler between the arrival of an "
+                                          "uplink and RX1, and between RX1 and RX2",
+                                          TimeValue(Seconds(1)),
+                                          MakeTimeAccessor(&DownlinkBudgetComponent::m_windowDelay),
+                                          MakeTimeChecker())
+                            .AddAttribute("Reserve",
+                                          "Fraction of each sub-band budget that confirmations for "
+                                          "devices with transmissions left may not use",
+                                          DoubleValue(0.2),
+                                          MakeDoubleAccessor(&DownlinkBudgetComponent::m_reserve),
+                                          MakeDoubleChecker<double>(0.0, 1.0));
+    return tid;
+}
+
+inline DownlinkBudgetComponent::DownlinkBudgetComponent()
+    : m_window(Hours(1)),
+      m_windowDelay(Seconds(1)),
+      m_reserve(0.2),
+      m_rx1(0),
+      m_rx2(0),
+      m_deferred(0),
+      m_dropped(0),
+      m_deprioritised(0)
+{
+    // ETSI EN 300 220 sub-bands used by the EU868 channel plan
+    m_bands.push_back({863000000.0, 865000000.0, 0.001, {}, 0.0});
+    m_bands.push_back({865000000.0, 868000000.0, 0.01, {}, 0.0});
+    m_bands.push_back({868000000.0, 868600000.0, 0.01, {}, 0.0});
+    m_bands.push_back({868700000.0, 869200000.0, 0.001, {}, 0.0});
+    m_bands.push_back({869400000.0, 869650000.0, 0.1, {}, 0.0});
+    m_bands.push_back({869700000.0, 870000000.0, 0.01, {}, 0.0});
+}
+
+inline void
+DownlinkBudgetComponent::OnReceivedPacket(Ptr<const Packet> packet,
+                                          Ptr<lorawan::EndDeviceStatus> status,
+                                          Ptr<lorawan::NetworkStatus> networkStatus)
+{
+    Ptr<Packet> copy = packet->Copy();
+    lorawan::LorawanMacHeader macHdr;
+    if (copy->RemoveHeader(macHdr) == 0 || !macHdr.IsUplink())
+    {
+        return;
+    }
+    lorawan::LoraFrameHeader frameHdr;
+    frameHdr.SetAsUplink();
+    copy->PeekHeader(frameHdr);
+
+    // Called once per gateway copy; copies of one transmission arrive within the backhaul delay
+    DeviceState& device = m_devices[frameHdr.GetAddress().Get()];
+    Time now = Simulator::Now();
+    bool sameFrame = device.receptions > 0 && device.fCnt == frameHdr.GetFCnt();
+    if (sameFrame && now - device.firstCopy < m_windowDelay)
+    {
+        return;
+    }
+    device.receptions = sameFrame ? std::min(device.receptions + 1, 255) : 1;
+    device.fCnt = frameHdr.GetFCnt();
+    device.firstCopy = now;
+    device.rx1 = now + m_windowDelay;
+}
+
+inline void
+DownlinkBudgetComponent::OnFailedReply(Ptr<lorawan::EndDeviceStatus> status,
+                                       Ptr<lorawan::NetworkStatus> networkStatus)
+{
+}
+
+inline void
+DownlinkBudgetComponent::BeforeSendingReply(Ptr<lorawan::EndDeviceStatus> status,
+                                            Ptr<lorawan::NetworkStatus> networkStatus)
+{
+    if (!status->NeedsReply())
+    {
+        return;
+    }
+
+    // The network scheduler only moves to RX2 when no gateway could serve RX1
+    auto device = m_devices.find(status->GetMac()->GetDeviceAddress().Get());
+    bool firstWindow = device != m_devices.end() && Simulator::Now() == device->second.rx1;
+
+    // Without an acknowledgement the device sends the frame again, unless this was its last try
+    bool willRetry = status->GetReplyFrameHeader().GetAck() && device != m_devices.end() &&
+                     device->second.receptions < status->GetMac()->GetMaxNumberOfTransmissions();
+
+    Ptr<Packet> reply = status->GetCompleteReplyPacket();
+    double rx1Frequency = status->GetFirstReceiveWindowFrequency();
+    double rx2Frequency = status->GetSecondReceiveWindowFrequency();
+    double rx1Airtime = AirTime(reply, status->GetFirstReceiveWindowSpreadingFactor());
+    double rx2Airtime = AirTime(reply, status->GetSecondReceiveWindowSpreadingFactor());
+    double rx1Budget = GetRemainingBudget(rx1Frequency);
+    double rx2Budget = GetRemainingBudget(rx2Frequency);
+    if (willRetry)
+    {
+        rx1Budget -= m_reserve * GetAllowance(rx1Frequency);
+        rx2Budget -= m_reserve * GetAllowance(rx2Frequency);
+    }
+    bool rx1Fits = firstWindow && rx1Airtime <= rx1Budget;
+    bool rx2Fits = rx2Airtime <= rx2Budget;
+
+    if (!rx1Fits && !rx2Fits)
+    {
+        bool beyondReserve = (firstWindow && rx1Airtime <= GetRemainingBudget(rx1Frequency)) ||
+                             rx2Airtime <= GetRemainingBudget(rx2Frequency);
+        if (willRetry && beyondReserve)
+        {
+            m_deprioritised++;
+        }
+        else
+        {
+            m_dropped++;
+        }
+        status->InitializeReply();
+        return;
+    }
+
+    // Spend the budget where this reply costs the smallest share of what is left
+    bool useRx1 = rx1Fits && (!rx2Fits || rx1Airtime / rx1Budget <= rx2Airtime / rx2Budget);
+    if (useRx1)
+    {
+        m_rx1++;
+        Charge(rx1Frequency, rx1Airtime);
+    }
+    else if (firstWindow)
+    {
+        // Keep the reply aside and clear it, so that the scheduler sends nothing now
+        m_deferred++;
+        lorawan::LorawanMacHeader macHeader = status->GetReplyMacHeader();
+        lorawan::LoraFrameHeader frameHeader = status->GetReplyFrameHeader();
+        Ptr<Packet> payload = status->GetReplyPayload();
+        status->InitializeReply();
+        Simulator::Schedule(m_windowDelay,
+                            &DownlinkBudgetComponent::SendInRx2,
+                            this,
+                            status,
+                            networkStatus,
+                            macHeader,
+                            frameHeader,
+                            payload,
+                            rx2Airtime);
+    }
+    else
+    {
+        m_rx2++;
+        Charge(rx2Frequency, rx2Airtime);
+    }
+}
+
+inline void
+DownlinkBudgetComponent::SendInRx2(Ptr<lorawan::EndDeviceStatus> status,
+                                   Ptr<lorawan::NetworkStatus> networkStatus,
+                                   lorawan::LorawanMacHeader macHeader,
+                                   lorawan::LoraFrameHeader frameHeader,
+                                   Ptr<Packet> payload,
+                                   double airtime)
+{
+    lorawan::LoraDeviceAddress address = status->GetMac()->GetDeviceAddress();
+    Address gateway = networkStatus->GetBestGatewayForDevice(address, 2);
+    if (gateway == Address())
+    {
+        m_dropped++;
+        return;
+    }
+    status->SetReplyMacHeader(macHeader);
+    status->SetReplyFrameHeader(frameHeader);
+    status->SetReplyPayload(payload);
+    networkStatus->SendThroughGateway(networkStatus->GetReplyForDevice(address, 2), gateway);
+    status->InitializeReply();
+    m_rx2++;
+    Charge(status->GetSecondReceiveWindowFrequency(), airtime);
+}
+
+inline uint64_t
+DownlinkBudgetComponent::GetRx1Count() const
+{
+    return m_rx1;
+}
+
+inline uint64_t
+DownlinkBudgetComponent::GetRx2Count() const
+{
+    return m_rx2;
+}
+
+inline uint64_t
+DownlinkBudgetComponent::GetDeferredCount() const
+{
+    return m_deferred;
+}
+
+inline uint64_t
+DownlinkBudgetComponent::GetDroppedCount() const
+{
+    return m_dropped;
+}
+
+inline uint64_t
+DownlinkBudgetComponent::GetDeprioritisedCount() const
+{
+    return m_deprioritised;
+}
+
+inline double
+DownlinkBudgetComponent::GetRemainingBudget(double frequencyHz)
+{
+    SubBand* band = FindSubBand(frequencyHz);
+    if (!band)
+    {
+        return 0.0;
+    }
+    Expire(*band);
+    return band->dutyCycle * m_window.GetSeconds() - band->used;
+}
+
+inline double
+DownlinkBudgetComponent::GetAllowance(double frequencyHz)
+{
+    SubBand* band = FindSubBand(frequencyHz);
+    return band ? band->dutyCycle * m_window.GetSeconds() : 0.0;
+}
+
+inline DownlinkBudgetComponent::SubBand*
+DownlinkBudgetComponent::FindSubBand(double frequencyHz)
+{
+    for (auto& band : m_bands)
+    {
+        if (frequencyHz >= band.firstHz && frequencyHz <= band.lastHz)
+        {
+            return &band;
+        }
+    }
+    return nullptr;
+}
+
+inline void
+DownlinkBudgetComponent::Expire(SubBand& band)
+{
+    Time horizon = Simulator::Now() - m_window;
+    while (!band.sent.empty() && band.sent.front().first <= horizon)
+    {
+        band.used -= band.sent.front().second;
+        band.sent.pop_front();
+    }
+    if (band.sent.empty())
+    {
+        band.used = 0.0; // Avoid drift from repeated floating-point subtraction
+    }
+}
+
+inline double
+DownlinkBudgetComponent::AirTime(Ptr<const Packet> packet, uint8_t sf)
+{
+    lorawan::LoraTxParameters params;
+    params.sf = sf;
+    params.lowDataRateOptimizationEnabled = sf >= 11;
+    return lorawan::LoraPhy::GetOnAirTime(packet->Copy(), params).GetSeconds();
+}
+
+inline void
+DownlinkBudgetComponent::Charge(double frequencyHz, double airtime)
+{
+    SubBand* band = FindSubBand(frequencyHz);
+    if (!band)
+    {
+        return;
+    }
+    band->sent.emplace_back(Simulator::Now(), airtime);
+    band->used += airtime;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_DOWNLINK_BUDGET_COMPONENT_H */
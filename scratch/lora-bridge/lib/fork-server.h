@@ -0,0 +1,238 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Replications of one scenario from a single set-up.
+//
+// Building a large topology (device installs, energy models, backhaul,
+// network server, SF assignment) can take longer than a short run. The
+// program builds the scenario once, up to just before Simulator::Run(), and
+// the fork server then fork()s one child per RNG run. A child starts from a
+// copy-on-write image of the parent, so it begins simulating at once.
+//
+// The child comes back from Serve() with the run set in RngSeedManager. The
+// random variables created during the set-up still carry the parent's run,
+// so the program must call AssignStreams() again on everything it draws
+// from, and redo any set-up step that drew from them, such as an SF
+// assignment that goes through the fading model. A single run should take
+// the same path so that replication N draws what a single run N does. The
+// parent only waits for the children; no thread may be running when it
+// forks.
+
+#ifndef LORA_BRIDGE_FORK_SERVER_H
+#define LORA_BRIDGE_FORK_SERVER_H
+
+#include "ns3/rng-seed-manager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Forks one child process per RNG run from a fully built scenario.
+ */
+class ForkServer
+{
+  public:
+    /// Outcome of one replication
+    struct Result
+    {
+        uint64_t run = 0;         //!< RNG run of the child
+        pid_t pid = -1;           //!< Process id, -1 if the fork failed
+        int exitStatus = -1;      //!< Exit code, -1 if the child did not exit normally
+        double wallSeconds = 0.0; //!< Wall-clock time from the fork to the exit (s)
+    };
+
+    ForkServer();
+
+    /// @param run One more RNG run to replicate.
+    void AddRun(uint64_t run);
+
+    /// @return The number of runs added
+    uint32_t GetRunCount() const;
+
+    /**
+     * @param maxChildren Children running at the same time, 0 for the number of cores.
+     */
+    void SetMaxChildren(uint32_t maxChildren);
+
+    /**
+     * Fork the children. In a child, return at once with its run set in
+     * RngSeedManager; in the parent, return when all the children have exited.
+     *
+     * @return Whether the caller is a child.
+     */
+    bool Serve();
+
+    /// @return Whether the process is a child
+    bool IsChild() const;
+
+    /// @return The run of the child, or of the first run in the parent
+    uint64_t GetRun() const;
+
+    /// @return The outcome of every run, in the order they were added (parent only)
+    const std::vector<Result>& GetResults() const;
+
+    /// @return The number of runs that failed to fork or did not exit with 0
+    uint32_t GetFailedCount() const;
+
+  private:
+    /// Wait for one child and record its outcome
+    void Reap();
+
+    std::vector<uint64_t> m_runs;                                     //!< Runs to replicate
+    uint32_t m_maxChildren;                                           //!< Concurrent children, 0 for the cores
+    bool m_child;                                                     //!< Whether this is a child
+    uint64_t m_run;                                                   //!< Run of this process
+    std::vector<Result> m_results;                                    //!< Outcome per run
+    std::map<pid_t, size_t> m_running;                                //!< Running child -> index of its result
+    std::map<pid_t, std::chrono::steady_clock::time_point> m_started; //!< Running child -> fork time
+};
+
+inline ForkServer::ForkServer()
+    : m_maxChildren(0),
+      m_child(false),
+      m_run(0)
+{
+}
+
+inline void
+ForkServer::AddRun(uint64_t run)
+{
+    m_runs.push_back(run);
+}
+
+inline uint32_t
+ForkServer::GetRunCount() const
+{
+    return m_runs.size();
+}
+
+inline void
+ForkServer::SetMaxChildren(uint32_t maxChildren)
+{
+    m_maxChildren = maxChildren;
+}
+
+inline bool
+ForkServer::Serve()
+{
+    uint32_t maxChildren = m_maxChildren;
+    if (maxChildren == 0)
+    {
+        maxChildren = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_run = m_runs.empty() ? RngSeedManager::GetRun() : m_runs.front();
+    m_results.assign(m_runs.size(), Result());
+
+    for (size_t i = 0; i < m_runs.size(); ++i)
+    {
+        while (m_running.size() >= maxChildren)
+        {
+            Reap();
+        }
+        m_results[i].run = m_runs[i];
+
+        // Buffered output would otherwise be written by the parent and every child
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            m_child = true;
+            m_run = m_runs[i];
+            m_results.clear();
+            m_running.clear();
+            m_started.clear();
+            RngSeedManager::SetRun(m_run);
+            return true;
+        }
+        m_results[i].pid = pid;
+        if (pid > 0)
+        {
+            m_running[pid] = i;
+            m_started[pid] = std::chrono::steady_clock::now();
+        }
+    }
+    while (!m_running.empty())
+    {
+        Reap();
+    }
+    return false;
+}
+
+inline void
+ForkServer::Reap()
+{
+    int status = 0;
+    pid_t pid;
+    do
+    {
+        pid = waitpid(-1, &status, 0);
+    } while (pid < 0 && errno == EINTR); // A signal is not the end of the children
+    auto it = m_running.find(pid);
+    if (it == m_running.end())
+    {
+        if (pid < 0)
+        {
+            m_running.clear(); // ECHILD: no child left to wait for
+        }
+        return;
+    }
+    Result& result = m_results[it->second];
+    result.exitStatus = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    result.wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - m_started[pid]).count();
+    m_running.erase(it);
+    m_started.erase(pid);
+}
+
+inline bool
+ForkServer::IsChild() const
+{
+    return m_child;
+}
+
+inline uint64_t
+ForkServer::GetRun() const
+{
+    return m_run;
+}
+
+inline const std::vector<ForkServer::Result>&
+ForkServer::GetResults() const
+{
+    return m_results;
+}
+
+inline uint32_t
+ForkServer::GetFailedCount() const
+{
+    uint32_t failed = 0;
+    for (const auto& result : m_results)
+    {
+        if (result.pid < 0 || result.exitStatus != 0)
+        {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_FORK_SERVER_H */
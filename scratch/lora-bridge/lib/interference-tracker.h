@@ -0,0 +1,378 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Scenario-side interference analytics.
+//
+// Every uplink is kept as an interval in a lane keyed by frequency and
+// spreading factor. A lane is ordered by start time and knows its longest
+// transmission, so the transmissions overlapping a new one are found with a
+// single lower_bound: O(log n + k) per insertion instead of a scan of all
+// active transmissions. Overlaps are counted per time window as same-SF
+// (with the capture outcome expected from the mean receive powers) or
+// inter-SF, and consecutive overlapping same-SF transmissions form collision
+// clusters. The gateway reception outcomes are then attributed: an
+// interference loss is a same-SF collision if the transmission overlapped
+// one on its own SF, and inter-SF interference otherwise.
+//
+// The tracker only uses plain values, so it can run on the trace processor
+// thread (see async-trace.h).
+
+#ifndef LORA_BRIDGE_INTERFERENCE_TRACKER_H
+#define LORA_BRIDGE_INTERFERENCE_TRACKER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Interval index of the uplinks with per-window overlap and loss statistics.
+ */
+class InterferenceTracker
+{
+  public:
+    /// Outcome of one gateway reception
+    enum Outcome
+    {
+        RECEIVED,          //!< Received
+        LOST_SAME_SF,      //!< Interference loss, overlapped a same-SF transmission
+        LOST_INTER_SF,     //!< Interference loss, only overlapped other SFs
+        LOST_UNATTRIBUTED, //!< Interference loss without an uplink overlap (e.g. a downlink)
+        LOST_SENSITIVITY,  //!< Below sensitivity
+        LOST_NO_RECEIVER,  //!< No free reception path at the gateway
+        OUTCOME_COUNT
+    };
+
+    /// Statistics of one time window
+    struct WindowStats
+    {
+        uint64_t transmissions = 0;          //!< Uplinks started in the window
+        uint64_t sameSfOverlaps = 0;         //!< Overlapping same-SF pairs
+        uint64_t interSfOverlaps = 0;        //!< Overlapping pairs on the same frequency, other SF
+        uint64_t captured = 0;               //!< Same-SF pairs where the stronger one should survive
+        uint64_t destroyed = 0;              //!< Same-SF pairs too close in power for capture
+        uint64_t clusters = 0;               //!< Collision clusters (two or more transmissions)
+        uint64_t clusteredTransmissions = 0; //!< Transmissions in collision clusters
+        uint64_t maxClusterSize = 0;         //!< Largest collision cluster
+        uint64_t outcomes[OUTCOME_COUNT] = {0}; //!< Gateway receptions per outcome
+    };
+
+    InterferenceTracker();
+
+    /**
+     * @param windowNs Length of a statistics window (ns).
+     */
+    void SetWindow(int64_t windowNs);
+
+    /**
+     * @param thresholdDb Power difference above which the stronger of two
+     *                    same-SF transmissions is captured.
+     */
+    void SetCaptureThreshold(double thresholdDb);
+
+    /**
+     * Add an uplink. Uplinks must be added in start time order.
+     *
+     * @param id Packet id, used to attribute the outcomes.
+     * @param frequency Channel frequency (Hz).
+     * @param sf Spreading factor.
+     * @param startNs Start of the transmission (ns).
+     * @param durationNs Time on air (ns).
+     * @param rxPowerDbm Mean receive power at the reference gateway (dBm).
+     */
+    void AddTransmission(uint32_t id,
+                         uint32_t frequency,
+                         uint8_t sf,
+                         int64_t startNs,
+                         int64_t durationNs,
+                         double rxPowerDbm);
+
+    /**
+     * Record a gateway reception outcome. LOST_SAME_SF, LOST_INTER_SF and
+     * LOST_UNATTRIBUTED all mean "lost to interference" and are attributed
+     * from the overlaps of the transmission.
+     *
+     * @param id Packet id given to AddTransmission.
+     * @param outcome The outcome.
+     */
+    void RecordOutcome(uint32_t id, Outcome outcome);
+
+    /// Close the open collision clusters, at the end of the run
+    void Finish();
+
+    /// @return The statistics per window
+    const std::vector<WindowStats>& GetWindows() const;
+
+    /// @return The statistics of all windows together
+    WindowStats GetTotal() const;
+
+    /// @return The window length (ns)
+    int64_t GetWindow() const;
+
+    /// @return Outcomes whose transmission was unknown or already pruned
+    uint64_t GetUnmatchedCount() const;
+
+    /// @return The number of transmissions currently indexed
+    size_t GetIndexedCount() const;
+
+  private:
+    /// One indexed transmission
+    struct Transmission
+    {
+        uint32_t id;       //!< Packet id
+        int64_t endNs;     //!< End of the transmission (ns)
+        double rxPowerDbm; //!< Mean receive power (dBm)
+        uint32_t window;   //!< Window of the start
+        bool sameSf;       //!< Overlapped a same-SF transmission
+        bool interSf;      //!< Overlapped another SF on the same frequency
+    };
+
+    /// Transmissions of one frequency and SF, ordered by start time
+    struct Lane
+    {
+        std::multimap<int64_t, Transmission> active; //!< Start time -> transmission
+        int64_t maxDurationNs = 0;                   //!< Longest transmission seen
+        int64_t clusterEndNs = -1;                   //!< End of the open collision cluster
+        uint64_t clusterSize = 0;                    //!< Transmissions in the open cluster
+        uint32_t clusterWindow = 0;                  //!< Window of the first one
+    };
+
+    typedef std::multimap<int64_t, Transmission>::iterator TransmissionIt;
+
+    /// @return The lane key of @p frequency and @p sf
+    static uint64_t GetKey(uint32_t frequency, uint8_t sf);
+
+    /// @return The statistics of window @p window, created on demand
+    WindowStats& GetWindowStats(uint32_t window);
+
+    /// Count the open cluster of @p lane if it is a collision cluster
+    void CloseCluster(Lane& lane);
+
+    /// Drop the transmissions of @p lane that can no longer get an outcome
+    void Prune(Lane& lane, int64_t nowNs);
+
+    int64_t m_windowNs;                                  //!< Window length (ns)
+    double m_captureThresholdDb;                         //!< Capture threshold (dB)
+    std::unordered_map<uint64_t, Lane> m_lanes;          //!< Lanes by key
+    std::unordered_map<uint32_t, TransmissionIt> m_byId; //!< Indexed transmissions by id
+    std::vector<WindowStats> m_windows;                  //!< Statistics per window
+    uint64_t m_unmatched;                                //!< Outcomes without a transmission
+};
+
+inline InterferenceTracker::InterferenceTracker()
+    : m_windowNs(3600000000000LL),
+      m_captureThresholdDb(6.0),
+      m_unmatched(0)
+{
+}
+
+inline void
+InterferenceTracker::SetWindow(int64_t windowNs)
+{
+    m_windowNs = std::max<int64_t>(windowNs, 1);
+}
+
+inline void
+InterferenceTracker::SetCaptureThreshold(double thresholdDb)
+{
+    m_captureThresholdDb = thresholdDb;
+}
+
+inline void
+InterferenceTracker::AddTransmission(uint32_t id,
+                                     uint32_t frequency,
+                                     uint8_t sf,
+                                     int64_t startNs,
+                                     int64_t durationNs,
+                                     double rxPowerDbm)
+{
+    uint32_t window = static_cast<uint32_t>(startNs / m_windowNs);
+    WindowStats& stats = GetWindowStats(window);
+    stats.transmissions++;
+    Transmission tx = {id, startNs + durationNs, rxPowerDbm, window, false, false};
+
+    // Every indexed transmission started before this one, so it overlaps if
+    // it has not ended yet; none started before start - maxDuration can
+    for (uint8_t otherSf = 7; otherSf <= 12; ++otherSf)
+    {
+        auto laneIt = m_lanes.find(GetKey(frequency, otherSf));
+        if (laneIt == m_lanes.end())
+        {
+            continue;
+        }
+        Lane& other = laneIt->second;
+        Prune(other, startNs);
+        for (auto it = other.active.lower_bound(startNs - other.maxDurationNs); it != other.active.end();
+             ++it)
+        {
+            Transmission& old = it->second;
+            if (old.endNs <= startNs)
+            {
+                continue;
+            }
+            if (otherSf == sf)
+            {
+                old.sameSf = tx.sameSf = true;
+                stats.sameSfOverlaps++;
+                if (std::fabs(old.rxPowerDbm - rxPowerDbm) >= m_captureThresholdDb)
+                {
+                    stats.captured++;
+                }
+                else
+                {
+                    stats.destroyed++;
+                }
+            }
+            else
+            {
+                old.interSf = tx.interSf = true;
+                stats.interSfOverlaps++;
+            }
+        }
+    }
+
+    Lane& lane = m_lanes[GetKey(frequency, sf)];
+    if (startNs < lane.clusterEndNs)
+    {
+        lane.clusterSize++;
+        lane.clusterEndNs = std::max(lane.clusterEndNs, tx.endNs);
+    }
+    else
+    {
+        CloseCluster(lane);
+        lane.clusterSize = 1;
+        lane.clusterEndNs = tx.endNs;
+        lane.clusterWindow = window;
+    }
+    lane.maxDurationNs = std::max(lane.maxDurationNs, durationNs);
+    m_byId[id] = lane.active.emplace(startNs, tx);
+}
+
+inline void
+InterferenceTracker::RecordOutcome(uint32_t id, Outcome outcome)
+{
+    auto it = m_byId.find(id);
+    if (it == m_byId.end())
+    {
+        m_unmatched++;
+        return;
+    }
+    const Transmission& tx = it->second->second;
+    if (outcome == LOST_SAME_SF || outcome == LOST_INTER_SF || outcome == LOST_UNATTRIBUTED)
+    {
+        outcome = tx.sameSf ? LOST_SAME_SF : tx.interSf ? LOST_INTER_SF : LOST_UNATTRIBUTED;
+    }
+    GetWindowStats(tx.window).outcomes[outcome]++;
+}
+
+inline void
+InterferenceTracker::Finish()
+{
+    for (auto& lane : m_lanes)
+    {
+        CloseCluster(lane.second);
+    }
+}
+
+inline const std::vector<InterferenceTracker::WindowStats>&
+InterferenceTracker::GetWindows() const
+{
+    return m_windows;
+}
+
+inline InterferenceTracker::WindowStats
+InterferenceTracker::GetTotal() const
+{
+    WindowStats total;
+    for (const auto& w : m_windows)
+    {
+        total.transmissions += w.transmissions;
+        total.sameSfOverlaps += w.sameSfOverlaps;
+        total.interSfOverlaps += w.interSfOverlaps;
+        total.captured += w.captured;
+        total.destroyed += w.destroyed;
+        total.clusters += w.clusters;
+        total.clusteredTransmissions += w.clusteredTransmissions;
+        total.maxClusterSize = std::max(total.maxClusterSize, w.maxClusterSize);
+        for (int o = 0; o < OUTCOME_COUNT; ++o)
+        {
+            total.outcomes[o] += w.outcomes[o];
+        }
+    }
+    return total;
+}
+
+inline int64_t
+InterferenceTracker::GetWindow() const
+{
+    return m_windowNs;
+}
+
+inline uint64_t
+InterferenceTracker::GetUnmatchedCount() const
+{
+    return m_unmatched;
+}
+
+inline size_t
+InterferenceTracker::GetIndexedCount() const
+{
+    return m_byId.size();
+}
+
+inline uint64_t
+InterferenceTracker::GetKey(uint32_t frequency, uint8_t sf)
+{
+    return (static_cast<uint64_t>(frequency) << 8) | sf;
+}
+
+inline InterferenceTracker::WindowStats&
+InterferenceTracker::GetWindowStats(uint32_t window)
+{
+    if (window >= m_windows.size())
+    {
+        m_windows.resize(window + 1);
+    }
+    return m_windows[window];
+}
+
+inline void
+InterferenceTracker::CloseCluster(Lane& lane)
+{
+    if (lane.clusterSize >= 2)
+    {
+        WindowStats& stats = GetWindowStats(lane.clusterWindow);
+        stats.clusters++;
+        stats.clusteredTransmissions += lane.clusterSize;
+        stats.maxClusterSize = std::max(stats.maxClusterSize, lane.clusterSize);
+    }
+    lane.clusterSize = 0;
+}
+
+inline void
+InterferenceTracker::Prune(Lane& lane, int64_t nowNs)
+{
+    // Outcomes arrive at the end of the reception: keep a transmission until
+    // a full maximum duration after it can have ended
+    while (!lane.active.empty() && lane.active.begin()->first + 2 * lane.maxDurationNs < nowNs)
+    {
+        // A retransmission reuses the packet id: only drop the entry if it is this one
+        auto byId = m_byId.find(lane.active.begin()->second.id);
+        if (byId != m_byId.end() && byId->second == lane.active.begin())
+        {
+            m_byId.erase(byId);
+        }
+        lane.active.erase(lane.active.begin());
+    }
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_INTERFERENCE_TRACKER_H */
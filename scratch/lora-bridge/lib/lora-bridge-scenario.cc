@@ -0,0 +1,824 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Implementation of the building blocks declared in lora-bridge-scenario.h.
+
+#include "lora-bridge-scenario.h"
+
+#include "ns3/basic-energy-source-helper.h"
+#include "ns3/basic-energy-source.h"
+#include "ns3/double.h"
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/log.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-radio-energy-model-helper.h"
+#include "ns3/lora-tag.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/network-server-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/position-allocator.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraBridgeScenario");
+
+using namespace lorawan;
+
+/***************
+ * UniquePacketIdTag
+ ***************/
+
+NS_OBJECT_ENSURE_REGISTERED(UniquePacketIdTag);
+
+TypeId
+UniquePacketIdTag::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::UniquePacketIdTag")
+                            .SetParent<Tag>()
+                            .SetGroupName("LoraBridge")
+                            .AddConstructor<UniquePacketIdTag>();
+    return tid;
+}
+
+UniquePacketIdTag::UniquePacketIdTag()
+    : m_id(0)
+{
+}
+
+UniquePacketIdTag::UniquePacketIdTag(uint32_t id)
+    : m_id(id)
+{
+}
+
+TypeId
+UniquePacketIdTag::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+void
+UniquePacketIdTag::Serialize(TagBuffer i) const
+{
+    i.WriteU32(m_id);
+}
+
+void
+UniquePacketIdTag::Deserialize(TagBuffer i)
+{
+    m_id = i.ReadU32();
+}
+
+uint32_t
+UniquePacketIdTag::GetSerializedSize() const
+{
+    return 4;
+}
+
+void
+UniquePacketIdTag::Print(std::ostream& os) const
+{
+    os << "UniquePacketId=" << m_id;
+}
+
+void
+UniquePacketIdTag::SetId(uint32_t id)
+{
+    m_id = id;
+}
+
+uint32_t
+UniquePacketIdTag::GetId() const
+{
+    return m_id;
+}
+
+/***************
+ * TaggingPeriodicSender
+ ***************/
+
+NS_OBJECT_ENSURE_REGISTERED(TaggingPeriodicSender);
+
+uint32_t TaggingPeriodicSender::s_lastPacketId = 0;
+
+TypeId
+TaggingPeriodicSender::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::TaggingPeriodicSender")
+                            .SetParent<Application>()
+                            .SetGroupName("LoraBridge")
+                            .AddConstructor<TaggingPeriodicSender>();
+    return tid;
+}
+
+TaggingPeriodicSender::TaggingPeriodicSender()
+    : m_period(Seconds(60)),
+      m_packetSize(20),
+      m_packetsSent(0),
+      m_running(false),
+      m_selfScheduling(true),
+      m_addMacHeader(false),
+      m_mType(LorawanMacHeader::UNCONFIRMED_DATA_UP),
+      m_sfTag(false)
+{
+}
+
+void
+TaggingPeriodicSender::Setup(Ptr<Node> node, Ptr<NetDevice> device, Time period, uint32_t packetSize)
+{
+    m_node = node;
+    m_device = device;
+    m_period = period;
+    m_packetSize = packetSize;
+}
+
+void
+TaggingPeriodicSender::SetMacHeader(LorawanMacHeader::MType mType)
+{
+    m_addMacHeader = true;
+    m_mType = mType;
+}
+
+void
+TaggingPeriodicSender::SetSpreadingFactorTag(bool enable)
+{
+    m_sfTag = enable;
+}
+
+void
+TaggingPeriodicSender::SetPeriod(Time newPeriod)
+{
+    Rephase(newPeriod, Seconds(0));
+}
+
+void
+TaggingPeriodicSender::Rephase(Time newPeriod, Time phase)
+{
+    if (!m_selfScheduling)
+    {
+        return;
+    }
+    Simulator::Cancel(m_sendEvent);
+    m_period = newPeriod;
+    if (m_arrivals)
+    {
+        m_arrivals->SetMeanInterval(newPeriod);
+    }
+    if (m_running)
+    {
+        ScheduleNextTx(phase);
+    }
+}
+
+void
+TaggingPeriodicSender::SetArrivalProcess(Ptr<ArrivalProcess> arrivals)
+{
+    m_arrivals = arrivals;
+}
+
+void
+TaggingPeriodicSender::SendEventPacket()
+{
+    if (m_running)
+    {
+        Transmit(m_packetSize);
+    }
+}
+
+void
+TaggingPeriodicSender::SendExternalPacket(uint32_t packetSize)
+{
+    if (m_running)
+    {
+        Transmit(packetSize);
+    }
+}
+
+void
+TaggingPeriodicSender::SetSelfScheduling(bool selfScheduling)
+{
+    m_selfScheduling = selfScheduling;
+}
+
+uint32_t
+TaggingPeriodicSender::GetPacketsSent() const
+{
+    return m_packetsSent;
+}
+
+uint32_t
+TaggingPeriodicSender::GetUplinkSize() const
+{
+    uint32_t size = m_packetSize + 13;
+    if (m_addMacHeader)
+    {
+        size += LorawanMacHeader().GetSerializedSize();
+    }
+    return size;
+}
+
+uint32_t
+TaggingPeriodicSender::GetLastPacketId()
+{
+    return s_lastPacketId;
+}
+
+void
+TaggingPeriodicSender::StartApplication()
+{
+    m_running = true;
+    if (m_selfScheduling)
+    {
+        ScheduleNextTx(Seconds(0));
+    }
+}
+
+void
+TaggingPeriodicSender::StopApplication()
+{
+    m_running = false;
+    Simulator::Cancel(m_sendEvent);
+}
+
+void
+TaggingPeriodicSender::ScheduleNextTx(Time delay)
+{
+    m_sendEvent = Simulator::Schedule(delay, &TaggingPeriodicSender::SendPacket, this);
+}
+
+void
+TaggingPeriodicSender::SendPacket()
+{
+    if (Transmit(m_packetSize))
+    {
+        ScheduleNextTx(m_arrivals ? m_arrivals->NextInterArrival() : m_period);
+    }
+}
+
+bool
+TaggingPeriodicSender::Transmit(uint32_t packetSize)
+{
+    Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(m_device);
+    if (!loraNetDevice)
+    {
+        NS_LOG_ERROR("Device is not a LoraNetDevice");
+        return false;
+    }
+
+    Ptr<Packet> packet = Create<Packet>(packetSize);
+    UniquePacketIdTag idTag(++s_lastPacketId);
+    packet->AddPacketTag(idTag);
+
+    if (m_addMacHeader)
+    {
+        LorawanMacHeader macHdr;
+        macHdr.SetMType(m_mType);
+        packet->AddHeader(macHdr);
+    }
+
+    if (m_sfTag)
+    {
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        if (!mac)
+        {
+            NS_LOG_ERROR("MAC is not an EndDeviceLorawanMac");
+            return false;
+        }
+        uint8_t dr = mac->GetDataRate();
+        LoraTag tag;
+        tag.SetSpreadingFactor((dr <= 5) ? (12 - dr) : 7);
+        packet->AddPacketTag(tag);
+    }
+
+    loraNetDevice->GetMac()->Send(packet);
+    m_packetsSent++;
+    return true;
+}
+
+/***************
+ * Utilities
+ ***************/
+
+double
+CalculateTimeOnAir(uint32_t payloadSize,
+                   uint8_t sf,
+                   double bandwidthHz,
+                   uint8_t codingRate,
+                   bool crcEnabled,
+                   bool headerEnabled,
+                   uint8_t nPreamble)
+{
+    if (sf < 7 || sf > 12)
+    {
+        NS_LOG_ERROR("Invalid SF " << unsigned(sf) << " in CalculateTimeOnAir, using default SF7");
+        sf = 7;
+    }
+    if (bandwidthHz <= 0)
+    {
+        NS_LOG_ERROR("Invalid bandwidth " << bandwidthHz << "Hz, using default 125000Hz");
+        bandwidthHz = 125000.0;
+    }
+
+    double symbol = (1 << sf) / bandwidthHz;
+    double preamble = (nPreamble + 4.25) * symbol;
+
+    // Low data rate optimisation on SF11 and SF12, implicit header removes 20 bits
+    int lowDataRate = (sf >= 11) ? 1 : 0;
+    int implicitHeader = headerEnabled ? 0 : 1;
+    double payloadSymbols =
+        8 + std::max(std::ceil((8.0 * payloadSize - 4.0 * sf + 28 + 16 * crcEnabled - 20 * implicitHeader) /
+                               (4.0 * (sf - 2 * lowDataRate))) *
+                         (codingRate + 4),
+                     0.0);
+
+    double toa = preamble + payloadSymbols * symbol;
+    if (!std::isfinite(toa) || toa < 0)
+    {
+        NS_LOG_ERROR("Calculated ToA is invalid (" << toa << "s) for SF" << unsigned(sf)
+                                                   << ", payloadSize=" << payloadSize);
+        return 0.0;
+    }
+    NS_LOG_DEBUG("Calculated ToA: " << toa << "s for SF" << unsigned(sf) << ", payloadSize=" << payloadSize);
+    return toa;
+}
+
+bool
+WriteEnergyTex(const std::string& filename, double simDuration, const EnergySourceContainer& sources)
+{
+    std::ofstream texFile(filename);
+    if (!texFile)
+    {
+        NS_LOG_ERROR("Could not open " << filename);
+        return false;
+    }
+    texFile << "\\documentclass{article}\n"
+            << "\\usepackage{booktabs}\n"
+            << "\\begin{document}\n"
+            << "Simulation duration: " << simDuration << " seconds.\\\\\n\n"
+            << "\\begin{tabular}{ccc}\n"
+            << "\\toprule\n"
+            << "Node ID & Initial Energy (J) & Energy Consumed (J) \\\\\n"
+            << "\\midrule\n";
+
+    for (uint32_t i = 0; i < sources.GetN(); ++i)
+    {
+        Ptr<BasicEnergySource> src = sources.Get(i)->GetObject<BasicEnergySource>();
+        double initialEnergy = src->GetInitialEnergy();
+        double remainingEnergy = src->GetRemainingEnergy();
+        double consumed = initialEnergy - remainingEnergy;
+
+        NS_LOG_INFO("Node " << i << ": Initial=" << initialEnergy << " J, Consumed=" << consumed
+                            << " J, Remaining=" << remainingEnergy << " J");
+
+        texFile << i << " & " << initialEnergy << " & " << consumed << " \\\\\n";
+    }
+
+    texFile << "\\bottomrule\n"
+            << "\\end{tabular}\n"
+            << "\\end{document}\n";
+    NS_LOG_INFO("Energy log saved to " << filename);
+    return static_cast<bool>(texFile);
+}
+
+/***************
+ * LoraBridgeScenario
+ ***************/
+
+LoraBridgeScenario::LoraBridgeScenario()
+    : m_nDevices(20),
+      m_spacing(5.0),
+      m_deviceHeight(0.0),
+      m_hasServer(false),
+      m_startStep(Seconds(0))
+{
+}
+
+void
+LoraBridgeScenario::SetEndDeviceCount(uint32_t nDevices)
+{
+    m_nDevices = nDevices;
+}
+
+void
+LoraBridgeScenario::SetDeviceLayout(double spacing, double height)
+{
+    m_spacing = spacing;
+    m_deviceHeight = height;
+}
+
+void
+LoraBridgeScenario::AddGateway(Vector position)
+{
+    m_gatewayPositions.push_back(position);
+}
+
+void
+LoraBridgeScenario::SetNetworkServer(Vector position)
+{
+    m_hasServer = true;
+    m_serverPosition = position;
+}
+
+void
+LoraBridgeScenario::SetObstacles(Ptr<ObstacleLossModel> obstacles)
+{
+    m_obstacles = obstacles;
+}
+
+void
+LoraBridgeScenario::SetFadingModel(Ptr<PropagationLossModel> fading)
+{
+    m_fading = fading;
+}
+
+void
+LoraBridgeScenario::SetStaggeredStart(Time step)
+{
+    m_startStep = step;
+}
+
+void
+LoraBridgeScenario::Build()
+{
+    BuildChannel();
+    BuildNodes();
+    BuildDevices();
+    if (m_hasServer)
+    {
+        BuildNetworkServer();
+    }
+}
+
+Ptr<LoraChannel>
+LoraBridgeScenario::BuildChannel()
+{
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.9);
+    loss->SetReference(1.0, 32.4); // FSPL at 1 m for 868 MHz
+
+    Ptr<PropagationLossModel> fading = m_fading;
+    if (!fading)
+    {
+        fading = CreateObject<NakagamiPropagationLossModel>();
+        fading->SetAttribute("m0", DoubleValue(1.0));
+        fading->SetAttribute("m1", DoubleValue(1.5));
+        fading->SetAttribute("m2", DoubleValue(3.0));
+    }
+    if (m_obstacles)
+    {
+        loss->SetNext(m_obstacles);
+        m_obstacles->SetNext(fading);
+    }
+    else
+    {
+        loss->SetNext(fading);
+    }
+
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    m_loss = loss;
+    m_channel = CreateObject<LoraChannel>(loss, delay);
+    NS_LOG_INFO("Channel setup complete.");
+    return m_channel;
+}
+
+Ptr<PropagationLossModel>
+LoraBridgeScenario::CreateMeanLossModel() const
+{
+    NS_ASSERT_MSG(m_loss, "BuildChannel() first");
+    DoubleValue exponent;
+    DoubleValue referenceDistance;
+    DoubleValue referenceLoss;
+    m_loss->GetAttribute("Exponent", exponent);
+    m_loss->GetAttribute("ReferenceDistance", referenceDistance);
+    m_loss->GetAttribute("ReferenceLoss", referenceLoss);
+
+    Ptr<LogDistancePropagationLossModel> mean = CreateObject<LogDistancePropagationLossModel>();
+    mean->SetPathLossExponent(exponent.Get());
+    mean->SetReference(referenceDistance.Get(), referenceLoss.Get());
+    return mean;
+}
+
+void
+LoraBridgeScenario::BuildNodes()
+{
+    Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
+    for (uint32_t i = 0; i < m_nDevices; ++i)
+    {
+        double x = i * m_spacing + 5;
+        double y = (i % 2 == 0) ? 0 : 1;
+        allocator->Add(Vector(x, y, m_deviceHeight));
+        NS_LOG_INFO("Placed end device " << i << " at x=" << x << ", y=" << y << ", z=" << m_deviceHeight);
+    }
+    for (const Vector& position : m_gatewayPositions)
+    {
+        allocator->Add(position);
+        NS_LOG_INFO("Placed gateway at x=" << position.x << ", y=" << position.y << ", z=" << position.z);
+    }
+    if (m_hasServer)
+    {
+        allocator->Add(m_serverPosition);
+        NS_LOG_INFO("Placed network server at x=" << m_serverPosition.x << ", y=" << m_serverPosition.y
+                                                  << ", z=" << m_serverPosition.z);
+    }
+
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator(allocator);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    m_endDevices.Create(m_nDevices);
+    m_gateways.Create(m_gatewayPositions.size());
+    mobility.Install(m_endDevices);
+    mobility.Install(m_gateways);
+    if (m_hasServer)
+    {
+        m_server = CreateObject<Node>();
+        mobility.Install(m_server);
+    }
+    m_counters.receivedPerNode.assign(m_nDevices, 0);
+    NS_LOG_INFO("Nodes creation complete.");
+}
+
+void
+LoraBridgeScenario::BuildDevices()
+{
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(m_channel);
+    LorawanMacHelper macHelper;
+    macHelper.SetRegion(LorawanMacHelper::EU);
+    LoraHelper helper;
+    helper.EnablePacketTracking();
+
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    m_endDevicesNet = helper.Install(phyHelper, macHelper, m_endDevices);
+
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    m_gatewaysNet = helper.Install(phyHelper, macHelper, m_gateways);
+    NS_LOG_INFO("Devices setup complete.");
+}
+
+ApplicationContainer
+LoraBridgeScenario::BuildNetworkServer()
+{
+    NS_ASSERT_MSG(m_server, "SetNetworkServer() must be called before BuildNodes()");
+
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    pointToPoint.SetChannelAttribute("Delay", TimeValue(MilliSeconds(2)));
+
+    P2PGwRegistration_t gwRegistration;
+    for (uint32_t i = 0; i < m_gateways.GetN(); ++i)
+    {
+        NetDeviceContainer p2pDevices = pointToPoint.Install(m_server, m_gateways.Get(i));
+        Ptr<PointToPointNetDevice> serverP2PNetDev = DynamicCast<PointToPointNetDevice>(p2pDevices.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, m_gateways.Get(i));
+    }
+
+    ForwarderHelper forwarderHelper;
+    forwarderHelper.Install(m_gateways);
+
+    NetworkServerHelper networkServerHelper;
+    networkServerHelper.SetGatewaysP2P(gwRegistration);
+    networkServerHelper.SetEndDevices(m_endDevices);
+    ApplicationContainer nsApps = networkServerHelper.Install(m_server);
+    NS_LOG_INFO("Network server setup complete.");
+    return nsApps;
+}
+
+ApplicationContainer
+LoraBridgeScenario::InstallSenders(Time period, uint32_t packetSize, Time stop)
+{
+    m_startRv = CreateObject<UniformRandomVariable>();
+    m_startRv->SetAttribute("Min", DoubleValue(0.0));
+    m_startRv->SetAttribute("Max", DoubleValue(period.GetSeconds()));
+
+    ApplicationContainer apps;
+    for (uint32_t i = 0; i < m_endDevices.GetN(); ++i)
+    {
+        Ptr<TaggingPeriodicSender> app = CreateObject<TaggingPeriodicSender>();
+        app->Setup(m_endDevices.Get(i), m_endDevicesNet.Get(i), period, packetSize);
+        m_endDevices.Get(i)->AddApplication(app);
+        app->SetStartTime(m_startStep.IsZero() ? Seconds(m_startRv->GetValue()) : m_startStep * i);
+        app->SetStopTime(stop);
+        apps.Add(app);
+    }
+    m_senders.Add(apps);
+    return apps;
+}
+
+void
+LoraBridgeScenario::SetEnergyConfig(const EnergyConfig& energy)
+{
+    m_energy = energy;
+}
+
+const LoraBridgeScenario::EnergyConfig&
+LoraBridgeScenario::GetEnergyConfig() const
+{
+    return m_energy;
+}
+
+EnergySourceContainer
+LoraBridgeScenario::InstallEnergy()
+{
+    // 8 Ah at 3.3 V -> 95,040 J, 10000 J of it for the radio by default
+    BasicEnergySourceHelper basicSourceHelper;
+    basicSourceHelper.Set("BasicEnergySourceInitialEnergyJ", DoubleValue(m_energy.initialEnergyJ));
+    basicSourceHelper.Set("BasicEnergySupplyVoltageV", DoubleValue(m_energy.supplyVoltageV));
+
+    LoraRadioEnergyModelHelper radioEnergyHelper;
+    radioEnergyHelper.Set("StandbyCurrentA", DoubleValue(m_energy.standbyCurrentA));
+    radioEnergyHelper.Set("TxCurrentA", DoubleValue(m_energy.txCurrentA));
+    radioEnergyHelper.Set("RxCurrentA", DoubleValue(m_energy.rxCurrentA));
+    radioEnergyHelper.Set("SleepCurrentA", DoubleValue(m_energy.sleepCurrentA));
+    radioEnergyHelper.SetTxCurrentModel("ns3::ConstantLoraTxCurrentModel", "TxCurrent", DoubleValue(m_energy.txCurrentA));
+
+    EnergySourceContainer sources = basicSourceHelper.Install(m_endDevices);
+    radioEnergyHelper.Install(m_endDevicesNet, sources);
+    NS_LOG_INFO("Energy model installed.");
+    return sources;
+}
+
+void
+LoraBridgeScenario::SetSpreadingFactorsUp()
+{
+    LorawanMacHelper::SetSpreadingFactorsUp(m_endDevices, m_gateways, m_channel);
+}
+
+int64_t
+LoraBridgeScenario::AssignStreams(int64_t stream)
+{
+    int64_t first = stream;
+    if (m_loss)
+    {
+        stream += m_loss->AssignStreams(stream);
+    }
+    LorawanMacHelper macHelper;
+    stream += macHelper.AssignStreams(m_endDevicesNet, stream);
+    stream += macHelper.AssignStreams(m_gatewaysNet, stream);
+    if (m_startRv)
+    {
+        m_startRv->SetStream(stream++);
+        if (m_startStep.IsZero())
+        {
+            for (uint32_t i = 0; i < m_senders.GetN(); ++i)
+            {
+                m_senders.Get(i)->SetStartTime(Seconds(m_startRv->GetValue()));
+            }
+        }
+    }
+    return stream - first;
+}
+
+std::vector<uint8_t>
+LoraBridgeScenario::GetSpreadingFactors() const
+{
+    std::vector<uint8_t> spreadingFactors;
+    for (uint32_t i = 0; i < m_endDevicesNet.GetN(); ++i)
+    {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(m_endDevicesNet.Get(i));
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        uint8_t sf = 12 - mac->GetDataRate(); // EU868: DR0 = SF12, ..., DR5 = SF7
+        if (sf < 7 || sf > 12)
+        {
+            NS_LOG_ERROR("Invalid SF for node " << i << ": " << unsigned(sf));
+            sf = 7;
+        }
+        spreadingFactors.push_back(sf);
+        NS_LOG_INFO("End device " << i << " assigned SF" << unsigned(sf));
+    }
+    return spreadingFactors;
+}
+
+void
+LoraBridgeScenario::ConnectPacketCounters()
+{
+    for (uint32_t i = 0; i < m_endDevicesNet.GetN(); ++i)
+    {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(m_endDevicesNet.Get(i));
+        loraNetDevice->GetPhy()->TraceConnectWithoutContext(
+            "StartSending",
+            MakeBoundCallback(&LoraBridgeScenario::OnPhyStartSending, &m_counters, i));
+    }
+    for (uint32_t i = 0; i < m_gatewaysNet.GetN(); ++i)
+    {
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(m_gatewaysNet.Get(i));
+        loraNetDevice->GetPhy()->TraceConnectWithoutContext(
+            "ReceivedPacket",
+            MakeBoundCallback(&LoraBridgeScenario::OnPhyReceived, &m_counters));
+    }
+}
+
+void
+LoraBridgeScenario::PrintPacketStats(std::ostream& os) const
+{
+    std::vector<uint8_t> spreadingFactors = GetSpreadingFactors();
+    NS_LOG_INFO("Packets sent vs received per DR (SF7 -> SF12):");
+    for (int i = 0; i < 6; i++)
+    {
+        os << "DR" << (5 - i) << " (SF" << (7 + i) << "): Sent = " << m_counters.sent[i]
+           << ", Received = " << m_counters.received[i] << std::endl;
+    }
+    NS_LOG_INFO("Successful transmission to Gateway per end device:");
+    for (uint32_t i = 0; i < m_counters.receivedPerNode.size(); ++i)
+    {
+        os << "Node " << i << " (SF" << unsigned(spreadingFactors[i]) << "): " << m_counters.receivedPerNode[i]
+           << " packets received successfully by GW." << std::endl;
+    }
+}
+
+const LoraBridgeScenario::PacketCounters&
+LoraBridgeScenario::GetPacketCounters() const
+{
+    return m_counters;
+}
+
+Ptr<LoraChannel>
+LoraBridgeScenario::GetChannel() const
+{
+    return m_channel;
+}
+
+NodeContainer
+LoraBridgeScenario::GetEndDevices() const
+{
+    return m_endDevices;
+}
+
+NodeContainer
+LoraBridgeScenario::GetGateways() const
+{
+    return m_gateways;
+}
+
+Ptr<Node>
+LoraBridgeScenario::GetNetworkServer() const
+{
+    return m_server;
+}
+
+NetDeviceContainer
+LoraBridgeScenario::GetEndDeviceNetDevices() const
+{
+    return m_endDevicesNet;
+}
+
+NetDeviceContainer
+LoraBridgeScenario::GetGatewayNetDevices() const
+{
+    return m_gatewaysNet;
+}
+
+void
+LoraBridgeScenario::OnPhyStartSending(PacketCounters* counters,
+                                      uint32_t device,
+                                      Ptr<const Packet> packet,
+                                      uint32_t phyIndex)
+{
+    LoraTag tag;
+    if (packet->PeekPacketTag(tag) && tag.GetSpreadingFactor() >= 7 && tag.GetSpreadingFactor() <= 12)
+    {
+        counters->sent[tag.GetSpreadingFactor() - 7]++;
+    }
+    UniquePacketIdTag idTag;
+    if (packet->PeekPacketTag(idTag))
+    {
+        counters->senders.Set(idTag.GetId(), device);
+    }
+}
+
+void
+LoraBridgeScenario::OnPhyReceived(PacketCounters* counters, Ptr<const Packet> packet, uint32_t phyIndex)
+{
+    LoraTag tag;
+    if (packet->PeekPacketTag(tag) && tag.GetSpreadingFactor() >= 7 && tag.GetSpreadingFactor() <= 12)
+    {
+        counters->received[tag.GetSpreadingFactor() - 7]++;
+    }
+    // Copies of one uplink at several gateways and retransmissions count once per node
+    UniquePacketIdTag idTag;
+    if (!packet->PeekPacketTag(idTag) || !counters->unique.Insert(idTag.GetId()))
+    {
+        return;
+    }
+    uint32_t sender;
+    if (counters->senders.Get(idTag.GetId(), sender) && sender < counters->receivedPerNode.size())
+    {
+        counters->receivedPerNode[sender]++;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,387 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Building blocks shared by the LoRa bridge programs.
+//
+// The packet id tag, the tagging sender, the time-on-air formula, the
+// channel, layout, device, backhaul and energy setup and the tex energy table
+// used to be copied into every program. They live in the scratch-lora-bridge-lib
+// library (see ../CMakeLists.txt), compiled once and linked by every program.
+//
+// LoraBridgeScenario is the builder: configure the layout, then either call
+// Build() or the phases one by one (BuildChannel, BuildNodes, BuildDevices,
+// BuildNetworkServer), which lets a program hook its own set-up in between.
+// All nodes are created by BuildNodes(); the containers returned by the
+// getters share them.
+
+#ifndef LORA_BRIDGE_SCENARIO_H
+#define LORA_BRIDGE_SCENARIO_H
+
+#include "arrival-process.h"
+#include "dedup-window.h"
+#include "obstacle-loss-model.h"
+
+#include "ns3/application-container.h"
+#include "ns3/application.h"
+#include "ns3/energy-source-container.h"
+#include "ns3/event-id.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/tag.h"
+#include "ns3/vector.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Scenario-wide id of an uplink, carried as a packet tag from the sender
+ * application to the gateway trace sinks.
+ */
+class UniquePacketIdTag : public Tag
+{
+  public:
+    static TypeId GetTypeId();
+
+    UniquePacketIdTag();
+
+    /// @param id The packet id.
+    UniquePacketIdTag(uint32_t id);
+
+    TypeId GetInstanceTypeId() const override;
+    void Serialize(TagBuffer i) const override;
+    void Deserialize(TagBuffer i) override;
+    uint32_t GetSerializedSize() const override;
+    void Print(std::ostream& os) const override;
+
+    /// @param id The packet id.
+    void SetId(uint32_t id);
+
+    /// @return The packet id
+    uint32_t GetId() const;
+
+  private:
+    uint32_t m_id; //!< Packet id, 0 if unset
+};
+
+/**
+ * End-device application sending packets tagged with a UniquePacketIdTag,
+ * periodically or at the times drawn by an ArrivalProcess. Ids are unique
+ * over all the senders of the program and start at 1.
+ */
+class TaggingPeriodicSender : public Application
+{
+  public:
+    static TypeId GetTypeId();
+
+    TaggingPeriodicSender();
+
+    /**
+     * @param node The node of the application.
+     * @param device Its LoraNetDevice.
+     * @param period Time between two packets without an arrival process.
+     * @param packetSize Application payload size (bytes).
+     */
+    void Setup(Ptr<Node> node, Ptr<NetDevice> device, Time period, uint32_t packetSize);
+
+    /**
+     * Prepend a LoRaWAN MAC header with @p mType to every packet, as the
+     * confirmed-traffic scenarios do.
+     *
+     * @param mType Message type of the header.
+     */
+    void SetMacHeader(lorawan::LorawanMacHeader::MType mType);
+
+    /**
+     * @param enable Whether to tag every packet with the SF of the current data rate.
+     */
+    void SetSpreadingFactorTag(bool enable);
+
+    /// Change the period and send the next packet now
+    void SetPeriod(Time newPeriod);
+
+    /**
+     * Change the period and place the next send at @p phase from now.
+     *
+     * @param newPeriod The new period, also the new mean of the arrival process.
+     * @param phase Delay of the next packet.
+     */
+    void Rephase(Time newPeriod, Time phase);
+
+    /// @param arrivals Process drawing the inter-arrival times instead of the period.
+    void SetArrivalProcess(Ptr<ArrivalProcess> arrivals);
+
+    /// Send one extra packet without touching the regular schedule (event-triggered uplink)
+    void SendEventPacket();
+
+    /// @param packetSize Size of one packet sent on behalf of an external traffic source.
+    void SendExternalPacket(uint32_t packetSize);
+
+    /// @param selfScheduling Whether the application generates its own schedule.
+    void SetSelfScheduling(bool selfScheduling);
+
+    /// @return The number of packets handed to the MAC
+    uint32_t GetPacketsSent() const;
+
+    /// @return The PHY payload of one regular uplink (bytes): the application payload, the
+    ///         prepended MAC header if any and the 13 bytes of LoRaWAN headers the MAC adds
+    uint32_t GetUplinkSize() const;
+
+    /// @return The id of the last packet sent by any sender, 0 if none
+    static uint32_t GetLastPacketId();
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /// Schedule the next periodic packet
+    void ScheduleNextTx(Time delay);
+
+    /// Send the periodic packet and schedule the next one
+    void SendPacket();
+
+    /// @return Whether a packet of @p packetSize bytes was handed to the MAC
+    bool Transmit(uint32_t packetSize);
+
+    static uint32_t s_lastPacketId; //!< Last id handed out
+
+    Ptr<Node> m_node;                          //!< Node of the application
+    Ptr<NetDevice> m_device;                   //!< LoraNetDevice sending the packets
+    Time m_period;                             //!< Period without arrival process
+    uint32_t m_packetSize;                     //!< Payload size (bytes)
+    EventId m_sendEvent;                       //!< Next periodic packet
+    uint32_t m_packetsSent;                    //!< Packets handed to the MAC
+    Ptr<ArrivalProcess> m_arrivals;            //!< Optional arrival process
+    bool m_running;                            //!< Between start and stop
+    bool m_selfScheduling;                     //!< Whether the app schedules its packets
+    bool m_addMacHeader;                       //!< Whether to prepend m_mType
+    lorawan::LorawanMacHeader::MType m_mType;  //!< Message type of the prepended header
+    bool m_sfTag;                              //!< Whether to add a LoraTag with the SF
+};
+
+/**
+ * LoRa time on air (EU868 parameters).
+ *
+ * @param payloadSize PHY payload size (bytes).
+ * @param sf Spreading factor, 7 to 12; SF7 is used otherwise.
+ * @param bandwidthHz Bandwidth (Hz).
+ * @param codingRate Coding rate index, 1 for 4/5 to 4 for 4/8.
+ * @param crcEnabled Whether the payload CRC is on.
+ * @param headerEnabled Whether the explicit header is on.
+ * @param nPreamble Number of preamble symbols.
+ * @return The time on air (s), 0 if the parameters give an invalid value.
+ */
+double CalculateTimeOnAir(uint32_t payloadSize,
+                          uint8_t sf,
+                          double bandwidthHz = 125000.0,
+                          uint8_t codingRate = 1,
+                          bool crcEnabled = true,
+                          bool headerEnabled = true,
+                          uint8_t nPreamble = 8);
+
+/**
+ * Write the energy table of the end devices as a standalone LaTeX document.
+ *
+ * @param filename Output file.
+ * @param simDuration Simulated time (s).
+ * @param sources Energy sources of the end devices.
+ * @return Whether the file was written.
+ */
+bool WriteEnergyTex(const std::string& filename, double simDuration, const EnergySourceContainer& sources);
+
+/**
+ * Builder of the bridge topology: end devices along the deck, gateways,
+ * optional network server behind point-to-point links, energy models and
+ * the standard packet counters.
+ */
+class LoraBridgeScenario
+{
+  public:
+    /// Packets per SF and per node seen by the standard counters
+    struct PacketCounters
+    {
+        std::vector<uint64_t> sent = std::vector<uint64_t>(6, 0);     //!< Uplinks sent per SF 7..12
+        std::vector<uint64_t> received = std::vector<uint64_t>(6, 0); //!< Gateway receptions per SF 7..12
+        std::vector<uint64_t> receivedPerNode;                        //!< Distinct uplinks received per device
+        PacketSenderRing senders;                                     //!< Device index of the recent packet ids
+        DedupWindow unique;                                           //!< Packet ids received
+    };
+
+    /// Battery and radio currents of the end-device energy models
+    struct EnergyConfig
+    {
+        double initialEnergyJ = 10000.0;    //!< Energy of the source reserved for the radio (J)
+        double supplyVoltageV = 3.3;        //!< Supply voltage (V)
+        double standbyCurrentA = 0.0004;    //!< Standby current (A)
+        double txCurrentA = 0.090;          //!< Transmit current, constant over the TX power (A)
+        double rxCurrentA = 0.011;          //!< Receive current (A)
+        double sleepCurrentA = 0.0000015;   //!< Sleep current (A)
+    };
+
+    LoraBridgeScenario();
+
+    /// @param nDevices Number of end devices.
+    void SetEndDeviceCount(uint32_t nDevices);
+
+    /**
+     * Device i is placed at (i * spacing + 5, i % 2, height).
+     *
+     * @param spacing Distance between two devices along the deck (m).
+     * @param height Height of the devices (m).
+     */
+    void SetDeviceLayout(double spacing, double height);
+
+    /// @param position Position of one more gateway.
+    void AddGateway(Vector position);
+
+    /**
+     * Add a network server behind point-to-point links to the gateways.
+     *
+     * @param position Position of the server node.
+     */
+    void SetNetworkServer(Vector position);
+
+    /// @param obstacles Structure inserted between the path loss and the fading.
+    void SetObstacles(Ptr<ObstacleLossModel> obstacles);
+
+    /// @param fading Last model of the loss chain, instead of the default Nakagami fading.
+    void SetFadingModel(Ptr<PropagationLossModel> fading);
+
+    /**
+     * Start the senders at @p step * device index instead of uniformly at
+     * random within the first period.
+     *
+     * @param step Delay between the start of two consecutive devices.
+     */
+    void SetStaggeredStart(Time step);
+
+    /// Run all the build phases, the network server one if a position was set
+    void Build();
+
+    /// @return The channel: log-distance path loss (exponent 3.9), obstacles if set, Nakagami fading or the set one
+    Ptr<lorawan::LoraChannel> BuildChannel();
+
+    /**
+     * A deterministic copy of the path loss of the channel, without the
+     * obstacles and the fading, for mean receive power estimates. It leaves
+     * the random streams of the channel untouched.
+     *
+     * @return A log-distance model with the parameters of the channel's, once built
+     */
+    Ptr<PropagationLossModel> CreateMeanLossModel() const;
+
+    /// Create the end devices, the gateways and the server node and place them
+    void BuildNodes();
+
+    /// Install the LoRa PHY and MAC (EU region, class A end devices)
+    void BuildDevices();
+
+    /// @return The network server application, after the backhaul and the forwarders are installed
+    ApplicationContainer BuildNetworkServer();
+
+    /**
+     * Install one TaggingPeriodicSender per end device.
+     *
+     * @param period Time between two packets.
+     * @param packetSize Application payload size (bytes).
+     * @param stop Stop time of the senders.
+     * @return The senders, in device order.
+     */
+    ApplicationContainer InstallSenders(Time period, uint32_t packetSize, Time stop);
+
+    /// @param energy Battery and radio currents used by InstallEnergy().
+    void SetEnergyConfig(const EnergyConfig& energy);
+
+    /// @return The battery and radio currents of the energy models
+    const EnergyConfig& GetEnergyConfig() const;
+
+    /// @return The energy sources of the end devices, with the LoRa radio energy model installed
+    EnergySourceContainer InstallEnergy();
+
+    /// Assign the lowest SF each link supports (LorawanMacHelper::SetSpreadingFactorsUp)
+    void SetSpreadingFactorsUp();
+
+    /**
+     * Fix the RNG streams of the fading, the LoRa MACs and the sender start
+     * times, and draw the random start times again. Gives a built scenario
+     * the randomness of the current RngSeedManager run, as the replications
+     * of a ForkServer need.
+     *
+     * @param stream First stream index to use.
+     * @return The number of streams used.
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /// @return The SF of every end device, from its data rate
+    std::vector<uint8_t> GetSpreadingFactors() const;
+
+    /// Count uplinks sent and received per SF and per node in GetPacketCounters()
+    void ConnectPacketCounters();
+
+    /// Print the standard counters, with the SF of each node
+    void PrintPacketStats(std::ostream& os) const;
+
+    /// @return The standard counters
+    const PacketCounters& GetPacketCounters() const;
+
+    /// @return The channel, once built
+    Ptr<lorawan::LoraChannel> GetChannel() const;
+
+    /// @return The end devices
+    NodeContainer GetEndDevices() const;
+
+    /// @return The gateways
+    NodeContainer GetGateways() const;
+
+    /// @return The network server node, null without one
+    Ptr<Node> GetNetworkServer() const;
+
+    /// @return The LoraNetDevices of the end devices
+    NetDeviceContainer GetEndDeviceNetDevices() const;
+
+    /// @return The LoraNetDevices of the gateways
+    NetDeviceContainer GetGatewayNetDevices() const;
+
+  private:
+    /// Sink of the end-device StartSending trace
+    static void OnPhyStartSending(PacketCounters* counters, uint32_t device, Ptr<const Packet> packet, uint32_t phyIndex);
+
+    /// Sink of the gateway ReceivedPacket trace
+    static void OnPhyReceived(PacketCounters* counters, Ptr<const Packet> packet, uint32_t phyIndex);
+
+    uint32_t m_nDevices;                   //!< End devices
+    double m_spacing;                      //!< Device spacing along the deck (m)
+    double m_deviceHeight;                 //!< Device height (m)
+    std::vector<Vector> m_gatewayPositions; //!< Gateway positions
+    bool m_hasServer;                      //!< Whether a network server is built
+    Vector m_serverPosition;               //!< Network server position
+    Ptr<ObstacleLossModel> m_obstacles;    //!< Optional structure
+    Ptr<PropagationLossModel> m_fading;    //!< Fading model, null for the default Nakagami
+    Time m_startStep;                      //!< Staggered start step, zero for random starts
+    EnergyConfig m_energy;                 //!< Energy model parameters
+
+    Ptr<PropagationLossModel> m_loss;      //!< First model of the loss chain
+    Ptr<lorawan::LoraChannel> m_channel;   //!< Channel
+    NodeContainer m_endDevices;            //!< End devices
+    NodeContainer m_gateways;              //!< Gateways
+    Ptr<Node> m_server;                    //!< Network server node
+    NetDeviceContainer m_endDevicesNet;    //!< End-device LoraNetDevices
+    NetDeviceContainer m_gatewaysNet;      //!< Gateway LoraNetDevices
+    Ptr<UniformRandomVariable> m_startRv;  //!< Random start times of the senders
+    ApplicationContainer m_senders;        //!< Senders installed by InstallSenders()
+    PacketCounters m_counters;             //!< Standard counters
+};
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_SCENARIO_H */
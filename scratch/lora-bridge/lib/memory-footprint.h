@@ -0,0 +1,285 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Memory accounting of a scenario.
+//
+// Setup is measured, not estimated: the resident set size is sampled between
+// the setup phases and each growth is charged to the phase that caused it
+// (nodes, LoRa devices, applications, energy, ...), including everything the
+// ns-3 objects allocate internally. The scenario's own tracking structures
+// are estimated from their sizes, and the rest of the growth during the run
+// (mostly the event queue) is reported as a residual.
+//
+// Phases marked per-device give the bytes-per-device figure used to project
+// the footprint of larger fleets. RSS deltas are coarse (pages, allocator
+// reuse): the figures are meaningful for fleets of a few hundred devices and
+// up. Where /proc/self/statm is unavailable all measured figures are zero.
+
+#ifndef LORA_BRIDGE_MEMORY_FOOTPRINT_H
+#define LORA_BRIDGE_MEMORY_FOOTPRINT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Attribution of the process memory to scenario categories.
+ */
+class MemoryFootprint
+{
+  public:
+    MemoryFootprint();
+
+    /// @return The resident set size of the process (bytes), 0 if unknown
+    static uint64_t GetResidentBytes();
+
+    /// Start the attribution: what is resident now is the fixed baseline
+    void Start();
+
+    /**
+     * Charge the RSS growth since the previous mark to a setup category.
+     *
+     * @param category Category name.
+     * @param perDevice Whether the category scales with the number of devices.
+     */
+    void Mark(const std::string& category, bool perDevice);
+
+    /**
+     * @param nDevices Number of end devices the per-device categories cover.
+     */
+    void SetDeviceCount(uint32_t nDevices);
+
+    /**
+     * Set the estimated size of a tracking structure of the scenario.
+     *
+     * @param name Structure name.
+     * @param bytes Estimated heap bytes.
+     */
+    void SetTracked(const std::string& name, uint64_t bytes);
+
+    /// @return The setup bytes of the per-device categories divided by the device count
+    double GetBytesPerDevice() const;
+
+    /**
+     * Print the footprint and its projection to larger fleets. The tracking
+     * structures and the run residual are assumed to grow with the traffic,
+     * hence with the fleet, at the current run length.
+     *
+     * @param os Output stream.
+     * @param label When the report is taken, e.g. "after setup".
+     * @param fleets Fleet sizes to project to.
+     */
+    void Report(std::ostream& os, const std::string& label, const std::vector<uint32_t>& fleets) const;
+
+    /// @return The estimated heap bytes of @p v
+    template <typename T>
+    static uint64_t EstimateBytes(const std::vector<T>& v);
+
+    /// @return The estimated heap bytes of @p m
+    template <typename K, typename V>
+    static uint64_t EstimateBytes(const std::map<K, V>& m);
+
+    /// @return The estimated heap bytes of @p s
+    template <typename K>
+    static uint64_t EstimateBytes(const std::unordered_set<K>& s);
+
+    /// @return The estimated heap bytes of @p m
+    template <typename K, typename V>
+    static uint64_t EstimateBytes(const std::unordered_map<K, V>& m);
+
+  private:
+    /// One measured setup category
+    struct Category
+    {
+        std::string name; //!< Category name
+        int64_t bytes;    //!< RSS growth charged to it
+        bool perDevice;   //!< Whether it scales with the fleet
+    };
+
+    /// @return The size of a heap block holding @p payload bytes (glibc malloc)
+    static uint64_t HeapBlock(uint64_t payload);
+
+    uint64_t m_baseline;                           //!< RSS at Start()
+    uint64_t m_lastMark;                           //!< RSS at the last mark
+    uint32_t m_devices;                            //!< Devices of the per-device categories
+    std::vector<Category> m_categories;            //!< Setup categories, in order
+    std::vector<std::pair<std::string, uint64_t>> m_tracked; //!< Tracking structures
+};
+
+inline MemoryFootprint::MemoryFootprint()
+    : m_baseline(0),
+      m_lastMark(0),
+      m_devices(0)
+{
+}
+
+inline uint64_t
+MemoryFootprint::GetResidentBytes()
+{
+    // statm: size resident shared text lib data dt, in pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (!(statm >> size >> resident))
+    {
+        return 0;
+    }
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+inline void
+MemoryFootprint::Start()
+{
+    m_baseline = GetResidentBytes();
+    m_lastMark = m_baseline;
+    m_categories.clear();
+}
+
+inline void
+MemoryFootprint::Mark(const std::string& category, bool perDevice)
+{
+    uint64_t now = GetResidentBytes();
+    m_categories.push_back({category, static_cast<int64_t>(now) - static_cast<int64_t>(m_lastMark), perDevice});
+    m_lastMark = now;
+}
+
+inline void
+MemoryFootprint::SetDeviceCount(uint32_t nDevices)
+{
+    m_devices = nDevices;
+}
+
+inline void
+MemoryFootprint::SetTracked(const std::string& name, uint64_t bytes)
+{
+    for (auto& tracked : m_tracked)
+    {
+        if (tracked.first == name)
+        {
+            tracked.second = bytes;
+            return;
+        }
+    }
+    m_tracked.emplace_back(name, bytes);
+}
+
+inline double
+MemoryFootprint::GetBytesPerDevice() const
+{
+    int64_t bytes = 0;
+    for (const auto& category : m_categories)
+    {
+        if (category.perDevice)
+        {
+            bytes += category.bytes;
+        }
+    }
+    return m_devices > 0 ? static_cast<double>(std::max<int64_t>(bytes, 0)) / m_devices : 0.0;
+}
+
+inline void
+MemoryFootprint::Report(std::ostream& os,
+                        const std::string& label,
+                        const std::vector<uint32_t>& fleets) const
+{
+    const double MiB = 1024.0 * 1024.0;
+    uint64_t resident = GetResidentBytes();
+    int64_t fixed = 0;
+    int64_t perDevice = 0;
+    uint64_t tracked = 0;
+
+    os << "================= MEMORY FOOTPRINT (" << label << ") =================\n";
+    os << std::fixed << std::setprecision(2);
+    os << std::left << std::setw(36) << "Baseline (ns-3, libraries)" << m_baseline / MiB << " MiB\n";
+    for (const auto& category : m_categories)
+    {
+        os << std::setw(36) << category.name << category.bytes / MiB << " MiB";
+        if (category.perDevice && m_devices > 0)
+        {
+            os << " (" << static_cast<double>(category.bytes) / m_devices << " B/device)";
+        }
+        os << "\n";
+        (category.perDevice ? perDevice : fixed) += category.bytes;
+    }
+    for (const auto& structure : m_tracked)
+    {
+        os << std::setw(36) << ("Tracking: " + structure.first) << structure.second / MiB << " MiB\n";
+        tracked += structure.second;
+    }
+    int64_t residual = static_cast<int64_t>(resident) - static_cast<int64_t>(m_lastMark) -
+                       static_cast<int64_t>(tracked);
+    os << std::setw(36) << "Event queue and other run growth" << std::max<int64_t>(residual, 0) / MiB
+       << " MiB\n";
+    os << std::setw(36) << "Resident total" << resident / MiB << " MiB\n";
+
+    if (m_devices > 0)
+    {
+        double scaling = (perDevice + static_cast<double>(tracked) + std::max<int64_t>(residual, 0)) /
+                         m_devices;
+        os << "Setup: " << GetBytesPerDevice() << " B/device, with tracking and run growth: "
+           << scaling << " B/device\n";
+        for (uint32_t fleet : fleets)
+        {
+            double projected = m_baseline + fixed + scaling * fleet;
+            os << "  " << fleet << " devices: ~" << projected / MiB << " MiB\n";
+        }
+    }
+    os << std::defaultfloat;
+    os << "==============================================================\n";
+}
+
+inline uint64_t
+MemoryFootprint::HeapBlock(uint64_t payload)
+{
+    // 8 bytes of chunk header, 16-byte alignment, 32-byte minimum chunk
+    return std::max<uint64_t>(32, (payload + 8 + 15) & ~uint64_t(15));
+}
+
+template <typename T>
+uint64_t
+MemoryFootprint::EstimateBytes(const std::vector<T>& v)
+{
+    return v.capacity() > 0 ? HeapBlock(v.capacity() * sizeof(T)) : 0;
+}
+
+template <typename K, typename V>
+uint64_t
+MemoryFootprint::EstimateBytes(const std::map<K, V>& m)
+{
+    // Red-black tree node: colour and three links, then the value
+    return m.size() * HeapBlock(4 * sizeof(void*) + sizeof(std::pair<const K, V>));
+}
+
+template <typename K>
+uint64_t
+MemoryFootprint::EstimateBytes(const std::unordered_set<K>& s)
+{
+    // Singly linked node (link, value, cached hash) plus the bucket array
+    return s.size() * HeapBlock(sizeof(void*) + sizeof(K) + sizeof(size_t)) +
+           HeapBlock(s.bucket_count() * sizeof(void*));
+}
+
+template <typename K, typename V>
+uint64_t
+MemoryFootprint::EstimateBytes(const std::unordered_map<K, V>& m)
+{
+    return m.size() * HeapBlock(sizeof(void*) + sizeof(std::pair<const K, V>) + sizeof(size_t)) +
+           HeapBlock(m.bucket_count() * sizeof(void*));
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_MEMORY_FOOTPRINT_H */
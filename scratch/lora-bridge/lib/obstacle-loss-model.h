@@ -0,0 +1,255 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Obstruction loss from the bridge structure.
+//
+// The structure (deck, girders, pylons, ...) is described as axis-aligned
+// boxes, each with the loss in dB of a link going through it. The loss of a
+// link is the sum over the boxes its straight line crosses, capped at
+// MaxLoss. The model adds that loss to the receive power computed by the
+// models before it in the chain; put it between the path loss and the fading.
+//
+// Ray tests cost O(boxes) per link, far more than the log-distance model, so
+// every link keeps its obstruction loss in a cache keyed by its two mobility
+// models. An entry holds the end positions it was computed for and is only
+// recomputed when one of them has moved, so static links are ray-tested once
+// for the whole run.
+
+#ifndef LORA_BRIDGE_OBSTACLE_LOSS_MODEL_H
+#define LORA_BRIDGE_OBSTACLE_LOSS_MODEL_H
+
+#include "ns3/double.h"
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Propagation loss of the obstacles a link crosses, cached per link.
+ */
+class ObstacleLossModel : public PropagationLossModel
+{
+  public:
+    static TypeId GetTypeId();
+
+    ObstacleLossModel();
+
+    /**
+     * Add an obstacle; the cached losses are dropped.
+     *
+     * @param name Obstacle name, for the logs.
+     * @param min Corner with the lowest coordinates (m).
+     * @param max Corner with the highest coordinates (m).
+     * @param lossDb Loss of a link crossing the obstacle (dB).
+     */
+    void AddObstacle(const std::string& name, Vector min, Vector max, double lossDb);
+
+    /// @return The number of obstacles
+    uint32_t GetObstacleCount() const;
+
+    /**
+     * @param a One end of the link.
+     * @param b The other end.
+     * @return The obstruction loss of the link (dB), without using the cache.
+     */
+    double GetObstructionLoss(Vector a, Vector b) const;
+
+    /// @return The number of links in the cache
+    uint64_t GetCachedLinkCount() const;
+
+    /// @return The number of losses computed by ray tests
+    uint64_t GetRayTestCount() const;
+
+    /// @return The number of losses taken from the cache
+    uint64_t GetCacheHitCount() const;
+
+  private:
+    double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /// One box of the structure
+    struct Obstacle
+    {
+        std::string name; //!< Obstacle name
+        Vector min;       //!< Lowest corner (m)
+        Vector max;       //!< Highest corner (m)
+        double lossDb;    //!< Loss of a crossing link (dB)
+    };
+
+    /// Obstruction loss of one link, for the end positions it was computed for
+    struct Link
+    {
+        Vector a;      //!< Position of the first end
+        Vector b;      //!< Position of the second end
+        double lossDb; //!< Obstruction loss (dB)
+    };
+
+    /// Hash of an unordered pair of mobility models
+    struct LinkHash
+    {
+        size_t operator()(const std::pair<const MobilityModel*, const MobilityModel*>& link) const
+        {
+            return std::hash<const void*>()(link.first) * 31 + std::hash<const void*>()(link.second);
+        }
+    };
+
+    /// @return Whether the segment from @p a to @p b crosses @p obstacle
+    static bool Crosses(const Obstacle& obstacle, const Vector& a, const Vector& b);
+
+    /// Cache of the link losses, keyed by the mobility models of the two ends, lowest address first
+    typedef std::unordered_map<std::pair<const MobilityModel*, const MobilityModel*>, Link, LinkHash> LinkCache;
+
+    double m_maxLoss;                  //!< Cap of the summed loss (dB)
+    std::vector<Obstacle> m_obstacles; //!< The structure
+    mutable LinkCache m_cache;         //!< Loss per link
+    mutable uint64_t m_rayTests;       //!< Losses computed
+    mutable uint64_t m_cacheHits;      //!< Losses reused
+};
+
+inline TypeId
+ObstacleLossModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::ObstacleLossModel")
+                            .SetParent<PropagationLossModel>()
+                            .SetGroupName("LoraBridge")
+                            .AddConstructor<ObstacleLossModel>()
+                            .AddAttribute("MaxLoss",
+                                          "Largest obstruction loss of a link (dB)",
+                                          DoubleValue(60.0),
+                                          MakeDoubleAccessor(&ObstacleLossModel::m_maxLoss),
+                                          MakeDoubleChecker<double>(0.0));
+    return tid;
+}
+
+inline ObstacleLossModel::ObstacleLossModel()
+    : m_maxLoss(60.0),
+      m_rayTests(0),
+      m_cacheHits(0)
+{
+}
+
+inline void
+ObstacleLossModel::AddObstacle(const std::string& name, Vector min, Vector max, double lossDb)
+{
+    m_obstacles.push_back({name,
+                           Vector(std::min(min.x, max.x), std::min(min.y, max.y), std::min(min.z, max.z)),
+                           Vector(std::max(min.x, max.x), std::max(min.y, max.y), std::max(min.z, max.z)),
+                           lossDb});
+    m_cache.clear();
+}
+
+inline uint32_t
+ObstacleLossModel::GetObstacleCount() const
+{
+    return m_obstacles.size();
+}
+
+inline double
+ObstacleLossModel::GetObstructionLoss(Vector a, Vector b) const
+{
+    double loss = 0.0;
+    for (const auto& obstacle : m_obstacles)
+    {
+        if (Crosses(obstacle, a, b))
+        {
+            loss += obstacle.lossDb;
+        }
+    }
+    return std::min(loss, m_maxLoss);
+}
+
+inline uint64_t
+ObstacleLossModel::GetCachedLinkCount() const
+{
+    return m_cache.size();
+}
+
+inline uint64_t
+ObstacleLossModel::GetRayTestCount() const
+{
+    return m_rayTests;
+}
+
+inline uint64_t
+ObstacleLossModel::GetCacheHitCount() const
+{
+    return m_cacheHits;
+}
+
+inline double
+ObstacleLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+    // The loss is symmetric: both directions share one entry
+    const MobilityModel* first = PeekPointer(a);
+    const MobilityModel* second = PeekPointer(b);
+    Vector posA = a->GetPosition();
+    Vector posB = b->GetPosition();
+    if (second < first)
+    {
+        std::swap(first, second);
+        std::swap(posA, posB);
+    }
+    auto it = m_cache.find({first, second});
+    if (it != m_cache.end() && it->second.a == posA && it->second.b == posB)
+    {
+        m_cacheHits++;
+        return txPowerDbm - it->second.lossDb;
+    }
+    double lossDb = GetObstructionLoss(posA, posB);
+    m_rayTests++;
+    m_cache[{first, second}] = {posA, posB, lossDb};
+    return txPowerDbm - lossDb;
+}
+
+inline int64_t
+ObstacleLossModel::DoAssignStreams(int64_t /* stream */)
+{
+    return 0;
+}
+
+inline bool
+ObstacleLossModel::Crosses(const Obstacle& obstacle, const Vector& a, const Vector& b)
+{
+    // Slab test: clip the segment a + t (b - a), t in [0, 1], against each pair of faces
+    double lower = 0.0;
+    double upper = 1.0;
+    const double start[3] = {a.x, a.y, a.z};
+    const double delta[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+    const double low[3] = {obstacle.min.x, obstacle.min.y, obstacle.min.z};
+    const double high[3] = {obstacle.max.x, obstacle.max.y, obstacle.max.z};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (std::abs(delta[axis]) < 1e-12)
+        {
+            if (start[axis] < low[axis] || start[axis] > high[axis])
+            {
+                return false;
+            }
+            continue;
+        }
+        double t0 = (low[axis] - start[axis]) / delta[axis];
+        double t1 = (high[axis] - start[axis]) / delta[axis];
+        lower = std::max(lower, std::min(t0, t1));
+        upper = std::min(upper, std::max(t0, t1));
+        if (lower > upper)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_OBSTACLE_LOSS_MODEL_H */
@@ -0,0 +1,183 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Runtime reconfiguration of the reporting periods.
+//
+// A piecewise schedule assigns a new period to a device group at a given time.
+// Instead of restarting every device at the change instant, each device gets a
+// phase offset inside the new period (random or slotted), so the fleet stays
+// desynchronised. One scheduler event per change rephases the whole group at
+// the change instant: from then on no device sends on the old period, and
+// each one only has its first send of the new period scheduled.
+
+#ifndef LORA_BRIDGE_PERIOD_RECONFIGURATOR_H
+#define LORA_BRIDGE_PERIOD_RECONFIGURATOR_H
+
+#include "ns3/callback.h"
+#include "ns3/enum.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Applies a piecewise, per-group schedule of reporting periods.
+ */
+class PeriodReconfigurator : public Object
+{
+  public:
+    /// How the first send after a change is placed inside the new period
+    enum RephaseMode
+    {
+        REPHASE_RANDOM,  //!< Uniform random offset in [0, period)
+        REPHASE_SLOTTED, //!< Device k of the n registered, all groups together, sends at k * period / n
+    };
+
+    static TypeId GetTypeId();
+
+    PeriodReconfigurator();
+
+    /**
+     * Callback used to rephase one device: device index, new period, and the
+     * delay from now until its next send.
+     */
+    typedef Callback<void, uint32_t, Time, Time> RephaseCallback;
+
+    /**
+     * @param index The device index passed back to the rephase callback.
+     * @param group The group the device belongs to.
+     */
+    void AddDevice(uint32_t index, uint32_t group);
+
+    /**
+     * Add a step to the schedule.
+     *
+     * @param at When the new period takes effect.
+     * @param group The device group affected.
+     * @param period The new reporting period.
+     */
+    void AddChange(Time at, uint32_t group, Time period);
+
+    /**
+     * @param rephase The callback applying a period and phase to a device.
+     */
+    void SetRephaseCallback(RephaseCallback rephase);
+
+    /**
+     * Schedule all the changes added so far.
+     */
+    void Start();
+
+    int64_t AssignStreams(int64_t stream);
+
+  private:
+    /// One step of the schedule
+    struct Change
+    {
+        Time at;        //!< Activation time
+        uint32_t group; //!< Affected group
+        Time period;    //!< New period
+    };
+
+    /// Rephase the devices of the group of change @p c
+    void Apply(size_t c);
+
+    RephaseMode m_mode;                 //!< Placement of the first send
+    std::vector<uint32_t> m_devices;    //!< Registered device indices
+    std::vector<uint32_t> m_groups;     //!< Group of each registered device
+    std::vector<Change> m_changes;      //!< The schedule
+    RephaseCallback m_rephase;          //!< Applies period and phase to a device
+    Ptr<UniformRandomVariable> m_uniform; //!< Random phase draws
+};
+
+inline TypeId
+PeriodReconfigurator::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PeriodReconfigurator")
+            .SetParent<Object>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<PeriodReconfigurator>()
+            .AddAttribute("RephaseMode",
+                          "Placement of the first send after a period change",
+                          EnumValue(PeriodReconfigurator::REPHASE_RANDOM),
+                          MakeEnumAccessor<RephaseMode>(&PeriodReconfigurator::m_mode),
+                          MakeEnumChecker(PeriodReconfigurator::REPHASE_RANDOM,
+                                          "Random",
+                                          PeriodReconfigurator::REPHASE_SLOTTED,
+                                          "Slotted"));
+    return tid;
+}
+
+inline PeriodReconfigurator::PeriodReconfigurator()
+    : m_mode(REPHASE_RANDOM),
+      m_uniform(CreateObject<UniformRandomVariable>())
+{
+}
+
+inline void
+PeriodReconfigurator::AddDevice(uint32_t index, uint32_t group)
+{
+    m_devices.push_back(index);
+    m_groups.push_back(group);
+}
+
+inline void
+PeriodReconfigurator::AddChange(Time at, uint32_t group, Time period)
+{
+    m_changes.push_back({at, group, period});
+}
+
+inline void
+PeriodReconfigurator::SetRephaseCallback(RephaseCallback rephase)
+{
+    m_rephase = rephase;
+}
+
+inline void
+PeriodReconfigurator::Start()
+{
+    for (size_t c = 0; c < m_changes.size(); ++c)
+    {
+        Simulator::Schedule(m_changes[c].at - Simulator::Now(), &PeriodReconfigurator::Apply, this, c);
+    }
+}
+
+inline int64_t
+PeriodReconfigurator::AssignStreams(int64_t stream)
+{
+    m_uniform->SetStream(stream);
+    return 1;
+}
+
+inline void
+PeriodReconfigurator::Apply(size_t c)
+{
+    const Change& change = m_changes[c];
+    // Slots are numbered over all the registered devices: groups changing at the same time
+    // interleave instead of all starting at offset 0
+    double period = change.period.GetSeconds();
+    for (size_t i = 0; i < m_devices.size(); ++i)
+    {
+        if (m_groups[i] != change.group)
+        {
+            continue;
+        }
+        double offset = (m_mode == REPHASE_SLOTTED) ? i * period / m_devices.size()
+                                                    : m_uniform->GetValue(0, period);
+        if (!m_rephase.IsNull())
+        {
+            m_rephase(m_devices[i], change.period, Seconds(offset));
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_PERIOD_RECONFIGURATOR_H */
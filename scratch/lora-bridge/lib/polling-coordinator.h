@@ -0,0 +1,564 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// TDMA-style polling over the wired bridge backbone.
+//
+// PollingCoordinator runs on the gateway and polls every registered node in
+// turn: one outstanding poll at a time, the next slot opening a guard time
+// after the response (or after a timeout). When every node has been polled
+// the cycle is over; the next one starts one cycle time after the previous
+// start. In adaptive mode the cycle time follows the measured busy time of
+// the last cycle plus a headroom, within [MinCycle, MaxCycle]. PollResponder
+// runs on the sensor nodes and answers each poll with a fixed-size response
+// echoing the cycle and slot numbers.
+
+#ifndef LORA_BRIDGE_POLLING_COORDINATOR_H
+#define LORA_BRIDGE_POLLING_COORDINATOR_H
+
+#include "ns3/application.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace ns3
+{
+
+/// Write @p value big-endian at @p buffer
+inline void
+PollWriteU32(uint8_t* buffer, uint32_t value)
+{
+    buffer[0] = value >> 24;
+    buffer[1] = value >> 16;
+    buffer[2] = value >> 8;
+    buffer[3] = value;
+}
+
+/// @return The big-endian value at @p buffer
+inline uint32_t
+PollReadU32(const uint8_t* buffer)
+{
+    return (uint32_t(buffer[0]) << 24) | (uint32_t(buffer[1]) << 16) | (uint32_t(buffer[2]) << 8) |
+           buffer[3];
+}
+
+/**
+ * Sensor-side application answering the polls of a PollingCoordinator.
+ */
+class PollResponder : public Application
+{
+  public:
+    static TypeId GetTypeId();
+
+    PollResponder();
+
+    /// @return The number of polls answered
+    uint64_t GetResponseCount() const;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /// Answer every poll waiting on the socket
+    void HandleRead(Ptr<Socket> socket);
+
+    uint16_t m_port;         //!< Port polls arrive on
+    uint32_t m_responseSize; //!< Response payload size (bytes)
+    Ptr<Socket> m_socket;    //!< Listening socket
+    uint64_t m_responses;    //!< Polls answered
+};
+
+/**
+ * Gateway-side application polling a set of nodes in TDMA cycles.
+ */
+class PollingCoordinator : public Application
+{
+  public:
+    /// Per-node polling statistics
+    struct NodeStats
+    {
+        uint64_t polls = 0;        //!< Polls sent
+        uint64_t responses = 0;    //!< Responses received in time
+        uint64_t timeouts = 0;     //!< Polls left unanswered
+        double latencySum = 0.0;   //!< Sum of poll-to-response latencies (s)
+        double latencyMax = 0.0;   //!< Largest latency (s)
+
+        /// @return The mean poll-to-response latency (s)
+        double GetMeanLatency() const;
+    };
+
+    static TypeId GetTypeId();
+
+    PollingCoordinator();
+
+    /**
+     * @param address The address of a node to poll; nodes are polled in the
+     *        order they are added.
+     */
+    void AddNode(Ipv4Address address);
+
+    /// @return The statistics of the node added in position @p index
+    const NodeStats& GetNodeStats(uint32_t index) const;
+
+    /// @return The number of polled nodes
+    uint32_t GetNodeCount() const;
+
+    /// @return The number of completed cycles
+    uint64_t GetCycleCount() const;
+
+    /// @return The number of cycles whose polls did not fit in the cycle time
+    uint64_t GetOverrunCount() const;
+
+    /// @return The cycle time currently in use
+    Time GetCycleTime() const;
+
+    /// @return The mean time the polls of a cycle took (s)
+    double GetMeanBusyTime() const;
+
+    /// @return The largest time the polls of a cycle took (s)
+    double GetMaxBusyTime() const;
+
+    /// @return The mean delay of cycle starts behind their nominal time (s)
+    double GetMeanCycleJitter() const;
+
+    /// @return The largest delay of a cycle start behind its nominal time (s)
+    double GetMaxCycleJitter() const;
+
+    /// @return The standard deviation of the intervals between cycle starts (s)
+    double GetCyclePeriodStdDev() const;
+
+    /// @return Responses received per second since the first cycle
+    double GetResponseRate() const;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /// Start a cycle at slot 0
+    void StartCycle();
+
+    /// Poll the node of the current slot
+    void PollSlot();
+
+    /// Handle a response
+    void HandleRead(Ptr<Socket> socket);
+
+    /// The poll of the current slot went unanswered
+    void Timeout();
+
+    /// Move to the next slot after the guard time, or close the cycle
+    void NextSlot();
+
+    /// Close the cycle and schedule the next one
+    void EndCycle();
+
+    uint16_t m_port;              //!< Port of the responders
+    uint32_t m_pollSize;          //!< Poll payload size (bytes)
+    Time m_minCycle;              //!< Shortest cycle time, also the fixed cycle time
+    Time m_maxCycle;              //!< Longest adaptive cycle time
+    Time m_guard;                 //!< Gap between a response and the next poll
+    Time m_timeout;               //!< Time to wait for a response
+    bool m_adaptive;              //!< Whether the cycle time follows the busy time
+    double m_headroom;            //!< Fraction added to the busy time in adaptive mode
+
+    Ptr<Socket> m_socket;            //!< Socket polls are sent from
+    std::vector<Ipv4Address> m_nodes; //!< Polled nodes
+    std::vector<NodeStats> m_stats;  //!< Statistics of each node
+    Time m_cycleTime;                //!< Current cycle time
+    Time m_nominalStart;             //!< When the current cycle should have started
+    Time m_cycleStart;               //!< When the current cycle started
+    Time m_firstStart;               //!< When the first cycle started
+    Time m_pollSent;                 //!< When the current poll was sent
+    uint32_t m_cycle;                //!< Current cycle number
+    uint32_t m_slot;                 //!< Current slot
+    EventId m_event;                 //!< Pending slot, timeout or cycle event
+
+    uint64_t m_cycles;          //!< Completed cycles
+    uint64_t m_overruns;        //!< Cycles longer than their cycle time
+    double m_busySum;           //!< Sum of cycle busy times (s)
+    double m_busyMax;           //!< Largest cycle busy time (s)
+    double m_jitterSum;         //!< Sum of cycle start delays (s)
+    double m_jitterMax;         //!< Largest cycle start delay (s)
+    double m_periodSum;         //!< Sum of intervals between cycle starts (s)
+    double m_periodSquareSum;   //!< Sum of squared intervals (s^2)
+    uint64_t m_periods;         //!< Number of intervals
+    uint64_t m_responses;       //!< Responses received in time
+};
+
+inline TypeId
+PollResponder::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::PollResponder")
+                            .SetParent<Application>()
+                            .SetGroupName("LoraBridge")
+                            .AddConstructor<PollResponder>()
+                            .AddAttribute("Port",
+                                          "Port polls arrive on",
+                                          UintegerValue(9),
+                                          MakeUintegerAccessor(&PollResponder::m_port),
+                                          MakeUintegerChecker<uint16_t>())
+                            .AddAttribute("ResponseSize",
+                                          "Response payload size in bytes (at least 8)",
+                                          UintegerValue(1024),
+                                          MakeUintegerAccessor(&PollResponder::m_responseSize),
+                                          MakeUintegerChecker<uint32_t>(8));
+    return tid;
+}
+
+inline PollResponder::PollResponder()
+    : m_port(9),
+      m_responseSize(1024),
+      m_responses(0)
+{
+}
+
+inline uint64_t
+PollResponder::GetResponseCount() const
+{
+    return m_responses;
+}
+
+inline void
+PollResponder::StartApplication()
+{
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port));
+    }
+    m_socket->SetRecvCallback(MakeCallback(&PollResponder::HandleRead, this));
+}
+
+inline void
+PollResponder::StopApplication()
+{
+    if (m_socket)
+    {
+        m_socket->Close();
+        m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        m_socket = nullptr;
+    }
+}
+
+inline void
+PollResponder::HandleRead(Ptr<Socket> socket)
+{
+    Address from;
+    Ptr<Packet> poll;
+    while ((poll = socket->RecvFrom(from)))
+    {
+        // Echo the cycle and slot numbers so the coordinator can match the response
+        std::vector<uint8_t> payload(m_responseSize, 0);
+        poll->CopyData(payload.data(), 8);
+        socket->SendTo(Create<Packet>(payload.data(), payload.size()), 0, from);
+        m_responses++;
+    }
+}
+
+inline double
+PollingCoordinator::NodeStats::GetMeanLatency() const
+{
+    return responses ? latencySum / responses : 0.0;
+}
+
+inline TypeId
+PollingCoordinator::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PollingCoordinator")
+            .SetParent<Application>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<PollingCoordinator>()
+            .AddAttribute("Port",
+                          "Port of the responders",
+                          UintegerValue(9),
+                          MakeUintegerAccessor(&PollingCoordinator::m_port),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("PollSize",
+                          "Poll payload size in bytes (at least 8)",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&PollingCoordinator::m_pollSize),
+                          MakeUintegerChecker<uint32_t>(8))
+            .AddAttribute("MinCycle",
+                          "Shortest cycle time; the cycle time when Adaptive is false",
+                          TimeValue(Seconds(7)),
+                          MakeTimeAccessor(&PollingCoordinator::m_minCycle),
+                          MakeTimeChecker())
+            .AddAttribute("MaxCycle",
+                          "Longest cycle time in adaptive mode",
+                          TimeValue(Seconds(60)),
+                          MakeTimeAccessor(&PollingCoordinator::m_maxCycle),
+                          MakeTimeChecker())
+            .AddAttribute("Guard",
+                          "Gap between a response and the next poll",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&PollingCoordinator::m_guard),
+                          MakeTimeChecker())
+            .AddAttribute("Timeout",
+                          "Time to wait for a response before moving on",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&PollingCoordinator::m_timeout),
+                          MakeTimeChecker())
+            .AddAttribute("Adaptive",
+                          "Whether the cycle time follows the measured busy time",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&PollingCoordinator::m_adaptive),
+                          MakeBooleanChecker())
+            .AddAttribute("Headroom",
+                          "Fraction of the busy time added to it in adaptive mode",
+                          DoubleValue(0.2),
+                          MakeDoubleAccessor(&PollingCoordinator::m_headroom),
+                          MakeDoubleChecker<double>(0.0));
+    return tid;
+}
+
+inline PollingCoordinator::PollingCoordinator()
+    : m_port(9),
+      m_pollSize(1024),
+      m_minCycle(Seconds(7)),
+      m_maxCycle(Seconds(60)),
+      m_guard(MilliSeconds(1)),
+      m_timeout(MilliSeconds(100)),
+      m_adaptive(false),
+      m_headroom(0.2),
+      m_cycle(0),
+      m_slot(0),
+      m_cycles(0),
+      m_overruns(0),
+      m_busySum(0.0),
+      m_busyMax(0.0),
+      m_jitterSum(0.0),
+      m_jitterMax(0.0),
+      m_periodSum(0.0),
+      m_periodSquareSum(0.0),
+      m_periods(0),
+      m_responses(0)
+{
+}
+
+inline void
+PollingCoordinator::AddNode(Ipv4Address address)
+{
+    m_nodes.push_back(address);
+    m_stats.emplace_back();
+}
+
+inline const PollingCoordinator::NodeStats&
+PollingCoordinator::GetNodeStats(uint32_t index) const
+{
+    return m_stats.at(index);
+}
+
+inline uint32_t
+PollingCoordinator::GetNodeCount() const
+{
+    return m_nodes.size();
+}
+
+inline uint64_t
+PollingCoordinator::GetCycleCount() const
+{
+    return m_cycles;
+}
+
+inline uint64_t
+PollingCoordinator::GetOverrunCount() const
+{
+    return m_overruns;
+}
+
+inline Time
+PollingCoordinator::GetCycleTime() const
+{
+    return m_cycleTime;
+}
+
+inline double
+PollingCoordinator::GetMeanBusyTime() const
+{
+    return m_cycles ? m_busySum / m_cycles : 0.0;
+}
+
+inline double
+PollingCoordinator::GetMaxBusyTime() const
+{
+    return m_busyMax;
+}
+
+inline double
+PollingCoordinator::GetMeanCycleJitter() const
+{
+    return m_periods ? m_jitterSum / m_periods : 0.0;
+}
+
+inline double
+PollingCoordinator::GetMaxCycleJitter() const
+{
+    return m_jitterMax;
+}
+
+inline double
+PollingCoordinator::GetCyclePeriodStdDev() const
+{
+    if (m_periods < 2)
+    {
+        return 0.0;
+    }
+    double mean = m_periodSum / m_periods;
+    return std::sqrt(std::max(0.0, m_periodSquareSum / m_periods - mean * mean));
+}
+
+inline double
+PollingCoordinator::GetResponseRate() const
+{
+    double elapsed = (Simulator::Now() - m_firstStart).GetSeconds();
+    return elapsed > 0 ? m_responses / elapsed : 0.0;
+}
+
+inline void
+PollingCoordinator::StartApplication()
+{
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        m_socket->Bind();
+    }
+    m_socket->SetRecvCallback(MakeCallback(&PollingCoordinator::HandleRead, this));
+    m_cycleTime = m_minCycle;
+    m_firstStart = Simulator::Now();
+    m_nominalStart = Simulator::Now();
+    StartCycle();
+}
+
+inline void
+PollingCoordinator::StopApplication()
+{
+    Simulator::Cancel(m_event);
+    if (m_socket)
+    {
+        m_socket->Close();
+        m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        m_socket = nullptr;
+    }
+}
+
+inline void
+PollingCoordinator::StartCycle()
+{
+    Time now = Simulator::Now();
+    if (m_cycle > 0)
+    {
+        double period = (now - m_cycleStart).GetSeconds();
+        double late = (now - m_nominalStart).GetSeconds();
+        m_periodSum += period;
+        m_periodSquareSum += period * period;
+        m_periods++;
+        m_jitterSum += late;
+        m_jitterMax = std::max(m_jitterMax, late);
+    }
+    m_cycleStart = now;
+    m_cycle++;
+    m_slot = 0;
+    if (m_nodes.empty())
+    {
+        EndCycle();
+        return;
+    }
+    PollSlot();
+}
+
+inline void
+PollingCoordinator::PollSlot()
+{
+    std::vector<uint8_t> payload(m_pollSize, 0);
+    PollWriteU32(payload.data(), m_cycle);
+    PollWriteU32(payload.data() + 4, m_slot);
+    m_pollSent = Simulator::Now();
+    m_socket->SendTo(Create<Packet>(payload.data(), payload.size()),
+                     0,
+                     InetSocketAddress(m_nodes[m_slot], m_port));
+    m_stats[m_slot].polls++;
+    m_event = Simulator::Schedule(m_timeout, &PollingCoordinator::Timeout, this);
+}
+
+inline void
+PollingCoordinator::HandleRead(Ptr<Socket> socket)
+{
+    Address from;
+    Ptr<Packet> response;
+    while ((response = socket->RecvFrom(from)))
+    {
+        uint8_t header[8];
+        if (response->CopyData(header, 8) != 8 || PollReadU32(header) != m_cycle ||
+            PollReadU32(header + 4) != m_slot || m_event.IsExpired())
+        {
+            continue; // Late response to a poll that already timed out
+        }
+        Simulator::Cancel(m_event);
+        double latency = (Simulator::Now() - m_pollSent).GetSeconds();
+        NodeStats& stats = m_stats[m_slot];
+        stats.responses++;
+        stats.latencySum += latency;
+        stats.latencyMax = std::max(stats.latencyMax, latency);
+        m_responses++;
+        NextSlot();
+    }
+}
+
+inline void
+PollingCoordinator::Timeout()
+{
+    m_stats[m_slot].timeouts++;
+    NextSlot();
+}
+
+inline void
+PollingCoordinator::NextSlot()
+{
+    m_slot++;
+    if (m_slot >= m_nodes.size())
+    {
+        EndCycle();
+        return;
+    }
+    m_event = Simulator::Schedule(m_guard, &PollingCoordinator::PollSlot, this);
+}
+
+inline void
+PollingCoordinator::EndCycle()
+{
+    Time busy = Simulator::Now() - m_cycleStart;
+    m_cycles++;
+    m_busySum += busy.GetSeconds();
+    m_busyMax = std::max(m_busyMax, busy.GetSeconds());
+    if (busy > m_cycleTime)
+    {
+        m_overruns++;
+    }
+
+    if (m_adaptive)
+    {
+        Time target = Seconds(busy.GetSeconds() * (1.0 + m_headroom));
+        m_cycleTime = std::min(std::max(target, m_minCycle), m_maxCycle);
+    }
+
+    // An overrun starts the next cycle right away, late by the overrun
+    m_nominalStart = m_cycleStart + m_cycleTime;
+    Time next = std::max(m_nominalStart, Simulator::Now());
+    m_event = Simulator::Schedule(next - Simulator::Now(), &PollingCoordinator::StartCycle, this);
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_POLLING_COORDINATOR_H */
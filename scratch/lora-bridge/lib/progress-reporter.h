@@ -0,0 +1,264 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Live progress of a long Simulator::Run().
+//
+// A background thread wakes up on a wall-clock timer and samples the
+// CountingScheduler counters: simulated time reached, events executed and
+// events pending. From two consecutive samples it derives the simulated to
+// wall-clock time ratio and the event rate. Each sample goes to stderr as one
+// line and to a metrics file in the Prometheus text format, replaced
+// atomically (written aside, then renamed) so that a scraper never reads half
+// a file. An interval without any event is flagged: the run is stuck in one
+// event, not merely slow.
+//
+// The thread never touches ns-3 objects or the simulator; everything it
+// needs from ns-3 is computed in Start(). The simulator thread only pays for
+// the counter updates of the scheduler. Start() after any fork.
+
+#ifndef LORA_BRIDGE_PROGRESS_REPORTER_H
+#define LORA_BRIDGE_PROGRESS_REPORTER_H
+
+#include "counting-scheduler.h"
+#include "memory-footprint.h"
+
+#include "ns3/nstime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace ns3
+{
+
+/**
+ * Wall-clock sampling of the simulation progress to stderr and a
+ * Prometheus text file.
+ */
+class ProgressReporter
+{
+  public:
+    ProgressReporter();
+    ~ProgressReporter();
+
+    /// @param seconds Wall-clock time between two samples (s).
+    void SetInterval(double seconds);
+
+    /// @param path Metrics file, empty for stderr only.
+    void SetMetricsFile(const std::string& path);
+
+    /**
+     * @param labels Prometheus labels of every metric, e.g. scenario="CT_dev",run="1".
+     */
+    void SetLabels(const std::string& labels);
+
+    /// @param stop Simulated time the run stops at, for the progress ratio.
+    void SetStopTime(Time stop);
+
+    /// Start sampling; the CountingScheduler must be installed
+    void Start();
+
+    /// Take a last sample and join the thread
+    void Stop();
+
+  private:
+    /// Sampling loop of the thread
+    void Run();
+
+    /// Take one sample and report it
+    void Sample(bool last);
+
+    double m_interval;        //!< Wall-clock time between two samples (s)
+    std::string m_file;       //!< Metrics file, empty for none
+    std::string m_labels;     //!< Prometheus labels
+    Time m_stop;              //!< Stop time of the run
+    double m_stopSeconds;     //!< Stop time of the run (s), 0 if unknown
+    double m_stepSeconds;     //!< Length of one time step (s)
+
+    std::thread m_thread;               //!< Sampling thread
+    std::mutex m_mutex;                 //!< Guards m_running
+    std::condition_variable m_wake;     //!< Wakes the thread up early on Stop()
+    bool m_running;                     //!< Whether the thread should go on
+    std::chrono::steady_clock::time_point m_start;    //!< Wall-clock start
+    std::chrono::steady_clock::time_point m_lastWall; //!< Wall-clock time of the last sample
+    double m_lastSimSeconds;            //!< Simulated time at the last sample (s)
+    uint64_t m_lastEvents;              //!< Events executed at the last sample
+    std::time_t m_lastActive;           //!< Unix time of the last sample with events
+};
+
+inline ProgressReporter::ProgressReporter()
+    : m_interval(10.0),
+      m_stop(Seconds(0)),
+      m_stopSeconds(0.0),
+      m_stepSeconds(0.0),
+      m_running(false),
+      m_lastSimSeconds(0.0),
+      m_lastEvents(0),
+      m_lastActive(0)
+{
+}
+
+inline ProgressReporter::~ProgressReporter()
+{
+    Stop();
+}
+
+inline void
+ProgressReporter::SetInterval(double seconds)
+{
+    m_interval = seconds;
+}
+
+inline void
+ProgressReporter::SetMetricsFile(const std::string& path)
+{
+    m_file = path;
+}
+
+inline void
+ProgressReporter::SetLabels(const std::string& labels)
+{
+    m_labels = labels;
+}
+
+inline void
+ProgressReporter::SetStopTime(Time stop)
+{
+    m_stop = stop;
+}
+
+inline void
+ProgressReporter::Start()
+{
+    if (m_thread.joinable())
+    {
+        return;
+    }
+    m_stepSeconds = TimeStep(1).GetSeconds();
+    m_stopSeconds = m_stop.GetSeconds();
+    m_start = std::chrono::steady_clock::now();
+    m_lastWall = m_start;
+    m_lastSimSeconds = CountingScheduler::GetCounters().lastTs.load(std::memory_order_relaxed) * m_stepSeconds;
+    m_lastEvents = CountingScheduler::GetCounters().dequeued.load(std::memory_order_relaxed);
+    m_lastActive = std::time(nullptr);
+    m_running = true;
+    m_thread = std::thread(&ProgressReporter::Run, this);
+}
+
+inline void
+ProgressReporter::Stop()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    Sample(true);
+}
+
+inline void
+ProgressReporter::Run()
+{
+    auto period = std::chrono::duration<double>(m_interval);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, period, [this]() { return !m_running; }))
+    {
+        lock.unlock();
+        Sample(false);
+        lock.lock();
+    }
+}
+
+inline void
+ProgressReporter::Sample(bool last)
+{
+    const CountingScheduler::Counters& counters = CountingScheduler::GetCounters();
+    uint64_t inserted = counters.inserted.load(std::memory_order_relaxed);
+    uint64_t removed = counters.removed.load(std::memory_order_relaxed);
+    uint64_t events = counters.dequeued.load(std::memory_order_relaxed);
+    double simSeconds = counters.lastTs.load(std::memory_order_relaxed) * m_stepSeconds;
+    uint64_t queue = inserted >= events + removed ? inserted - events - removed : 0;
+    uint64_t rss = MemoryFootprint::GetResidentBytes();
+
+    auto now = std::chrono::steady_clock::now();
+    double wallSeconds = std::chrono::duration<double>(now - m_start).count();
+    double elapsed = std::chrono::duration<double>(now - m_lastWall).count();
+    double speed = elapsed > 0.0 ? (simSeconds - m_lastSimSeconds) / elapsed : 0.0;
+    double eventRate = elapsed > 0.0 ? (events - m_lastEvents) / elapsed : 0.0;
+    double progress = m_stopSeconds > 0.0 ? std::min(1.0, simSeconds / m_stopSeconds) : 0.0;
+    bool stalled = !last && events == m_lastEvents;
+    if (!stalled)
+    {
+        m_lastActive = std::time(nullptr);
+    }
+    m_lastWall = now;
+    m_lastSimSeconds = simSeconds;
+    m_lastEvents = events;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "[progress] t = " << simSeconds << " s";
+    if (m_stopSeconds > 0.0)
+    {
+        line << " (" << 100.0 * progress << "%)";
+    }
+    line << ", " << speed << "x real time, " << std::setprecision(0) << eventRate << " events/s, queue " << queue
+         << ", RSS " << rss / (1024 * 1024) << " MiB, wall " << wallSeconds << " s";
+    if (stalled)
+    {
+        line << ", no event in the last " << elapsed << " s";
+    }
+    line << (last ? ", done" : "") << "\n";
+    std::cerr << line.str();
+
+    if (m_file.empty())
+    {
+        return;
+    }
+    std::string labels = "{" + m_labels + "}";
+    std::ostringstream metrics;
+    metrics << std::setprecision(17);
+    auto metric = [&metrics, &labels](const char* name, const char* type, const char* help, double value) {
+        metrics << "# HELP " << name << " " << help << "\n"
+                << "# TYPE " << name << " " << type << "\n"
+                << name << labels << " " << value << "\n";
+    };
+    metric("lora_bridge_sim_time_seconds", "gauge", "Simulated time reached.", simSeconds);
+    metric("lora_bridge_progress_ratio", "gauge", "Fraction of the simulated time done.", progress);
+    metric("lora_bridge_wall_time_seconds", "gauge", "Wall-clock time since the run started.", wallSeconds);
+    metric("lora_bridge_sim_speed_ratio", "gauge", "Simulated seconds per wall-clock second over the last interval.", speed);
+    metric("lora_bridge_events_total", "counter", "Events executed, cancelled ones included.", events);
+    metric("lora_bridge_events_per_second", "gauge", "Events per wall-clock second over the last interval.", eventRate);
+    metric("lora_bridge_event_queue_size", "gauge", "Events waiting in the scheduler.", queue);
+    metric("lora_bridge_resident_bytes", "gauge", "Resident set size of the process.", rss);
+    metric("lora_bridge_last_event_timestamp_seconds", "gauge", "Unix time of the last interval with events.", m_lastActive);
+    metric("lora_bridge_run_done", "gauge", "1 once Simulator::Run() has returned.", last ? 1 : 0);
+
+    std::string tmp = m_file + ".tmp";
+    std::ofstream file(tmp);
+    file << metrics.str();
+    file.close();
+    if (!file || std::rename(tmp.c_str(), m_file.c_str()) != 0)
+    {
+        std::cerr << "[progress] could not write " << m_file << "\n";
+    }
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_PROGRESS_REPORTER_H */
@@ -0,0 +1,401 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Per-device radio state timeline of the end devices.
+//
+// The recorder follows the EndDeviceState of every end device PHY and adds
+// the reception outcomes the PHY reports. The class A MAC opens a receive
+// window by putting the PHY in standby, 1 s (RX1) and 2 s (RX2) after the end
+// of an uplink, so standby periods are labelled RX1 or RX2 from their
+// distance to the last transmission. Records go to a binary file, buffered
+// in memory:
+//
+//   header  "LBRADIO1" (8 bytes), device count (u32 little endian)
+//   record  varint time delta from the previous record (us),
+//           varint device index, one code byte
+//
+// A record is 3 to 5 bytes for typical fleets. RadioTimelineReader decodes
+// the file for the analysis tool (lora-bridge-radio-timeline).
+
+#ifndef LORA_BRIDGE_RADIO_TIMELINE_H
+#define LORA_BRIDGE_RADIO_TIMELINE_H
+
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/// Codes of the timeline records
+enum RadioTimelineCode : uint8_t
+{
+    RADIO_SLEEP = 0,                 //!< Entered sleep
+    RADIO_STANDBY = 1,               //!< Entered standby outside the receive windows
+    RADIO_TX = 2,                    //!< Started transmitting
+    RADIO_RX1 = 3,                   //!< Listening in the first receive window
+    RADIO_RX2 = 4,                   //!< Listening in the second receive window
+    RADIO_RX = 5,                    //!< Started demodulating a packet
+    RADIO_EVENT_RECEIVED = 16,       //!< Downlink received
+    RADIO_EVENT_INTERFERENCE = 17,   //!< Downlink lost to interference
+    RADIO_EVENT_SENSITIVITY = 18,    //!< Downlink below sensitivity
+    RADIO_EVENT_WRONG_FREQUENCY = 19, //!< Downlink on another frequency
+    RADIO_EVENT_WRONG_SF = 20,       //!< Downlink with another spreading factor
+};
+
+/**
+ * Records the radio state timeline of a set of end devices.
+ */
+class RadioTimelineRecorder : public Object
+{
+  public:
+    static TypeId GetTypeId();
+
+    RadioTimelineRecorder();
+
+    /**
+     * @param path File to write.
+     * @param nDevices Number of devices that will be added.
+     * @return Whether the file could be created.
+     */
+    bool Open(const std::string& path, uint32_t nDevices);
+
+    /**
+     * Follow the radio of one end device.
+     *
+     * @param index Device index written in the records.
+     * @param phy The end device PHY.
+     */
+    void AddDevice(uint32_t index, Ptr<lorawan::EndDeviceLoraPhy> phy);
+
+    /// Write the buffered records and close the file
+    void Close();
+
+    /// @return The number of records written
+    uint64_t GetRecordCount() const;
+
+    /// @return The size of the file, header included
+    uint64_t GetBytesWritten() const;
+
+  private:
+    void DoDispose() override;
+
+    /// Append one record
+    void Record(uint32_t index, uint8_t code);
+
+    /// Append a varint to the buffer
+    void PutVarint(uint64_t value);
+
+    /// Write the buffer to the file
+    void Flush();
+
+    /// EndDeviceState trace sink
+    static void StateChanged(RadioTimelineRecorder* recorder,
+                             uint32_t index,
+                             lorawan::EndDeviceLoraPhy::State oldState,
+                             lorawan::EndDeviceLoraPhy::State newState);
+
+    /// Reception outcome trace sink
+    static void Outcome(RadioTimelineRecorder* recorder,
+                        uint32_t index,
+                        uint8_t code,
+                        Ptr<const Packet> packet,
+                        uint32_t nodeId);
+
+    std::ofstream m_file;              //!< Output file
+    std::vector<uint8_t> m_buffer;     //!< Records not yet written
+    std::vector<Time> m_lastTxEnd;     //!< End of the last transmission of each device
+    uint64_t m_lastMicroseconds;       //!< Time of the last record (us)
+    uint64_t m_records;                //!< Records written
+    uint64_t m_bytes;                  //!< Bytes written
+};
+
+/**
+ * Sequential reader of a radio timeline file.
+ */
+class RadioTimelineReader
+{
+  public:
+    /// One decoded record
+    struct Entry
+    {
+        uint64_t microseconds; //!< Absolute time (us)
+        uint32_t device;       //!< Device index
+        uint8_t code;          //!< RadioTimelineCode
+    };
+
+    /**
+     * @param path File to read.
+     * @return Whether the file has a valid header.
+     */
+    bool Open(const std::string& path);
+
+    /// @return The number of devices declared in the header
+    uint32_t GetDeviceCount() const;
+
+    /**
+     * @param entry Set to the next record.
+     * @return Whether a record was read.
+     */
+    bool Next(Entry& entry);
+
+  private:
+    /// Read a varint, false at end of file
+    bool GetVarint(uint64_t& value);
+
+    std::ifstream m_file;      //!< Input file
+    uint32_t m_devices = 0;    //!< Device count
+    uint64_t m_time = 0;       //!< Time of the last record (us)
+};
+
+inline TypeId
+RadioTimelineRecorder::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::RadioTimelineRecorder")
+                            .SetParent<Object>()
+                            .SetGroupName("LoraBridge")
+                            .AddConstructor<RadioTimelineRecorder>();
+    return tid;
+}
+
+inline RadioTimelineRecorder::RadioTimelineRecorder()
+    : m_lastMicroseconds(0),
+      m_records(0),
+      m_bytes(0)
+{
+    m_buffer.reserve(1 << 16);
+}
+
+inline bool
+RadioTimelineRecorder::Open(const std::string& path, uint32_t nDevices)
+{
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file)
+    {
+        return false;
+    }
+    m_file.write("LBRADIO1", 8);
+    uint8_t count[4] = {uint8_t(nDevices),
+                        uint8_t(nDevices >> 8),
+                        uint8_t(nDevices >> 16),
+                        uint8_t(nDevices >> 24)};
+    m_file.write(reinterpret_cast<const char*>(count), 4);
+    m_bytes = 12;
+    m_lastTxEnd.assign(nDevices, Time(-1));
+    return true;
+}
+
+inline void
+RadioTimelineRecorder::AddDevice(uint32_t index, Ptr<lorawan::EndDeviceLoraPhy> phy)
+{
+    if (index >= m_lastTxEnd.size())
+    {
+        m_lastTxEnd.resize(index + 1, Time(-1));
+    }
+    phy->TraceConnectWithoutContext("EndDeviceState",
+                                    MakeBoundCallback(&RadioTimelineRecorder::StateChanged, this, index));
+    phy->TraceConnectWithoutContext(
+        "ReceivedPacket",
+        MakeBoundCallback(&RadioTimelineRecorder::Outcome, this, index, uint8_t(RADIO_EVENT_RECEIVED)));
+    phy->TraceConnectWithoutContext(
+        "LostPacketBecauseInterference",
+        MakeBoundCallback(&RadioTimelineRecorder::Outcome, this, index, uint8_t(RADIO_EVENT_INTERFERENCE)));
+    phy->TraceConnectWithoutContext(
+        "LostPacketBecauseUnderSensitivity",
+        MakeBoundCallback(&RadioTimelineRecorder::Outcome, this, index, uint8_t(RADIO_EVENT_SENSITIVITY)));
+    phy->TraceConnectWithoutContext(
+        "LostPacketBecauseWrongFrequency",
+        MakeBoundCallback(&RadioTimelineRecorder::Outcome, this, index, uint8_t(RADIO_EVENT_WRONG_FREQUENCY)));
+    phy->TraceConnectWithoutContext(
+        "LostPacketBecauseWrongSpreadingFactor",
+        MakeBoundCallback(&RadioTimelineRecorder::Outcome, this, index, uint8_t(RADIO_EVENT_WRONG_SF)));
+}
+
+inline void
+RadioTimelineRecorder::Close()
+{
+    if (m_file.is_open())
+    {
+        Flush();
+        m_file.close();
+    }
+}
+
+inline uint64_t
+RadioTimelineRecorder::GetRecordCount() const
+{
+    return m_records;
+}
+
+inline uint64_t
+RadioTimelineRecorder::GetBytesWritten() const
+{
+    return m_bytes + m_buffer.size();
+}
+
+inline void
+RadioTimelineRecorder::DoDispose()
+{
+    Close();
+    Object::DoDispose();
+}
+
+inline void
+RadioTimelineRecorder::Record(uint32_t index, uint8_t code)
+{
+    if (!m_file.is_open())
+    {
+        return;
+    }
+    uint64_t now = Simulator::Now().GetMicroSeconds();
+    PutVarint(now - m_lastMicroseconds);
+    PutVarint(index);
+    m_buffer.push_back(code);
+    m_lastMicroseconds = now;
+    m_records++;
+    if (m_buffer.size() >= (1 << 16) - 32)
+    {
+        Flush();
+    }
+}
+
+inline void
+RadioTimelineRecorder::PutVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_buffer.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    m_buffer.push_back(uint8_t(value));
+}
+
+inline void
+RadioTimelineRecorder::Flush()
+{
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+    m_bytes += m_buffer.size();
+    m_buffer.clear();
+}
+
+inline void
+RadioTimelineRecorder::StateChanged(RadioTimelineRecorder* recorder,
+                                    uint32_t index,
+                                    lorawan::EndDeviceLoraPhy::State oldState,
+                                    lorawan::EndDeviceLoraPhy::State newState)
+{
+    Time now = Simulator::Now();
+    if (oldState == lorawan::EndDeviceLoraPhy::TX)
+    {
+        recorder->m_lastTxEnd[index] = now;
+    }
+
+    uint8_t code = RADIO_STANDBY;
+    switch (newState)
+    {
+    case lorawan::EndDeviceLoraPhy::SLEEP:
+        code = RADIO_SLEEP;
+        break;
+    case lorawan::EndDeviceLoraPhy::TX:
+        code = RADIO_TX;
+        break;
+    case lorawan::EndDeviceLoraPhy::RX:
+        code = RADIO_RX;
+        break;
+    default: {
+        // Class A windows open 1 s and 2 s after the end of the uplink
+        Time sinceTx = now - recorder->m_lastTxEnd[index];
+        if (recorder->m_lastTxEnd[index].IsNegative() || sinceTx < MilliSeconds(500) ||
+            sinceTx > MilliSeconds(2500))
+        {
+            code = RADIO_STANDBY;
+        }
+        else
+        {
+            code = sinceTx < MilliSeconds(1500) ? RADIO_RX1 : RADIO_RX2;
+        }
+        break;
+    }
+    }
+    recorder->Record(index, code);
+}
+
+inline void
+RadioTimelineRecorder::Outcome(RadioTimelineRecorder* recorder,
+                               uint32_t index,
+                               uint8_t code,
+                               Ptr<const Packet> packet,
+                               uint32_t nodeId)
+{
+    recorder->Record(index, code);
+}
+
+inline bool
+RadioTimelineReader::Open(const std::string& path)
+{
+    m_file.open(path, std::ios::binary);
+    char magic[8];
+    uint8_t count[4];
+    if (!m_file.read(magic, 8) || std::memcmp(magic, "LBRADIO1", 8) != 0 ||
+        !m_file.read(reinterpret_cast<char*>(count), 4))
+    {
+        return false;
+    }
+    m_devices = count[0] | (count[1] << 8) | (count[2] << 16) | (uint32_t(count[3]) << 24);
+    m_time = 0;
+    return true;
+}
+
+inline uint32_t
+RadioTimelineReader::GetDeviceCount() const
+{
+    return m_devices;
+}
+
+inline bool
+RadioTimelineReader::Next(Entry& entry)
+{
+    uint64_t delta;
+    uint64_t device;
+    char code;
+    if (!GetVarint(delta) || !GetVarint(device) || !m_file.get(code))
+    {
+        return false;
+    }
+    m_time += delta;
+    entry.microseconds = m_time;
+    entry.device = device;
+    entry.code = uint8_t(code);
+    return true;
+}
+
+inline bool
+RadioTimelineReader::GetVarint(uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        char byte;
+        if (!m_file.get(byte))
+        {
+            return false;
+        }
+        value |= uint64_t(uint8_t(byte) & 0x7f) << shift;
+        if (!(uint8_t(byte) & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_RADIO_TIMELINE_H */
@@ -0,0 +1,216 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Importance sampling estimates of the per-node uplink loss probability.
+//
+// Every uplink transmission is one sample. It starts with the end device's
+// StartSending trace and collects one outcome per gateway (received or lost
+// for any reason), each with the log likelihood ratio of the draws it
+// depends on at that gateway (see BiasedNakagamiLossModel). Once all the
+// gateways have reported, the sample is Y = W if no gateway received the
+// packet and 0 otherwise, W being the product of the likelihood ratios.
+// The mean of Y estimates the loss probability under the unbiased fading,
+// and the sample variance of Y over N samples gives its variance.
+//
+// Transmissions still in the air when the simulation stops are not counted.
+// Everything runs on the simulation thread.
+
+#ifndef LORA_BRIDGE_RARE_EVENT_ESTIMATOR_H
+#define LORA_BRIDGE_RARE_EVENT_ESTIMATOR_H
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Per-node loss probability from likelihood-ratio weighted outcomes.
+ */
+class RareEventEstimator
+{
+  public:
+    /// Samples of one node
+    struct Entry
+    {
+        uint64_t samples = 0; //!< Completed transmissions
+        uint64_t losses = 0;  //!< Transmissions no gateway received, under the biased fading
+        double sumY = 0.0;    //!< Sum of the weighted loss indicators
+        double sumY2 = 0.0;   //!< Sum of their squares
+
+        /// @return The estimated loss probability under the unbiased fading
+        double GetEstimate() const;
+
+        /// @return The variance of GetEstimate()
+        double GetVariance() const;
+
+        /// @return The standard deviation of GetEstimate() over the estimate, 0 if it is 0
+        double GetRelativeError() const;
+
+        /// @return The loss rate observed under the biased fading
+        double GetBiasedLossRate() const;
+    };
+
+    RareEventEstimator();
+
+    /**
+     * @param nDevices The number of devices to track.
+     * @param nGateways The number of outcomes each transmission waits for.
+     */
+    void SetTopology(uint32_t nDevices, uint32_t nGateways);
+
+    /**
+     * A transmission started.
+     *
+     * @param packetId Unique id of the packet.
+     * @param device Index of the end device.
+     */
+    void StartTransmission(uint64_t packetId, uint32_t device);
+
+    /**
+     * One gateway is done with a transmission. Unknown ids (downlinks,
+     * packets sent before the start) are ignored.
+     *
+     * @param packetId Unique id of the packet.
+     * @param received Whether the gateway received it.
+     * @param logWeight Log likelihood ratio of the draws the outcome depends on.
+     */
+    void AddOutcome(uint64_t packetId, bool received, double logWeight);
+
+    /// @return The samples of device @p device
+    const Entry& GetEntry(uint32_t device) const;
+
+    /// @return The samples of all the devices pooled
+    Entry GetTotal() const;
+
+    /// @return The number of transmissions waiting for outcomes
+    size_t GetPendingCount() const;
+
+  private:
+    /// A transmission waiting for the gateways
+    struct Pending
+    {
+        uint32_t device = 0;    //!< End device
+        uint32_t outcomes = 0;  //!< Gateways that reported
+        bool received = false;  //!< Whether a gateway received it
+        double logWeight = 0.0; //!< Sum of the log likelihood ratios
+    };
+
+    uint32_t m_nGateways;                            //!< Outcomes per transmission
+    std::vector<Entry> m_entries;                    //!< Samples per device
+    std::unordered_map<uint64_t, Pending> m_pending; //!< Transmissions in the air, by packet id
+};
+
+inline double
+RareEventEstimator::Entry::GetEstimate() const
+{
+    return samples > 0 ? sumY / samples : 0.0;
+}
+
+inline double
+RareEventEstimator::Entry::GetVariance() const
+{
+    if (samples < 2)
+    {
+        return 0.0;
+    }
+    double mean = sumY / samples;
+    double sampleVariance = (sumY2 - samples * mean * mean) / (samples - 1);
+    return sampleVariance > 0.0 ? sampleVariance / samples : 0.0;
+}
+
+inline double
+RareEventEstimator::Entry::GetRelativeError() const
+{
+    double estimate = GetEstimate();
+    return estimate > 0.0 ? std::sqrt(GetVariance()) / estimate : 0.0;
+}
+
+inline double
+RareEventEstimator::Entry::GetBiasedLossRate() const
+{
+    return samples > 0 ? static_cast<double>(losses) / samples : 0.0;
+}
+
+inline RareEventEstimator::RareEventEstimator()
+    : m_nGateways(1)
+{
+}
+
+inline void
+RareEventEstimator::SetTopology(uint32_t nDevices, uint32_t nGateways)
+{
+    m_entries.assign(nDevices, Entry());
+    m_nGateways = nGateways;
+    m_pending.clear();
+}
+
+inline void
+RareEventEstimator::StartTransmission(uint64_t packetId, uint32_t device)
+{
+    Pending& pending = m_pending[packetId];
+    pending = Pending();
+    pending.device = device;
+}
+
+inline void
+RareEventEstimator::AddOutcome(uint64_t packetId, bool received, double logWeight)
+{
+    auto it = m_pending.find(packetId);
+    if (it == m_pending.end())
+    {
+        return;
+    }
+    Pending& pending = it->second;
+    pending.outcomes++;
+    pending.received = pending.received || received;
+    pending.logWeight += logWeight;
+    if (pending.outcomes < m_nGateways)
+    {
+        return;
+    }
+
+    Entry& entry = m_entries[pending.device];
+    entry.samples++;
+    if (!pending.received)
+    {
+        double y = std::exp(pending.logWeight);
+        entry.losses++;
+        entry.sumY += y;
+        entry.sumY2 += y * y;
+    }
+    m_pending.erase(it);
+}
+
+inline const RareEventEstimator::Entry&
+RareEventEstimator::GetEntry(uint32_t device) const
+{
+    return m_entries.at(device);
+}
+
+inline RareEventEstimator::Entry
+RareEventEstimator::GetTotal() const
+{
+    Entry total;
+    for (const Entry& entry : m_entries)
+    {
+        total.samples += entry.samples;
+        total.losses += entry.losses;
+        total.sumY += entry.sumY;
+        total.sumY2 += entry.sumY2;
+    }
+    return total;
+}
+
+inline size_t
+RareEventEstimator::GetPendingCount() const
+{
+    return m_pending.size();
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_RARE_EVENT_ESTIMATOR_H */
@@ -0,0 +1,177 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Partition of a multi-gateway deployment into gateway regions.
+//
+// Regions are laid out on a square grid. Every region holds the same number
+// of gateways and end devices and is owned by one logical process (MPI rank):
+// its nodes get that rank as system id and its end devices and gateways
+// share a radio channel of their own. Each region also has its own network
+// server on that rank, so regions never meet during the run.
+//
+// All positions are computed, not drawn, so that every rank builds the same
+// topology without exchanging it.
+
+#ifndef LORA_BRIDGE_REGION_PARTITION_H
+#define LORA_BRIDGE_REGION_PARTITION_H
+
+#include "ns3/vector.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace ns3
+{
+
+/**
+ * Geometry and rank assignment of the gateway regions.
+ */
+class RegionPartition
+{
+  public:
+    /**
+     * @param nRegions Number of gateway regions.
+     * @param gatewaysPerRegion Gateways in every region.
+     * @param devicesPerRegion End devices in every region.
+     * @param spacing Distance between the centres of neighbouring regions (m).
+     * @param radius Radius of the disc holding the end devices of a region (m).
+     * @param nRanks Number of logical processes.
+     */
+    RegionPartition(uint32_t nRegions,
+                    uint32_t gatewaysPerRegion,
+                    uint32_t devicesPerRegion,
+                    double spacing,
+                    double radius,
+                    uint32_t nRanks);
+
+    /// @return The number of regions
+    uint32_t GetRegionCount() const;
+
+    /// @return The number of gateways in every region
+    uint32_t GetGatewaysPerRegion() const;
+
+    /// @return The number of end devices in every region
+    uint32_t GetDevicesPerRegion() const;
+
+    /**
+     * @param region Region index.
+     * @return The rank that simulates @p region.
+     */
+    uint32_t GetRank(uint32_t region) const;
+
+    /**
+     * @param region Region index.
+     * @return The centre of @p region.
+     */
+    Vector GetCentre(uint32_t region) const;
+
+    /**
+     * Gateways sit on a circle of half the region radius, or at the centre
+     * when the region has a single gateway.
+     *
+     * @param region Region index.
+     * @param k Gateway index inside the region.
+     * @param height Antenna height (m).
+     * @return The position of the gateway.
+     */
+    Vector GetGatewayPosition(uint32_t region, uint32_t k, double height) const;
+
+    /**
+     * End devices are spread evenly over the region disc along a
+     * golden-angle spiral.
+     *
+     * @param region Region index.
+     * @param k End device index inside the region.
+     * @param height Device height (m).
+     * @return The position of the end device.
+     */
+    Vector GetDevicePosition(uint32_t region, uint32_t k, double height) const;
+
+  private:
+    uint32_t m_regions;  //!< Number of regions
+    uint32_t m_gateways; //!< Gateways per region
+    uint32_t m_devices;  //!< End devices per region
+    double m_spacing;    //!< Distance between region centres (m)
+    double m_radius;     //!< Region radius (m)
+    uint32_t m_ranks;    //!< Number of logical processes
+    uint32_t m_columns;  //!< Columns of the region grid
+};
+
+inline RegionPartition::RegionPartition(uint32_t nRegions,
+                                        uint32_t gatewaysPerRegion,
+                                        uint32_t devicesPerRegion,
+                                        double spacing,
+                                        double radius,
+                                        uint32_t nRanks)
+    : m_regions(nRegions),
+      m_gateways(gatewaysPerRegion),
+      m_devices(devicesPerRegion),
+      m_spacing(spacing),
+      m_radius(radius),
+      m_ranks(nRanks > 0 ? nRanks : 1),
+      m_columns(static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(nRegions)))))
+{
+    if (m_columns == 0)
+    {
+        m_columns = 1;
+    }
+}
+
+inline uint32_t
+RegionPartition::GetRegionCount() const
+{
+    return m_regions;
+}
+
+inline uint32_t
+RegionPartition::GetGatewaysPerRegion() const
+{
+    return m_gateways;
+}
+
+inline uint32_t
+RegionPartition::GetDevicesPerRegion() const
+{
+    return m_devices;
+}
+
+inline uint32_t
+RegionPartition::GetRank(uint32_t region) const
+{
+    return region % m_ranks;
+}
+
+inline Vector
+RegionPartition::GetCentre(uint32_t region) const
+{
+    return Vector((region % m_columns) * m_spacing, (region / m_columns) * m_spacing, 0.0);
+}
+
+inline Vector
+RegionPartition::GetGatewayPosition(uint32_t region, uint32_t k, double height) const
+{
+    Vector centre = GetCentre(region);
+    if (m_gateways <= 1)
+    {
+        return Vector(centre.x, centre.y, height);
+    }
+    double angle = 2.0 * M_PI * k / m_gateways;
+    return Vector(centre.x + 0.5 * m_radius * std::cos(angle),
+                  centre.y + 0.5 * m_radius * std::sin(angle),
+                  height);
+}
+
+inline Vector
+RegionPartition::GetDevicePosition(uint32_t region, uint32_t k, double height) const
+{
+    const double goldenAngle = M_PI * (3.0 - std::sqrt(5.0));
+    Vector centre = GetCentre(region);
+    double r = m_radius * std::sqrt((k + 0.5) / m_devices);
+    double angle = k * goldenAngle;
+    return Vector(centre.x + r * std::cos(angle), centre.y + r * std::sin(angle), height);
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_REGION_PARTITION_H */
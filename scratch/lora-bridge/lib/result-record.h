@@ -0,0 +1,352 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Compact, machine-readable result record of one scenario run.
+//
+// A run emits its parameters, its scalar results and its numeric tables and
+// nothing else; lora-bridge-report renders records as LaTeX, CSV or JSON.
+// The file is line oriented and tab separated:
+//
+//   LBREC 1
+//   p <key> <value>                 one per parameter
+//   s <name> <value>                one per scalar
+//   t <name> <title> <col>...       starts a table
+//   r <value>...                    one per row of the last table
+
+#ifndef LORA_BRIDGE_RESULT_RECORD_H
+#define LORA_BRIDGE_RESULT_RECORD_H
+
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Parameters, scalars and tables produced by one run.
+ */
+class ResultRecord
+{
+  public:
+    /// A numeric table
+    struct Table
+    {
+        std::string name;                      //!< Identifier of the table
+        std::string title;                     //!< Human-readable title
+        std::vector<std::string> columns;      //!< Column names
+        std::vector<std::vector<double>> rows; //!< Row values, one per column
+    };
+
+    /**
+     * @param key A parameter name.
+     * @param value Its value.
+     */
+    void SetParameter(const std::string& key, const std::string& value);
+
+    /**
+     * Set the parameters from "key=value" lines, such as
+     * ScenarioConfig::GetCanonical().
+     *
+     * @param lines The parameter lines.
+     */
+    void SetParameters(const std::string& lines);
+
+    /**
+     * @param name A scalar result name.
+     * @param value Its value.
+     */
+    void SetScalar(const std::string& name, double value);
+
+    /**
+     * Add an empty table.
+     *
+     * @param name Identifier of the table.
+     * @param title Human-readable title.
+     * @param columns Column names.
+     * @return The index of the table, for AddRow.
+     */
+    size_t AddTable(const std::string& name,
+                    const std::string& title,
+                    const std::vector<std::string>& columns);
+
+    /**
+     * @param table Index returned by AddTable.
+     * @param row One value per column.
+     */
+    void AddRow(size_t table, const std::vector<double>& row);
+
+    /// @return The parameters, sorted by key
+    const std::map<std::string, std::string>& GetParameters() const;
+
+    /// @return The value of parameter @p key, or an empty string
+    std::string GetParameter(const std::string& key) const;
+
+    /// @return The scalars, in insertion order
+    const std::vector<std::pair<std::string, double>>& GetScalars() const;
+
+    /**
+     * @param name A scalar name.
+     * @param value Set to the scalar value if found.
+     * @return Whether the record has the scalar.
+     */
+    bool GetScalar(const std::string& name, double& value) const;
+
+    /// @return The tables, in insertion order
+    const std::vector<Table>& GetTables() const;
+
+    /**
+     * @param path File to write.
+     * @return Whether the record was written.
+     */
+    bool Write(const std::string& path) const;
+
+    /**
+     * @param path File to read.
+     * @return Whether a complete record was read; false for an unknown line or a malformed number.
+     */
+    bool Read(const std::string& path);
+
+  private:
+    /// Split @p line on tabs
+    static std::vector<std::string> Split(const std::string& line);
+
+    std::map<std::string, std::string> m_parameters;       //!< Parameters
+    std::vector<std::pair<std::string, double>> m_scalars; //!< Scalar results
+    std::vector<Table> m_tables;                           //!< Tables
+};
+
+inline void
+ResultRecord::SetParameter(const std::string& key, const std::string& value)
+{
+    m_parameters[key] = value;
+}
+
+inline void
+ResultRecord::SetParameters(const std::string& lines)
+{
+    std::istringstream iss(lines);
+    std::string line;
+    while (std::getline(iss, line))
+    {
+        size_t eq = line.find('=');
+        if (eq != std::string::npos)
+        {
+            m_parameters[line.substr(0, eq)] = line.substr(eq + 1);
+        }
+    }
+}
+
+inline void
+ResultRecord::SetScalar(const std::string& name, double value)
+{
+    for (auto& scalar : m_scalars)
+    {
+        if (scalar.first == name)
+        {
+            scalar.second = value;
+            return;
+        }
+    }
+    m_scalars.emplace_back(name, value);
+}
+
+inline size_t
+ResultRecord::AddTable(const std::string& name,
+                       const std::string& title,
+                       const std::vector<std::string>& columns)
+{
+    m_tables.push_back({name, title, columns, {}});
+    return m_tables.size() - 1;
+}
+
+inline void
+ResultRecord::AddRow(size_t table, const std::vector<double>& row)
+{
+    m_tables.at(table).rows.push_back(row);
+}
+
+inline const std::map<std::string, std::string>&
+ResultRecord::GetParameters() const
+{
+    return m_parameters;
+}
+
+inline std::string
+ResultRecord::GetParameter(const std::string& key) const
+{
+    auto it = m_parameters.find(key);
+    return it == m_parameters.end() ? std::string() : it->second;
+}
+
+inline const std::vector<std::pair<std::string, double>>&
+ResultRecord::GetScalars() const
+{
+    return m_scalars;
+}
+
+inline bool
+ResultRecord::GetScalar(const std::string& name, double& value) const
+{
+    for (const auto& scalar : m_scalars)
+    {
+        if (scalar.first == name)
+        {
+            value = scalar.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline const std::vector<ResultRecord::Table>&
+ResultRecord::GetTables() const
+{
+    return m_tables;
+}
+
+inline bool
+ResultRecord::Write(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        return false;
+    }
+    out.precision(std::numeric_limits<double>::max_digits10);
+    out << "LBREC 1\n";
+    for (const auto& parameter : m_parameters)
+    {
+        out << "p\t" << parameter.first << "\t" << parameter.second << "\n";
+    }
+    for (const auto& scalar : m_scalars)
+    {
+        out << "s\t" << scalar.first << "\t" << scalar.second << "\n";
+    }
+    for (const auto& table : m_tables)
+    {
+        out << "t\t" << table.name << "\t" << table.title;
+        for (const auto& column : table.columns)
+        {
+            out << "\t" << column;
+        }
+        out << "\n";
+        for (const auto& row : table.rows)
+        {
+            out << "r";
+            for (double value : row)
+            {
+                out << "\t" << value;
+            }
+            out << "\n";
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+inline bool
+ResultRecord::Read(const std::string& path)
+{
+    std::ifstream in(path);
+    std::string line;
+    if (!std::getline(in, line) || line != "LBREC 1")
+    {
+        return false;
+    }
+    m_parameters.clear();
+    m_scalars.clear();
+    m_tables.clear();
+    try
+    {
+        while (std::getline(in, line))
+        {
+            std::vector<std::string> fields = Split(line);
+            if (fields[0] == "p" && fields.size() == 3)
+            {
+                m_parameters[fields[1]] = fields[2];
+            }
+            else if (fields[0] == "s" && fields.size() == 3)
+            {
+                m_scalars.emplace_back(fields[1], std::stod(fields[2]));
+            }
+            else if (fields[0] == "t" && fields.size() >= 3)
+            {
+                m_tables.push_back({fields[1], fields[2], {fields.begin() + 3, fields.end()}, {}});
+            }
+            else if (fields[0] == "r" && !m_tables.empty())
+            {
+                std::vector<double> row;
+                for (size_t k = 1; k < fields.size(); ++k)
+                {
+                    row.push_back(std::stod(fields[k]));
+                }
+                m_tables.back().rows.push_back(row);
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        return false; // std::stod: not a number, or out of range
+    }
+    return true;
+}
+
+inline std::vector<std::string>
+ResultRecord::Split(const std::string& line)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true)
+    {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab - start));
+        if (tab == std::string::npos)
+        {
+            return fields;
+        }
+        start = tab + 1;
+    }
+}
+
+/**
+ * @param text Free text, e.g. a table title or a column name.
+ * @return @p text with the LaTeX special characters escaped, for the report tool
+ */
+inline std::string
+EscapeLatex(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '\\')
+        {
+            escaped += "\\textbackslash{}";
+        }
+        else if (c == '^' || c == '~')
+        {
+            escaped += std::string("\\") + c + "{}";
+        }
+        else
+        {
+            if (c == '_' || c == '%' || c == '&' || c == '#' || c == '$' || c == '{' || c == '}')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_RESULT_RECORD_H */
@@ -0,0 +1,299 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Append-only local store of scenario results.
+//
+// A run is identified by a key hashing its full configuration (every
+// parameter, in canonical key=value form), the RNG seed and run number, and
+// the build id. The store directory holds one <key>.cfg file per run with the
+// canonical configuration, the artifacts the run produced, and index.tsv,
+// which gets one line per finished run. Lines are only ever appended, with a
+// single write, so concurrent sweep workers can share a store. The index is
+// read once when the store is opened; afterwards only the lines appended
+// since, by this process or another one, are read, and only when a lookup
+// misses.
+
+#ifndef LORA_BRIDGE_RESULTS_STORE_H
+#define LORA_BRIDGE_RESULTS_STORE_H
+
+#include "ns3/nstime.h"
+#include "ns3/system-path.h"
+
+#include <cstdint>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Identifies the simulator sources. The lora-bridge CMakeLists passes a hash
+// of the scenario sources and the ns-3 revision; other builds share one id.
+#ifndef LORA_BRIDGE_BUILD_ID
+#define LORA_BRIDGE_BUILD_ID "unversioned"
+#endif
+
+namespace ns3
+{
+
+/**
+ * The full configuration of a scenario run, in canonical form.
+ */
+class ScenarioConfig
+{
+  public:
+    /**
+     * Set a parameter. Floating-point values keep full precision so that two
+     * configurations hash equal only if they simulate the same thing.
+     *
+     * @param key The parameter name.
+     * @param value The parameter value.
+     */
+    template <typename T>
+    void Set(const std::string& key, const T& value);
+
+    /// Times are stored as integer ticks, independent of the unit they were given in
+    void Set(const std::string& key, const Time& value);
+
+    /// @return The value of @p key, or an empty string
+    std::string Get(const std::string& key) const;
+
+    /// @return One "key=value" line per parameter, sorted by key
+    std::string GetCanonical() const;
+
+    /**
+     * @param seed The RNG seed of the run.
+     * @param run The RNG run number.
+     * @param buildId The build id of the simulator.
+     * @return The results-store key of the run, as 16 hex digits.
+     */
+    std::string GetKey(uint32_t seed, uint64_t run, const std::string& buildId) const;
+
+  private:
+    std::map<std::string, std::string> m_values; //!< Parameters, sorted by name
+};
+
+/**
+ * Directory of finished runs, indexed by ScenarioConfig key.
+ */
+class ResultsStore
+{
+  public:
+    /**
+     * Open a store, creating its directory if needed.
+     *
+     * @param directory The store directory.
+     */
+    explicit ResultsStore(const std::string& directory);
+
+    /// @return The store directory
+    std::string GetDirectory() const;
+
+    /**
+     * @param key A run key.
+     * @return Whether a finished run with this key is in the index.
+     */
+    bool Contains(const std::string& key) const;
+
+    /**
+     * @param key A run key.
+     * @return The artifact recorded for the run, or an empty string.
+     */
+    std::string GetArtifact(const std::string& key) const;
+
+    /// @return The keys of all the finished runs, sorted
+    std::vector<std::string> GetKeys() const;
+
+    /**
+     * @param name An artifact file name.
+     * @return Its path inside the store.
+     */
+    std::string GetPath(const std::string& name) const;
+
+    /**
+     * Record a finished run. Call only once all its artifacts are written:
+     * a run is considered done as soon as its index line exists.
+     *
+     * @param key The run key.
+     * @param canonicalConfig The canonical configuration of the run.
+     * @param artifact Path of the main artifact of the run.
+     * @return Whether the index line was written.
+     */
+    bool Commit(const std::string& key,
+                const std::string& canonicalConfig,
+                const std::string& artifact);
+
+  private:
+    /// Read the index lines appended since the last call into m_index
+    void Load() const;
+
+    std::string m_directory;                            //!< Store directory
+    mutable std::map<std::string, std::string> m_index; //!< Key to artifact
+    mutable std::streamoff m_indexOffset;               //!< Bytes of index.tsv already read
+};
+
+template <typename T>
+void
+ScenarioConfig::Set(const std::string& key, const T& value)
+{
+    std::ostringstream oss;
+    oss << std::setprecision(17) << std::boolalpha << value;
+    m_values[key] = oss.str();
+}
+
+inline void
+ScenarioConfig::Set(const std::string& key, const Time& value)
+{
+    m_values[key] = std::to_string(value.GetTimeStep());
+}
+
+inline std::string
+ScenarioConfig::Get(const std::string& key) const
+{
+    auto it = m_values.find(key);
+    return it == m_values.end() ? std::string() : it->second;
+}
+
+inline std::string
+ScenarioConfig::GetCanonical() const
+{
+    std::string canonical;
+    for (const auto& value : m_values)
+    {
+        canonical += value.first + "=" + value.second + "\n";
+    }
+    return canonical;
+}
+
+inline std::string
+ScenarioConfig::GetKey(uint32_t seed, uint64_t run, const std::string& buildId) const
+{
+    std::string text = GetCanonical() + "seed=" + std::to_string(seed) +
+                       "\nrun=" + std::to_string(run) + "\nbuild=" + buildId + "\n";
+
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return oss.str();
+}
+
+inline ResultsStore::ResultsStore(const std::string& directory)
+    : m_directory(directory),
+      m_indexOffset(0)
+{
+    SystemPath::MakeDirectories(m_directory);
+    Load();
+}
+
+inline std::string
+ResultsStore::GetDirectory() const
+{
+    return m_directory;
+}
+
+inline bool
+ResultsStore::Contains(const std::string& key) const
+{
+    if (m_index.count(key) == 0)
+    {
+        Load(); // Maybe committed by another process since
+    }
+    return m_index.count(key) > 0;
+}
+
+inline std::string
+ResultsStore::GetArtifact(const std::string& key) const
+{
+    if (m_index.count(key) == 0)
+    {
+        Load();
+    }
+    auto it = m_index.find(key);
+    return it == m_index.end() ? std::string() : it->second;
+}
+
+inline std::vector<std::string>
+ResultsStore::GetKeys() const
+{
+    Load();
+    std::vector<std::string> keys;
+    for (const auto& entry : m_index)
+    {
+        keys.push_back(entry.first);
+    }
+    return keys;
+}
+
+inline std::string
+ResultsStore::GetPath(const std::string& name) const
+{
+    return m_directory + "/" + name;
+}
+
+inline bool
+ResultsStore::Commit(const std::string& key,
+                     const std::string& canonicalConfig,
+                     const std::string& artifact)
+{
+    std::ofstream cfg(GetPath(key + ".cfg"));
+    cfg << canonicalConfig;
+    cfg.close();
+
+    std::ostringstream line;
+    line << key << "\t" << std::time(nullptr) << "\t" << artifact << "\n";
+    std::string text = line.str();
+
+    // One write on an O_APPEND descriptor: lines from concurrent runs never interleave
+    int fd = open(GetPath("index.tsv").c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool written = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fd);
+    if (written)
+    {
+        m_index[key] = artifact;
+    }
+    return written;
+}
+
+inline void
+ResultsStore::Load() const
+{
+    std::ifstream index(GetPath("index.tsv"));
+    if (!index.seekg(m_indexOffset))
+    {
+        return;
+    }
+    std::string line;
+    while (std::getline(index, line))
+    {
+        if (index.eof())
+        {
+            break; // Partial line of a run that is still writing: read it again next time
+        }
+        m_indexOffset += line.size() + 1;
+        size_t first = line.find('\t');
+        size_t second = line.find('\t', first + 1);
+        if (first == std::string::npos || second == std::string::npos)
+        {
+            continue;
+        }
+        m_index[line.substr(0, first)] = line.substr(second + 1);
+    }
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_RESULTS_STORE_H */
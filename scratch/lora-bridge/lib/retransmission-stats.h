@@ -0,0 +1,258 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Confirmed-uplink retransmission analytics.
+//
+// Fed from the RequiredTransmissions trace of EndDeviceLorawanMac, which fires
+// once per uplink with the number of transmissions it took, whether it was
+// acknowledged and the time of the first attempt. Outcomes are accumulated per
+// node and per spreading factor; every transmission beyond the first is
+// charged as retry airtime and retry energy.
+
+#ifndef LORA_BRIDGE_RETRANSMISSION_STATS_H
+#define LORA_BRIDGE_RETRANSMISSION_STATS_H
+
+#include "ns3/nstime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Per-node and per-SF retransmission accounting.
+ */
+class RetransmissionStats
+{
+  public:
+    /// Largest number of transmissions tracked individually; more go in the last bin
+    static constexpr uint8_t MAX_ATTEMPTS = 15;
+
+    /// Counters of one node or one spreading factor
+    struct Entry
+    {
+        std::vector<uint64_t> attempts = std::vector<uint64_t>(MAX_ATTEMPTS + 1, 0); //!< Uplinks per transmission count
+        uint64_t successes = 0;        //!< Acknowledged uplinks
+        uint64_t failures = 0;         //!< Uplinks that ran out of transmissions
+        uint64_t retries = 0;          //!< Transmissions beyond the first one
+        double timeToSuccessSum = 0;   //!< Sum of first-attempt-to-ACK delays (s)
+        double timeToSuccessMax = 0;   //!< Largest first-attempt-to-ACK delay (s)
+        double retryAirtime = 0;       //!< Airtime spent on retries (s)
+        double retryEnergy = 0;        //!< Radio energy spent on retries (J)
+
+        /// @return The mean number of transmissions per uplink
+        double GetMeanAttempts() const;
+
+        /// @return The fraction of uplinks that were never acknowledged
+        double GetFailureRate() const;
+
+        /// @return The mean delay from first attempt to ACK (s)
+        double GetMeanTimeToSuccess() const;
+    };
+
+    RetransmissionStats();
+
+    /**
+     * @param nDevices The number of devices to track.
+     */
+    void SetDeviceCount(uint32_t nDevices);
+
+    /**
+     * Radio parameters used to charge retry energy. Every retry costs its
+     * airtime at the TX current, plus the two receive windows that the failed
+     * attempt before it kept open at the RX current.
+     *
+     * @param voltageV Supply voltage (V).
+     * @param txCurrentA Current drawn while transmitting (A).
+     * @param rxCurrentA Current drawn while a receive window is open (A).
+     * @param rxWindowSymbols Length of a receive window, in symbols.
+     */
+    void SetRadioParameters(double voltageV,
+                            double txCurrentA,
+                            double rxCurrentA,
+                            uint32_t rxWindowSymbols);
+
+    /**
+     * Record the outcome of one uplink.
+     *
+     * @param device Index of the sending device.
+     * @param sf Spreading factor used for the uplink.
+     * @param transmissions Number of transmissions it took.
+     * @param successful Whether the uplink was acknowledged.
+     * @param timeToOutcome Delay from the first attempt to the outcome.
+     * @param attemptAirtime Airtime of a single transmission (s).
+     */
+    void RecordOutcome(uint32_t device,
+                       uint8_t sf,
+                       uint8_t transmissions,
+                       bool successful,
+                       Time timeToOutcome,
+                       double attemptAirtime);
+
+    /// @return The counters of device @p device
+    const Entry& GetNode(uint32_t device) const;
+
+    /// @return The counters of spreading factor @p sf (7 to 12)
+    const Entry& GetSpreadingFactor(uint8_t sf) const;
+
+    /// @return The counters of the whole fleet
+    const Entry& GetTotal() const;
+
+    /// @return The number of tracked devices
+    uint32_t GetDeviceCount() const;
+
+  private:
+    /// Add one outcome to an entry
+    void Add(Entry& entry,
+             uint8_t transmissions,
+             bool successful,
+             double timeToOutcome,
+             double retryAirtime,
+             double retryEnergy);
+
+    std::vector<Entry> m_nodes; //!< Per-node counters
+    std::vector<Entry> m_sfs;   //!< Per-SF counters, SF7 first
+    Entry m_total;              //!< Fleet counters
+    double m_voltage;           //!< Supply voltage (V)
+    double m_txCurrent;         //!< TX current (A)
+    double m_rxCurrent;         //!< RX current (A)
+    uint32_t m_rxWindowSymbols; //!< Receive window length (symbols)
+};
+
+inline double
+RetransmissionStats::Entry::GetMeanAttempts() const
+{
+    uint64_t uplinks = 0;
+    uint64_t transmissions = 0;
+    for (size_t n = 1; n < attempts.size(); ++n)
+    {
+        uplinks += attempts[n];
+        transmissions += n * attempts[n];
+    }
+    return uplinks ? static_cast<double>(transmissions) / uplinks : 0.0;
+}
+
+inline double
+RetransmissionStats::Entry::GetFailureRate() const
+{
+    uint64_t uplinks = successes + failures;
+    return uplinks ? static_cast<double>(failures) / uplinks : 0.0;
+}
+
+inline double
+RetransmissionStats::Entry::GetMeanTimeToSuccess() const
+{
+    return successes ? timeToSuccessSum / successes : 0.0;
+}
+
+inline RetransmissionStats::RetransmissionStats()
+    : m_sfs(6),
+      m_voltage(3.3),
+      m_txCurrent(0.090),
+      m_rxCurrent(0.011),
+      m_rxWindowSymbols(8)
+{
+}
+
+inline void
+RetransmissionStats::SetDeviceCount(uint32_t nDevices)
+{
+    m_nodes.resize(nDevices);
+}
+
+inline void
+RetransmissionStats::SetRadioParameters(double voltageV,
+                                        double txCurrentA,
+                                        double rxCurrentA,
+                                        uint32_t rxWindowSymbols)
+{
+    m_voltage = voltageV;
+    m_txCurrent = txCurrentA;
+    m_rxCurrent = rxCurrentA;
+    m_rxWindowSymbols = rxWindowSymbols;
+}
+
+inline void
+RetransmissionStats::RecordOutcome(uint32_t device,
+                                   uint8_t sf,
+                                   uint8_t transmissions,
+                                   bool successful,
+                                   Time timeToOutcome,
+                                   double attemptAirtime)
+{
+    if (sf < 7 || sf > 12)
+    {
+        sf = 7;
+    }
+    uint8_t retries = transmissions > 0 ? transmissions - 1 : 0;
+
+    // RX1 listens on the uplink SF, RX2 on SF12 (EU868 default)
+    double rxWindows = m_rxWindowSymbols * ((1 << sf) + (1 << 12)) / 125000.0;
+    double retryAirtime = retries * attemptAirtime;
+    double retryEnergy =
+        retries * m_voltage * (attemptAirtime * m_txCurrent + rxWindows * m_rxCurrent);
+    double delay = timeToOutcome.GetSeconds();
+
+    if (device >= m_nodes.size())
+    {
+        m_nodes.resize(device + 1);
+    }
+    Add(m_nodes[device], transmissions, successful, delay, retryAirtime, retryEnergy);
+    Add(m_sfs[sf - 7], transmissions, successful, delay, retryAirtime, retryEnergy);
+    Add(m_total, transmissions, successful, delay, retryAirtime, retryEnergy);
+}
+
+inline void
+RetransmissionStats::Add(Entry& entry,
+                         uint8_t transmissions,
+                         bool successful,
+                         double timeToOutcome,
+                         double retryAirtime,
+                         double retryEnergy)
+{
+    entry.attempts[std::min<uint8_t>(std::max<uint8_t>(transmissions, 1), MAX_ATTEMPTS)]++;
+    entry.retries += transmissions > 0 ? transmissions - 1 : 0;
+    entry.retryAirtime += retryAirtime;
+    entry.retryEnergy += retryEnergy;
+    if (successful)
+    {
+        entry.successes++;
+        entry.timeToSuccessSum += timeToOutcome;
+        entry.timeToSuccessMax = std::max(entry.timeToSuccessMax, timeToOutcome);
+    }
+    else
+    {
+        entry.failures++;
+    }
+}
+
+inline const RetransmissionStats::Entry&
+RetransmissionStats::GetNode(uint32_t device) const
+{
+    return m_nodes.at(device);
+}
+
+inline const RetransmissionStats::Entry&
+RetransmissionStats::GetSpreadingFactor(uint8_t sf) const
+{
+    return m_sfs.at(sf - 7);
+}
+
+inline const RetransmissionStats::Entry&
+RetransmissionStats::GetTotal() const
+{
+    return m_total;
+}
+
+inline uint32_t
+RetransmissionStats::GetDeviceCount() const
+{
+    return m_nodes.size();
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_RETRANSMISSION_STATS_H */
@@ -0,0 +1,271 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Choice of the event scheduler backend.
+//
+// All ns-3 schedulers run the events in the same (time, uid) order, so the
+// backend never changes the results, only the speed, and how much depends on
+// the workload. A few devices with long periods keep a short queue, which
+// any backend handles. Dense polling churns a mid-sized queue. Large fleets
+// hold huge queues of near-uniform periodic events, where the calendar
+// queue's O(1) operations can beat the O(log n) of the map and heap.
+//
+// Calibrate() measures instead of guessing. Once the scenario is built, it
+// forks one child per backend, in turn. Each child installs its backend,
+// simulates the first Prefix of the run with its output discarded, and
+// reports the wall-clock time through a pipe. The parent keeps the fastest
+// backend and simulates the whole run itself. A child slower than the
+// timeout, or than twice the best so far, is killed. Calibrate before
+// anything that writes files during the run (NetAnim, pcap) is set up and
+// before any thread is started, as with the fork server.
+
+#ifndef LORA_BRIDGE_SCHEDULER_TUNER_H
+#define LORA_BRIDGE_SCHEDULER_TUNER_H
+
+#include "counting-scheduler.h"
+
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Selection and calibration of the event scheduler.
+ */
+class SchedulerTuner
+{
+  public:
+    /// Outcome of one calibration child
+    struct Timing
+    {
+        std::string backend;   //!< Backend name
+        double wallSeconds = 0.0; //!< Wall-clock time of the prefix (s), infinity if not finished
+        bool finished = false; //!< Whether the child simulated the whole prefix
+    };
+
+    SchedulerTuner();
+
+    /// @return The backend names: Map, Heap, Calendar, List and PriorityQueue
+    static const std::vector<std::pair<std::string, std::string>>& GetBackends();
+
+    /**
+     * @param backend A backend name.
+     * @return Its TypeId name, or an empty string if the name is unknown
+     */
+    static std::string GetTypeName(const std::string& backend);
+
+    /**
+     * Make @p backend the scheduler of the simulator.
+     *
+     * @param backend A backend name.
+     * @param counting Whether to wrap it in a CountingScheduler.
+     * @return Whether the name was known.
+     */
+    static bool Install(const std::string& backend, bool counting);
+
+    /// @param prefix Simulated time each backend is timed on.
+    void SetPrefix(Time prefix);
+
+    /// @param seconds Wall-clock time after which a backend is given up (s).
+    void SetTimeout(double seconds);
+
+    /**
+     * Time every backend on the prefix of the run.
+     *
+     * @return The fastest backend, Map if none finished
+     */
+    std::string Calibrate();
+
+    /// @return The timing of every backend, in calibration order
+    const std::vector<Timing>& GetTimings() const;
+
+  private:
+    /// Child side: simulate the prefix and write its wall-clock time to @p fd
+    void RunChild(const std::string& backend, int fd) const;
+
+    Time m_prefix;                 //!< Simulated time of the calibration runs
+    double m_timeout;              //!< Wall-clock limit of one calibration run (s)
+    std::vector<Timing> m_timings; //!< Outcome per backend
+};
+
+inline SchedulerTuner::SchedulerTuner()
+    : m_prefix(Hours(1)),
+      m_timeout(60.0)
+{
+}
+
+inline const std::vector<std::pair<std::string, std::string>>&
+SchedulerTuner::GetBackends()
+{
+    static const std::vector<std::pair<std::string, std::string>> backends = {
+        {"Map", "ns3::MapScheduler"},
+        {"Heap", "ns3::HeapScheduler"},
+        {"Calendar", "ns3::CalendarScheduler"},
+        {"List", "ns3::ListScheduler"},
+        {"PriorityQueue", "ns3::PriorityQueueScheduler"},
+    };
+    return backends;
+}
+
+inline std::string
+SchedulerTuner::GetTypeName(const std::string& backend)
+{
+    for (const auto& entry : GetBackends())
+    {
+        if (entry.first == backend)
+        {
+            return entry.second;
+        }
+    }
+    return "";
+}
+
+inline bool
+SchedulerTuner::Install(const std::string& backend, bool counting)
+{
+    std::string typeName = GetTypeName(backend);
+    if (typeName.empty())
+    {
+        return false;
+    }
+    ObjectFactory factory;
+    if (counting)
+    {
+        factory.SetTypeId(CountingScheduler::GetTypeId());
+        factory.Set("InnerType", StringValue(typeName));
+    }
+    else
+    {
+        factory.SetTypeId(typeName);
+    }
+    Simulator::SetScheduler(factory);
+    return true;
+}
+
+inline void
+SchedulerTuner::SetPrefix(Time prefix)
+{
+    m_prefix = prefix;
+}
+
+inline void
+SchedulerTuner::SetTimeout(double seconds)
+{
+    m_timeout = seconds;
+}
+
+inline std::string
+SchedulerTuner::Calibrate()
+{
+    m_timings.clear();
+    std::string best = "Map";
+    double bestSeconds = std::numeric_limits<double>::infinity();
+    for (const auto& entry : GetBackends())
+    {
+        Timing timing;
+        timing.backend = entry.first;
+        timing.wallSeconds = std::numeric_limits<double>::infinity();
+
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            m_timings.push_back(timing);
+            continue;
+        }
+        // Buffered output would otherwise be written by the parent and the child
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            RunChild(entry.first, fds[1]);
+        }
+        close(fds[1]);
+        if (pid < 0)
+        {
+            close(fds[0]);
+            m_timings.push_back(timing);
+            continue;
+        }
+
+        double limit = std::min(m_timeout, 2 * bestSeconds);
+        auto start = std::chrono::steady_clock::now();
+        int status = 0;
+        while (waitpid(pid, &status, WNOHANG) == 0)
+        {
+            if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > limit)
+            {
+                kill(pid, SIGKILL);
+                waitpid(pid, &status, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        double seconds;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+            read(fds[0], &seconds, sizeof(seconds)) == static_cast<ssize_t>(sizeof(seconds)))
+        {
+            timing.wallSeconds = seconds;
+            timing.finished = true;
+            if (seconds < bestSeconds)
+            {
+                bestSeconds = seconds;
+                best = entry.first;
+            }
+        }
+        close(fds[0]);
+        m_timings.push_back(timing);
+    }
+    return best;
+}
+
+inline void
+SchedulerTuner::RunChild(const std::string& backend, int fd) const
+{
+    int null = open("/dev/null", O_WRONLY);
+    if (null >= 0)
+    {
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+    }
+    Install(backend, false);
+    Simulator::Stop(m_prefix);
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool written = write(fd, &seconds, sizeof(seconds)) == static_cast<ssize_t>(sizeof(seconds));
+    // No destructors or exit handlers: the parent still owns the files and the simulation
+    _exit(written ? 0 : 1);
+}
+
+inline const std::vector<SchedulerTuner::Timing>&
+SchedulerTuner::GetTimings() const
+{
+    return m_timings;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_SCHEDULER_TUNER_H */
@@ -0,0 +1,352 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Airtime-balanced spreading factor allocation.
+//
+// LorawanMacHelper::SetSpreadingFactorsUp gives every device the lowest SF
+// its link supports, so a compact fleet ends up entirely on SF7. Here each
+// device may use any SF whose gateway sensitivity its mean receive power
+// clears by the link margin, and the SFs are chosen to minimise the airtime
+// lost to same-SF collisions. SFs are treated as orthogonal and each SF
+// carries pure ALOHA traffic spread evenly over the uplink channels: an
+// uplink on an SF with offered load G per channel overlaps 2G others on
+// average and collides with probability 1 - exp(-2G). The cost weights each
+// device's airtime with that overlap count, i.e. the sum over the SFs of
+// 2G^2 times the number of channels. The count rather than the probability
+// is used because the probability saturates: an overloaded SF would have
+// nothing left to lose and keep its devices.
+//
+// The cost is convex in each SF's load, so a greedy placement (most
+// constrained devices first, then the heaviest) followed by a few passes of
+// single-device moves reaches a good allocation in O(N log N + passes * 6N);
+// fleets of 100k devices take milliseconds.
+
+#ifndef LORA_BRIDGE_SF_ALLOCATOR_H
+#define LORA_BRIDGE_SF_ALLOCATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Per-device SF choice that minimises the expected collided airtime.
+ */
+class SfAllocator
+{
+  public:
+    SfAllocator();
+
+    /// @return The gateway sensitivity at @p sf on a 125 kHz channel (dBm), as used by the lorawan module
+    static double GetGatewaySensitivity(uint8_t sf);
+
+    /**
+     * @param payloadSize PHY payload size (bytes), LoRaWAN headers included.
+     * @param sf Spreading factor, 7 to 12.
+     * @return The time on air at 125 kHz, CR 4/5, explicit header and CRC (s).
+     */
+    static double GetTimeOnAir(uint32_t payloadSize, uint8_t sf);
+
+    /**
+     * @param nChannels Uplink channels the traffic is spread over.
+     */
+    void SetChannelCount(uint32_t nChannels);
+
+    /**
+     * @param marginDb Margin over the gateway sensitivity an SF must leave (dB).
+     */
+    void SetLinkMargin(double marginDb);
+
+    /**
+     * Add a device; devices are numbered in the order they are added.
+     *
+     * @param rxPowerDbm Mean receive power at the best gateway (dBm).
+     * @param packetsPerSecond Uplink rate of the device.
+     * @param payloadSize PHY payload size of its uplinks (bytes).
+     * @return The index of the device.
+     */
+    uint32_t AddDevice(double rxPowerDbm, double packetsPerSecond, uint32_t payloadSize);
+
+    /**
+     * Compute the allocation. Devices that no SF serves with the margin get SF12.
+     *
+     * @param maxPasses Largest number of improvement passes after the greedy placement.
+     */
+    void Solve(uint32_t maxPasses = 8);
+
+    /// @return The SF of device @p device, valid after Solve()
+    uint8_t GetSpreadingFactor(uint32_t device) const;
+
+    /// @return The lowest SF device @p device may use
+    uint8_t GetMinSpreadingFactor(uint32_t device) const;
+
+    /// @return The number of devices on @p sf
+    uint32_t GetDeviceCount(uint8_t sf) const;
+
+    /// @return The offered load on @p sf per channel (Erlang)
+    double GetLoad(uint8_t sf) const;
+
+    /// @return The probability that an uplink on @p sf overlaps another one on the same SF and channel
+    double GetCollisionProbability(uint8_t sf) const;
+
+    /// @return The airtime-weighted expected overlap count of the allocation, over all channels and SFs
+    double GetCost() const;
+
+    /// @return The number of devices that no SF serves with the margin
+    uint32_t GetOutOfRangeCount() const;
+
+    /// @return The number of improvement passes the last Solve() ran
+    uint32_t GetPassCount() const;
+
+  private:
+    /// One device to place
+    struct Device
+    {
+        double rate;     //!< Uplinks per second
+        uint32_t size;   //!< PHY payload size (bytes)
+        uint8_t minSf;   //!< Lowest SF that clears the margin
+        uint8_t sf;      //!< Allocated SF
+    };
+
+    /// @return The cost of an SF with total offered load @p load
+    double SfCost(double load) const;
+
+    /// @return The offered load of @p device on @p sf (Erlang)
+    double GetDemand(const Device& device, uint8_t sf) const;
+
+    /// @return The SF in [device.minSf, 12] where adding @p device raises the cost least
+    uint8_t FindBest(const Device& device) const;
+
+    std::vector<Device> m_devices;          //!< Devices, in the order added
+    std::vector<double> m_load;             //!< Total offered load per SF 7..12 (Erlang)
+    std::vector<uint32_t> m_count;          //!< Devices per SF 7..12
+    std::vector<std::vector<double>> m_toa; //!< Time on air per payload size and SF, memoised
+    uint32_t m_channels;                    //!< Uplink channels
+    double m_margin;                        //!< Link margin (dB)
+    uint32_t m_outOfRange;                  //!< Devices without a feasible SF
+    uint32_t m_passes;                      //!< Passes of the last Solve()
+};
+
+inline SfAllocator::SfAllocator()
+    : m_load(6, 0.0),
+      m_count(6, 0),
+      m_channels(1),
+      m_margin(0.0),
+      m_outOfRange(0),
+      m_passes(0)
+{
+}
+
+inline double
+SfAllocator::GetGatewaySensitivity(uint8_t sf)
+{
+    static const double sensitivity[6] = {-130.0, -132.5, -135.0, -137.5, -140.0, -142.5};
+    return sensitivity[std::min<uint8_t>(std::max<uint8_t>(sf, 7), 12) - 7];
+}
+
+inline double
+SfAllocator::GetTimeOnAir(uint32_t payloadSize, uint8_t sf)
+{
+    double symbol = (1 << sf) / 125000.0;
+    int lowDataRate = (sf >= 11) ? 1 : 0;
+    double payloadSymbols =
+        8 + std::max(std::ceil((8.0 * payloadSize - 4.0 * sf + 28 + 16) / (4.0 * (sf - 2 * lowDataRate))) * 5,
+                     0.0);
+    return (8 + 4.25 + payloadSymbols) * symbol;
+}
+
+inline void
+SfAllocator::SetChannelCount(uint32_t nChannels)
+{
+    m_channels = std::max<uint32_t>(nChannels, 1);
+}
+
+inline void
+SfAllocator::SetLinkMargin(double marginDb)
+{
+    m_margin = marginDb;
+}
+
+inline uint32_t
+SfAllocator::AddDevice(double rxPowerDbm, double packetsPerSecond, uint32_t payloadSize)
+{
+    Device device;
+    device.rate = packetsPerSecond;
+    device.size = payloadSize;
+    device.minSf = 12;
+    for (uint8_t sf = 7; sf <= 12; ++sf)
+    {
+        if (rxPowerDbm - GetGatewaySensitivity(sf) >= m_margin)
+        {
+            device.minSf = sf;
+            break;
+        }
+    }
+    if (rxPowerDbm - GetGatewaySensitivity(12) < m_margin)
+    {
+        m_outOfRange++;
+    }
+    device.sf = device.minSf;
+    if (payloadSize >= m_toa.size())
+    {
+        m_toa.resize(payloadSize + 1);
+    }
+    if (m_toa[payloadSize].empty())
+    {
+        for (uint8_t sf = 7; sf <= 12; ++sf)
+        {
+            m_toa[payloadSize].push_back(GetTimeOnAir(payloadSize, sf));
+        }
+    }
+    m_devices.push_back(device);
+    return m_devices.size() - 1;
+}
+
+inline void
+SfAllocator::Solve(uint32_t maxPasses)
+{
+    std::fill(m_load.begin(), m_load.end(), 0.0);
+    std::fill(m_count.begin(), m_count.end(), 0);
+
+    // Greedy placement: the devices with the fewest choices go first, then the heaviest
+    std::vector<uint32_t> order(m_devices.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        const Device& da = m_devices[a];
+        const Device& db = m_devices[b];
+        if (da.minSf != db.minSf)
+        {
+            return da.minSf > db.minSf;
+        }
+        double demandA = GetDemand(da, da.minSf);
+        double demandB = GetDemand(db, db.minSf);
+        return demandA != demandB ? demandA > demandB : a < b;
+    });
+    for (uint32_t i : order)
+    {
+        Device& device = m_devices[i];
+        device.sf = FindBest(device);
+        m_load[device.sf - 7] += GetDemand(device, device.sf);
+        m_count[device.sf - 7]++;
+    }
+
+    // Move single devices while that lowers the cost
+    for (m_passes = 0; m_passes < maxPasses;)
+    {
+        m_passes++;
+        uint32_t moves = 0;
+        for (uint32_t i : order)
+        {
+            Device& device = m_devices[i];
+            m_load[device.sf - 7] -= GetDemand(device, device.sf);
+            m_count[device.sf - 7]--;
+            uint8_t best = FindBest(device);
+            if (best != device.sf)
+            {
+                device.sf = best;
+                moves++;
+            }
+            m_load[device.sf - 7] += GetDemand(device, device.sf);
+            m_count[device.sf - 7]++;
+        }
+        if (moves == 0)
+        {
+            break;
+        }
+    }
+}
+
+inline uint8_t
+SfAllocator::GetSpreadingFactor(uint32_t device) const
+{
+    return m_devices.at(device).sf;
+}
+
+inline uint8_t
+SfAllocator::GetMinSpreadingFactor(uint32_t device) const
+{
+    return m_devices.at(device).minSf;
+}
+
+inline uint32_t
+SfAllocator::GetDeviceCount(uint8_t sf) const
+{
+    return (sf >= 7 && sf <= 12) ? m_count[sf - 7] : 0;
+}
+
+inline double
+SfAllocator::GetLoad(uint8_t sf) const
+{
+    return (sf >= 7 && sf <= 12) ? m_load[sf - 7] / m_channels : 0.0;
+}
+
+inline double
+SfAllocator::GetCollisionProbability(uint8_t sf) const
+{
+    return 1.0 - std::exp(-2.0 * GetLoad(sf));
+}
+
+inline double
+SfAllocator::GetCost() const
+{
+    double cost = 0.0;
+    for (double load : m_load)
+    {
+        cost += SfCost(load);
+    }
+    return cost;
+}
+
+inline uint32_t
+SfAllocator::GetOutOfRangeCount() const
+{
+    return m_outOfRange;
+}
+
+inline uint32_t
+SfAllocator::GetPassCount() const
+{
+    return m_passes;
+}
+
+inline double
+SfAllocator::SfCost(double load) const
+{
+    return 2.0 * load * load / m_channels;
+}
+
+inline double
+SfAllocator::GetDemand(const Device& device, uint8_t sf) const
+{
+    return device.rate * m_toa[device.size][sf - 7];
+}
+
+inline uint8_t
+SfAllocator::FindBest(const Device& device) const
+{
+    // Ties go to the lower SF, which costs the device less energy
+    uint8_t best = device.minSf;
+    double bestIncrease = 0.0;
+    for (uint8_t sf = device.minSf; sf <= 12; ++sf)
+    {
+        double load = m_load[sf - 7];
+        double increase = SfCost(load + GetDemand(device, sf)) - SfCost(load);
+        if (sf == device.minSf || increase < bestIncrease)
+        {
+            best = sf;
+            bestIncrease = increase;
+        }
+    }
+    return best;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_SF_ALLOCATOR_H */
@@ -0,0 +1,505 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Trace-driven traffic replay.
+//
+// A trace is a binary file made of an ArrivalTraceHeader followed by
+// ArrivalTraceRecord entries sorted by timestamp. The file is memory-mapped
+// and consumed with a cursor: only the records that fall within the next
+// Lookahead window (at most MaxBatch of them) sit in the event queue at any
+// time, and the pages behind the cursor are handed back to the kernel.
+
+#ifndef LORA_BRIDGE_TRACE_REPLAY_H
+#define LORA_BRIDGE_TRACE_REPLAY_H
+
+#include "ns3/boolean.h"
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+/// File header of a binary arrival trace
+struct ArrivalTraceHeader
+{
+    char magic[8];       //!< "LBTRACE1"
+    uint32_t recordSize; //!< sizeof(ArrivalTraceRecord), to catch layout changes
+    uint32_t reserved;   //!< Padding, must be zero
+    uint64_t count;      //!< Number of records following the header
+};
+
+/// One uplink of a binary arrival trace
+struct ArrivalTraceRecord
+{
+    uint64_t timestampUs; //!< Arrival time in microseconds since the trace epoch
+    uint32_t deviceId;    //!< Index of the sending device
+    uint16_t payloadSize; //!< Application payload size in bytes
+    uint16_t reserved;    //!< Padding, must be zero
+};
+
+static_assert(sizeof(ArrivalTraceHeader) == 24, "Unexpected trace header layout");
+static_assert(sizeof(ArrivalTraceRecord) == 16, "Unexpected trace record layout");
+
+/**
+ * Write a binary arrival trace.
+ *
+ * @param path The output file.
+ * @param records The records, already sorted by timestamp.
+ * @return Whether the file was written successfully.
+ */
+inline bool
+WriteArrivalTrace(const std::string& path, const std::vector<ArrivalTraceRecord>& records)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+    ArrivalTraceHeader header;
+    std::memcpy(header.magic, "LBTRACE1", 8);
+    header.recordSize = sizeof(ArrivalTraceRecord);
+    header.reserved = 0;
+    header.count = records.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()),
+              records.size() * sizeof(ArrivalTraceRecord));
+    return out.good();
+}
+
+/**
+ * Convert a CSV export of field uplinks ("device,timestamp_s,payload_bytes",
+ * one per line, '#' starts a comment) into a binary arrival trace. Records are
+ * sorted by timestamp before being written. Lines that do not parse, or hold
+ * a negative or non-finite time, a device id or a payload size out of range,
+ * are skipped.
+ *
+ * @param csvPath The CSV file to read.
+ * @param tracePath The binary trace to write.
+ * @param errors If not null, receives one "line N: reason" entry per skipped line.
+ * @return The number of records written, or -1 on error.
+ */
+inline int64_t
+ConvertCsvArrivalTrace(const std::string& csvPath,
+                       const std::string& tracePath,
+                       std::vector<std::string>* errors = nullptr)
+{
+    std::ifstream in(csvPath);
+    if (!in)
+    {
+        return -1;
+    }
+    std::vector<ArrivalTraceRecord> records;
+    std::string line;
+    uint64_t lineNumber = 0;
+    auto skip = [&errors, &lineNumber](const std::string& reason) {
+        if (errors)
+        {
+            errors->push_back("line " + std::to_string(lineNumber) + ": " + reason);
+        }
+    };
+    while (std::getline(in, line))
+    {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string device;
+        std::string timestamp;
+        std::string size;
+        if (!std::getline(fields, device, ',') || !std::getline(fields, timestamp, ',') ||
+            !std::getline(fields, size, ','))
+        {
+            skip("expected device,timestamp_s,payload_bytes");
+            continue;
+        }
+        double seconds;
+        unsigned long long deviceId;
+        unsigned long long payloadSize;
+        try
+        {
+            size_t end;
+            seconds = std::stod(timestamp, &end);
+            if (timestamp.find_first_not_of(" \t", end) != std::string::npos)
+            {
+                throw std::invalid_argument("timestamp");
+            }
+            // stoull accepts a leading minus sign and wraps the value around
+            if (device.find('-') != std::string::npos || size.find('-') != std::string::npos)
+            {
+                throw std::out_of_range("negative field");
+            }
+            deviceId = std::stoull(device);
+            payloadSize = std::stoull(size);
+        }
+        catch (const std::exception&)
+        {
+            skip("invalid number in \"" + line + "\"");
+            continue;
+        }
+        double microseconds = std::round(seconds * 1e6);
+        if (!std::isfinite(seconds) || seconds < 0.0 || microseconds >= 18446744073709551616.0)
+        {
+            skip("timestamp " + timestamp + " out of range");
+            continue;
+        }
+        if (deviceId > UINT32_MAX || payloadSize > UINT16_MAX)
+        {
+            skip("device id or payload size out of range");
+            continue;
+        }
+        ArrivalTraceRecord record;
+        record.timestampUs = static_cast<uint64_t>(microseconds); // Nearest: 1.000001 s is not 999999.99 us
+        record.deviceId = static_cast<uint32_t>(deviceId);
+        record.payloadSize = static_cast<uint16_t>(payloadSize);
+        record.reserved = 0;
+        records.push_back(record);
+    }
+    std::stable_sort(records.begin(),
+                     records.end(),
+                     [](const ArrivalTraceRecord& a, const ArrivalTraceRecord& b) {
+                         return a.timestampUs < b.timestampUs;
+                     });
+    if (!WriteArrivalTrace(tracePath, records))
+    {
+        return -1;
+    }
+    return static_cast<int64_t>(records.size());
+}
+
+/**
+ * Replays a memory-mapped arrival trace by invoking a send callback at each
+ * record's timestamp.
+ */
+class TraceReplayGenerator : public Object
+{
+  public:
+    static TypeId GetTypeId();
+
+    TraceReplayGenerator();
+    ~TraceReplayGenerator() override;
+
+    /// Callback run for every replayed record: device id and payload size
+    typedef Callback<void, uint32_t, uint32_t> SendCallback;
+
+    /**
+     * Map a trace file.
+     *
+     * @param path The binary trace.
+     * @return Whether the trace could be mapped and its header is valid.
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * @param send The callback run for every replayed record.
+     */
+    void SetSendCallback(SendCallback send);
+
+    /**
+     * Start replaying. The first record is played at @p start plus its offset
+     * from the trace epoch (or from the first record, see RebaseToFirstRecord).
+     *
+     * @param start Simulation time matching the trace origin.
+     * @param stop Records after this time are not replayed.
+     */
+    void Start(Time start, Time stop);
+
+    /// @return The number of records in the trace
+    uint64_t GetRecordCount() const;
+
+    /// @return The number of records handed to the send callback so far
+    uint64_t GetReplayedCount() const;
+
+    /// @return The number of records that were not sorted and got played late
+    uint64_t GetOutOfOrderCount() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Schedule the records of the next lookahead window
+    void Pump();
+
+    /// Run the send callback for one record
+    void Play(uint32_t deviceId, uint32_t payloadSize);
+
+    /// @return The simulation time of record @p index
+    Time RecordTime(uint64_t index) const;
+
+    /// Unmap the trace file
+    void Close();
+
+    Time m_lookahead;           //!< Width of the scheduling window
+    uint32_t m_maxBatch;        //!< Maximum number of records scheduled per window
+    bool m_rebase;              //!< Whether the first record is played at the start time
+
+    const uint8_t* m_map;       //!< Start of the mapping
+    size_t m_mapSize;           //!< Length of the mapping
+    const ArrivalTraceRecord* m_records; //!< First record in the mapping
+    uint64_t m_count;           //!< Number of records
+    uint64_t m_cursor;          //!< Next record to schedule
+    uint64_t m_released;        //!< Records whose pages were given back to the kernel
+    uint64_t m_replayed;        //!< Records played so far
+    uint64_t m_outOfOrder;      //!< Records played later than their timestamp
+    uint64_t m_epochUs;         //!< Trace timestamp matching the start time
+    Time m_start;               //!< Simulation time of the trace epoch
+    Time m_stop;                //!< End of the replay
+    EventId m_pumpEvent;        //!< Next window refill
+    SendCallback m_send;        //!< Per-record callback
+};
+
+inline TypeId
+TraceReplayGenerator::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::TraceReplayGenerator")
+            .SetParent<Object>()
+            .SetGroupName("LoraBridge")
+            .AddConstructor<TraceReplayGenerator>()
+            .AddAttribute("Lookahead",
+                          "Only records within this window ahead of now are scheduled",
+                          TimeValue(Seconds(60)),
+                          MakeTimeAccessor(&TraceReplayGenerator::m_lookahead),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("MaxBatch",
+                          "Maximum number of records scheduled by one window refill",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&TraceReplayGenerator::m_maxBatch),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("RebaseToFirstRecord",
+                          "Play the first record at the start time instead of at its "
+                          "offset from the trace epoch",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&TraceReplayGenerator::m_rebase),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+inline TraceReplayGenerator::TraceReplayGenerator()
+    : m_lookahead(Seconds(60)),
+      m_maxBatch(4096),
+      m_rebase(true),
+      m_map(nullptr),
+      m_mapSize(0),
+      m_records(nullptr),
+      m_count(0),
+      m_cursor(0),
+      m_released(0),
+      m_replayed(0),
+      m_outOfOrder(0),
+      m_epochUs(0)
+{
+}
+
+inline TraceReplayGenerator::~TraceReplayGenerator()
+{
+    Close();
+}
+
+inline void
+TraceReplayGenerator::DoDispose()
+{
+    Simulator::Cancel(m_pumpEvent);
+    m_send = MakeNullCallback<void, uint32_t, uint32_t>();
+    Close();
+    Object::DoDispose();
+}
+
+inline bool
+TraceReplayGenerator::Open(const std::string& path)
+{
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ArrivalTraceHeader))
+    {
+        close(fd);
+        return false;
+    }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+    m_map = static_cast<const uint8_t*>(map);
+    m_mapSize = st.st_size;
+
+    const auto* header = reinterpret_cast<const ArrivalTraceHeader*>(m_map);
+    if (std::memcmp(header->magic, "LBTRACE1", 8) != 0 ||
+        header->recordSize != sizeof(ArrivalTraceRecord) ||
+        header->count > (m_mapSize - sizeof(ArrivalTraceHeader)) / sizeof(ArrivalTraceRecord)) // No overflow
+    {
+        Close();
+        return false;
+    }
+    madvise(const_cast<uint8_t*>(m_map), m_mapSize, MADV_SEQUENTIAL);
+    m_records = reinterpret_cast<const ArrivalTraceRecord*>(m_map + sizeof(ArrivalTraceHeader));
+    m_count = header->count;
+    m_cursor = 0;
+    m_released = 0;
+    return true;
+}
+
+inline void
+TraceReplayGenerator::SetSendCallback(SendCallback send)
+{
+    m_send = send;
+}
+
+inline void
+TraceReplayGenerator::Start(Time start, Time stop)
+{
+    m_start = start;
+    m_stop = stop;
+    m_epochUs = (m_rebase && m_count > 0) ? m_records[0].timestampUs : 0;
+    if (m_count > 0)
+    {
+        m_pumpEvent = Simulator::Schedule(start - Simulator::Now(), &TraceReplayGenerator::Pump, this);
+    }
+}
+
+inline uint64_t
+TraceReplayGenerator::GetRecordCount() const
+{
+    return m_count;
+}
+
+inline uint64_t
+TraceReplayGenerator::GetReplayedCount() const
+{
+    return m_replayed;
+}
+
+inline uint64_t
+TraceReplayGenerator::GetOutOfOrderCount() const
+{
+    return m_outOfOrder;
+}
+
+inline Time
+TraceReplayGenerator::RecordTime(uint64_t index) const
+{
+    uint64_t timestampUs = m_records[index].timestampUs;
+    if (timestampUs < m_epochUs)
+    {
+        return m_start;
+    }
+    return m_start + MicroSeconds(timestampUs - m_epochUs);
+}
+
+inline void
+TraceReplayGenerator::Pump()
+{
+    Time now = Simulator::Now();
+    Time windowEnd = now + m_lookahead;
+    uint32_t batch = 0;
+
+    while (m_cursor < m_count && batch < m_maxBatch)
+    {
+        Time at = RecordTime(m_cursor);
+        if (at > m_stop)
+        {
+            m_cursor = m_count;
+            break;
+        }
+        if (at >= windowEnd && batch > 0)
+        {
+            break;
+        }
+        if (at < now)
+        {
+            m_outOfOrder++;
+            at = now;
+        }
+        const ArrivalTraceRecord& record = m_records[m_cursor];
+        Simulator::Schedule(at - now,
+                            &TraceReplayGenerator::Play,
+                            this,
+                            record.deviceId,
+                            static_cast<uint32_t>(record.payloadSize));
+        m_cursor++;
+        batch++;
+    }
+
+    // Give the pages that are fully behind the cursor back to the kernel, so
+    // that the resident set stays bounded however long the trace is
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t consumed = sizeof(ArrivalTraceHeader) + m_cursor * sizeof(ArrivalTraceRecord);
+    size_t releasedBytes = sizeof(ArrivalTraceHeader) + m_released * sizeof(ArrivalTraceRecord);
+    size_t from = releasedBytes / pageSize * pageSize;
+    size_t to = consumed / pageSize * pageSize;
+    if (to > from)
+    {
+        madvise(const_cast<uint8_t*>(m_map) + from, to - from, MADV_DONTNEED);
+        m_released = m_cursor;
+    }
+
+    if (m_cursor < m_count)
+    {
+        // Refill when the next unscheduled record enters the window; if the
+        // batch limit was hit inside the window this is the last scheduled time
+        Time next = RecordTime(m_cursor) - m_lookahead;
+        if (next < now)
+        {
+            next = RecordTime(m_cursor - 1);
+        }
+        m_pumpEvent = Simulator::Schedule(std::max(next, now) - now, &TraceReplayGenerator::Pump, this);
+    }
+}
+
+inline void
+TraceReplayGenerator::Play(uint32_t deviceId, uint32_t payloadSize)
+{
+    m_replayed++;
+    if (!m_send.IsNull())
+    {
+        m_send(deviceId, payloadSize);
+    }
+}
+
+inline void
+TraceReplayGenerator::Close()
+{
+    if (m_map)
+    {
+        munmap(const_cast<uint8_t*>(m_map), m_mapSize);
+    }
+    m_map = nullptr;
+    m_mapSize = 0;
+    m_records = nullptr;
+    m_count = 0;
+    m_cursor = 0;
+    m_released = 0;
+}
+
+} // namespace ns3
+
+#endif /* LORA_BRIDGE_TRACE_REPLAY_H */
@@ -0,0 +1,192 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-bridge/lib/adaptive-sampler.h"
+
+#include "ns3/test.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * The initial design is a Latin hypercube over the parameter ranges.
+ */
+class LatinHypercubeTestCase : public TestCase
+{
+  public:
+    LatinHypercubeTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LatinHypercubeTestCase::LatinHypercubeTestCase()
+    : TestCase("Start with one point per stratum of every dimension")
+{
+}
+
+void
+LatinHypercubeTestCase::DoRun()
+{
+    const uint32_t nPoints = 10;
+    AdaptiveSampler sampler;
+    sampler.AddDimension("gwX", -800, -100, false);
+    sampler.AddDimension("period", 600, 60, false); // Reversed bounds are swapped
+    std::vector<AdaptiveSampler::Proposal> proposals = sampler.Start(nPoints, 3);
+    NS_TEST_ASSERT_MSG_EQ(proposals.size(), nPoints, "One proposal per point");
+    NS_TEST_EXPECT_MSG_EQ(sampler.GetDimensions()[1].min, 60, "Lowest value");
+
+    for (size_t k = 0; k < 2; ++k)
+    {
+        const AdaptiveSampler::Dimension& dimension = sampler.GetDimensions()[k];
+        std::set<int> strata;
+        for (const auto& proposal : proposals)
+        {
+            NS_TEST_EXPECT_MSG_EQ(proposal.replications, 3, "Replications of a new point");
+            double x = sampler.GetSamples()[proposal.sample].x[k];
+            double unit = (x - dimension.min) / (dimension.max - dimension.min);
+            NS_TEST_EXPECT_MSG_EQ((unit >= 0.0 && unit <= 1.0), true, "Value outside the range");
+            strata.insert(std::min<int>(static_cast<int>(unit * nPoints), nPoints - 1));
+        }
+        NS_TEST_EXPECT_MSG_EQ(strata.size(), nPoints, "A stratum of " << dimension.name << " is empty");
+    }
+
+    AdaptiveSampler integers;
+    integers.AddDimension("nDevices", 10, 13, true);
+    proposals = integers.Start(20, 1);
+    NS_TEST_EXPECT_MSG_EQ(proposals.size(), 4, "Points merged by the integer rounding");
+    for (const auto& sample : integers.GetSamples())
+    {
+        NS_TEST_EXPECT_MSG_EQ(sample.x[0], std::round(sample.x[0]), "Integer dimension not rounded");
+    }
+}
+
+/**
+ * Links are scored by their difference over its standard error.
+ */
+class EdgeSignificanceTestCase : public TestCase
+{
+  public:
+    EdgeSignificanceTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EdgeSignificanceTestCase::EdgeSignificanceTestCase()
+    : TestCase("Score the links by their difference over the combined error")
+{
+}
+
+void
+EdgeSignificanceTestCase::DoRun()
+{
+    AdaptiveSampler::Edge edge;
+    edge.difference = 1.0;
+    edge.error = 0.25;
+    NS_TEST_EXPECT_MSG_EQ_TOL(edge.GetSignificance(), 4.0, 1e-12, "Difference over error");
+    edge.error = 0.0;
+    NS_TEST_EXPECT_MSG_EQ(edge.GetSignificance(), std::numeric_limits<double>::infinity(), "Exact difference");
+    edge.difference = 0.0;
+    NS_TEST_EXPECT_MSG_EQ(edge.GetSignificance(), 0.0, "No difference");
+
+    AdaptiveSampler sampler;
+    sampler.AddDimension("x", 0, 1, false);
+    sampler.Start(2, 2);
+    sampler.AddResult(0, 0.0);
+    sampler.AddResult(0, 0.2);
+    sampler.AddResult(1, 1.0);
+    std::vector<AdaptiveSampler::Edge> edges = sampler.GetEdges();
+    NS_TEST_ASSERT_MSG_EQ(edges.size(), 1, "One link between two points");
+    NS_TEST_EXPECT_MSG_EQ_TOL(edges[0].difference, 0.9, 1e-12, "Difference of the means");
+    // Standard error 0.1 on one end; the single result borrows the pooled variance 0.02
+    NS_TEST_EXPECT_MSG_EQ_TOL(edges[0].error, std::sqrt(0.01 + 0.02), 1e-12, "Combined error");
+
+    sampler.AddResult(1, 1.2);
+    edges = sampler.GetEdges();
+    NS_TEST_EXPECT_MSG_EQ_TOL(edges[0].error, std::sqrt(0.01 + 0.01), 1e-12, "Combined error");
+    NS_TEST_EXPECT_MSG_EQ_TOL(edges[0].GetSignificance(), 1.0 / std::sqrt(0.02), 1e-9, "Significance");
+}
+
+/**
+ * The refinement goes to the step of a noisy metric and stops on a flat one.
+ */
+class RefinementTestCase : public TestCase
+{
+  public:
+    RefinementTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RefinementTestCase::RefinementTestCase()
+    : TestCase("Concentrate the refinement around a step")
+{
+}
+
+void
+RefinementTestCase::DoRun()
+{
+    AdaptiveSampler sampler;
+    sampler.AddDimension("gwX", 0, 100, false);
+    sampler.AddDimension("nDevices", 10, 200, true);
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    auto metric = [&rng, &noise](const std::vector<double>& x) { return (x[0] > 60 ? 0.8 : 0.1) + noise(rng); };
+
+    std::vector<AdaptiveSampler::Proposal> proposals = sampler.Start(10, 2);
+    for (uint32_t round = 0; round < 8 && !proposals.empty(); ++round)
+    {
+        for (const auto& proposal : proposals)
+        {
+            for (uint32_t r = 0; r < proposal.replications; ++r)
+            {
+                sampler.AddResult(proposal.sample, metric(sampler.GetSamples()[proposal.sample].x));
+            }
+        }
+        proposals = sampler.Refine(8, 2);
+    }
+    size_t nearStep = 0;
+    for (const auto& sample : sampler.GetSamples())
+    {
+        nearStep += std::fabs(sample.x[0] - 60) < 8 ? 1 : 0;
+    }
+    // Uniformly spread, 16% of the points would fall within 8 of the step
+    NS_TEST_EXPECT_MSG_GT(sampler.GetSamples().size(), 40, "The refinement stopped early");
+    NS_TEST_EXPECT_MSG_GT(2 * nearStep, sampler.GetSamples().size(), "Most points must be near the step");
+
+    AdaptiveSampler flat;
+    flat.AddDimension("gwX", 0, 100, false);
+    for (const auto& proposal : flat.Start(6, 2))
+    {
+        flat.AddResult(proposal.sample, 0.5);
+        flat.AddResult(proposal.sample, 0.5);
+    }
+    NS_TEST_EXPECT_MSG_EQ(flat.Refine(8, 2).size(), 0, "Nothing to refine on a flat, exact metric");
+}
+
+/**
+ * Adaptive sampler tests.
+ */
+class AdaptiveSamplerTestSuite : public TestSuite
+{
+  public:
+    AdaptiveSamplerTestSuite();
+};
+
+AdaptiveSamplerTestSuite::AdaptiveSamplerTestSuite()
+    : TestSuite("lora-bridge-adaptive-sampler", Type::UNIT)
+{
+    AddTestCase(new LatinHypercubeTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new EdgeSignificanceTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new RefinementTestCase, TestCase::Duration::QUICK);
+}
+
+static AdaptiveSamplerTestSuite g_adaptiveSamplerTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,185 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-bridge/lib/biased-nakagami-loss-model.h"
+#include "lora-bridge/lib/rare-event-estimator.h"
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <cmath>
+
+using namespace ns3;
+
+/// @return ln f(g) for a Gamma density of shape @p m and scale @p theta
+static double
+LogGammaDensity(double g, double m, double theta)
+{
+    return (m - 1) * std::log(g) - g / theta - m * std::log(theta) - std::lgamma(m);
+}
+
+/**
+ * The likelihood ratio is the ratio of the unbiased to the biased density.
+ */
+class LikelihoodRatioTestCase : public TestCase
+{
+  public:
+    LikelihoodRatioTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LikelihoodRatioTestCase::LikelihoodRatioTestCase()
+    : TestCase("Match the ratio of the Gamma densities")
+{
+}
+
+void
+LikelihoodRatioTestCase::DoRun()
+{
+    for (double m : {0.75, 1.0, 1.5, 4.0})
+    {
+        for (double biasDb : {3.0, 10.0, 20.0})
+        {
+            double theta = 2e-12;
+            double bias = std::pow(10, -biasDb / 10);
+            for (double g : {1e-15, 1e-13, 1e-12, 5e-12})
+            {
+                double expected = LogGammaDensity(g, m, theta) - LogGammaDensity(g, m, theta * bias);
+                NS_TEST_EXPECT_MSG_EQ_TOL(BiasedNakagamiLossModel::GetLogLikelihoodRatio(m, theta, bias, g),
+                                          expected,
+                                          1e-9 * std::max(1.0, std::abs(expected)),
+                                          "m " << m << ", bias " << biasDb << " dB, gain " << g);
+            }
+        }
+    }
+}
+
+/**
+ * Weighted biased draws estimate a small probability of the unbiased fading.
+ */
+class ImportanceSamplingTestCase : public TestCase
+{
+  public:
+    ImportanceSamplingTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ImportanceSamplingTestCase::ImportanceSamplingTestCase()
+    : TestCase("Estimate a deep fade probability from biased draws")
+{
+}
+
+void
+ImportanceSamplingTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+    Ptr<GammaRandomVariable> gamma = CreateObject<GammaRandomVariable>();
+    gamma->SetStream(1);
+
+    // Rayleigh fading (m = 1): P(G < t) = 1 - exp(-t / theta), about 1% here
+    const double m = 1.0;
+    const double theta = 1.0;
+    const double threshold = 0.01;
+    const double bias = 0.1;
+    const uint32_t n = 100000;
+
+    // One gateway, so every draw is one sample of the estimator
+    RareEventEstimator estimator;
+    estimator.SetTopology(1, 1);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        double g = gamma->GetValue(m, theta * bias);
+        estimator.StartTransmission(i, 0);
+        estimator.AddOutcome(i, g >= threshold, BiasedNakagamiLossModel::GetLogLikelihoodRatio(m, theta, bias, g));
+    }
+    const RareEventEstimator::Entry& entry = estimator.GetEntry(0);
+    double expected = 1 - std::exp(-threshold / theta);
+    NS_TEST_ASSERT_MSG_EQ(entry.samples, n, "Every draw is a sample");
+    NS_TEST_EXPECT_MSG_EQ(estimator.GetPendingCount(), 0, "Nothing left pending");
+    NS_TEST_EXPECT_MSG_GT(entry.GetBiasedLossRate(), 5 * expected, "The bias makes the fades common");
+    NS_TEST_EXPECT_MSG_EQ_TOL(entry.GetEstimate(), expected, 0.05 * expected, "Biased estimate");
+    NS_TEST_EXPECT_MSG_LT(entry.GetRelativeError(), 0.02, "Relative error of the estimate");
+    NS_TEST_EXPECT_MSG_LT(std::abs(entry.GetEstimate() - expected),
+                          5 * std::sqrt(entry.GetVariance()),
+                          "Estimate outside five standard deviations");
+}
+
+/**
+ * Only the uplink draws towards a biased receiver are biased and recorded.
+ */
+class BiasedReceiverTestCase : public TestCase
+{
+  public:
+    BiasedReceiverTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+BiasedReceiverTestCase::BiasedReceiverTestCase()
+    : TestCase("Record the likelihood ratio of the draws towards a gateway")
+{
+}
+
+void
+BiasedReceiverTestCase::DoRun()
+{
+    Ptr<BiasedNakagamiLossModel> loss = CreateObject<BiasedNakagamiLossModel>();
+    loss->SetAttribute("Bias", DoubleValue(10.0));
+    loss->AssignStreams(1);
+    Ptr<ConstantPositionMobilityModel> device = CreateObject<ConstantPositionMobilityModel>();
+    Ptr<ConstantPositionMobilityModel> gateway = CreateObject<ConstantPositionMobilityModel>();
+    Ptr<ConstantPositionMobilityModel> other = CreateObject<ConstantPositionMobilityModel>();
+    device->SetPosition(Vector(1000, 0, 0));
+    other->SetPosition(Vector(0, 1000, 0));
+    loss->AddBiasedReceiver(gateway);
+
+    const double txPowerDbm = 14;
+    double rxPowerDbm = loss->CalcRxPower(txPowerDbm, device, gateway);
+    NS_TEST_ASSERT_MSG_EQ(loss->GetBiasedDrawCount(), 1, "The uplink draw is biased");
+
+    // 1000 m: beyond Distance2, shape m2
+    double m = 0.75;
+    double theta = std::pow(10, (txPowerDbm - 30) / 10) / m;
+    double gain = std::pow(10, (rxPowerDbm - 30) / 10);
+    double expected = BiasedNakagamiLossModel::GetLogLikelihoodRatio(m, theta, 0.1, gain);
+    NS_TEST_EXPECT_MSG_EQ_TOL(loss->GetLogWeight(gateway, Seconds(1)),
+                              expected,
+                              1e-6 * std::max(1.0, std::abs(expected)),
+                              "Recorded log likelihood ratio");
+
+    loss->CalcRxPower(txPowerDbm, gateway, device);
+    loss->CalcRxPower(txPowerDbm, device, other);
+    NS_TEST_EXPECT_MSG_EQ(loss->GetBiasedDrawCount(), 1, "Downlinks and other receivers are not biased");
+    NS_TEST_EXPECT_MSG_EQ(loss->GetLogWeight(other, Seconds(1)), 0.0, "Nothing recorded at other receivers");
+    Simulator::Destroy();
+}
+
+/**
+ * Importance sampling tests.
+ */
+class BiasedNakagamiTestSuite : public TestSuite
+{
+  public:
+    BiasedNakagamiTestSuite();
+};
+
+BiasedNakagamiTestSuite::BiasedNakagamiTestSuite()
+    : TestSuite("lora-bridge-biased-nakagami", Type::UNIT)
+{
+    AddTestCase(new LikelihoodRatioTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new ImportanceSamplingTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new BiasedReceiverTestCase, TestCase::Duration::QUICK);
+}
+
+static BiasedNakagamiTestSuite g_biasedNakagamiTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-bridge/lib/channel-plan.h"
+
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Channel count, frequencies and the default plan.
+ */
+class ChannelPlanConfigTestCase : public TestCase
+{
+  public:
+    ChannelPlanConfigTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ChannelPlanConfigTestCase::ChannelPlanConfigTestCase()
+    : TestCase("Clamp the channel count and recognise the default plan")
+{
+}
+
+void
+ChannelPlanConfigTestCase::DoRun()
+{
+    ChannelPlan plan;
+    NS_TEST_EXPECT_MSG_EQ(plan.GetChannelCount(), 3, "Three channels by default");
+    NS_TEST_EXPECT_MSG_EQ(plan.IsDefault(), true, "Default plan");
+    plan.SetChannelsPerDevice(3);
+    NS_TEST_EXPECT_MSG_EQ(plan.IsDefault(), true, "Every channel per device is the default");
+    plan.SetChannelsPerDevice(2);
+    NS_TEST_EXPECT_MSG_EQ(plan.IsDefault(), false, "Devices restricted to two channels");
+    plan.SetChannelsPerDevice(0);
+    plan.SetChannelCount(5);
+    NS_TEST_EXPECT_MSG_EQ(plan.IsDefault(), false, "Extra channels");
+
+    plan.SetChannelCount(1);
+    NS_TEST_EXPECT_MSG_EQ(plan.GetChannelCount(), 3, "At least the three mandatory channels");
+    plan.SetChannelCount(12);
+    NS_TEST_EXPECT_MSG_EQ(plan.GetChannelCount(), ChannelPlan::MAX_CHANNELS, "At most eight channels");
+
+    NS_TEST_EXPECT_MSG_EQ(ChannelPlan::GetFrequency(0), 868100000, "First mandatory channel");
+    NS_TEST_EXPECT_MSG_EQ(ChannelPlan::GetFrequency(2), 868500000, "Last mandatory channel");
+    NS_TEST_EXPECT_MSG_EQ(ChannelPlan::GetFrequency(3), 867100000, "First extra channel");
+    NS_TEST_EXPECT_MSG_EQ(ChannelPlan::GetFrequency(7), 867900000, "Last extra channel");
+}
+
+/**
+ * Greedy balancing of the airtime over the channels.
+ */
+class ChannelPlanBalanceTestCase : public TestCase
+{
+  public:
+    ChannelPlanBalanceTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ChannelPlanBalanceTestCase::ChannelPlanBalanceTestCase()
+    : TestCase("Give every device the least loaded channels")
+{
+}
+
+void
+ChannelPlanBalanceTestCase::DoRun()
+{
+    ChannelPlan all;
+    all.SetChannelCount(8);
+    NS_TEST_EXPECT_MSG_EQ(all.AddDevice(0.8), 0xff, "All channels when not restricted");
+    NS_TEST_EXPECT_MSG_EQ_TOL(all.GetLoad(7), 0.1, 1e-12, "Load spread over every channel");
+
+    ChannelPlan plan;
+    plan.SetChannelCount(8);
+    plan.SetChannelsPerDevice(2);
+    NS_TEST_EXPECT_MSG_EQ(plan.AddDevice(0.4), 0x03, "Ties broken by channel index");
+    NS_TEST_EXPECT_MSG_EQ(plan.AddDevice(0.4), 0x0c, "Next unloaded channels");
+    NS_TEST_EXPECT_MSG_EQ(plan.AddDevice(1.0), 0x30, "Next unloaded channels");
+    NS_TEST_EXPECT_MSG_EQ(plan.AddDevice(0.4), 0xc0, "Last unloaded channels");
+    NS_TEST_EXPECT_MSG_EQ(plan.AddDevice(0.2), 0x03, "Least loaded, not the busy pair 4-5");
+    NS_TEST_EXPECT_MSG_EQ_TOL(plan.GetLoad(0), 0.3, 1e-12, "Half of each load per channel");
+    NS_TEST_EXPECT_MSG_EQ_TOL(plan.GetLoad(4), 0.5, 1e-12, "Half of each load per channel");
+    NS_TEST_EXPECT_MSG_EQ(plan.GetLoad(ChannelPlan::MAX_CHANNELS), 0.0, "No such channel");
+
+    ChannelPlan wide;
+    wide.SetChannelCount(4);
+    wide.SetChannelsPerDevice(6);
+    NS_TEST_EXPECT_MSG_EQ(wide.AddDevice(1.0), 0x0f, "Capped at the channel count");
+}
+
+/**
+ * Channel plan tests.
+ */
+class ChannelPlanTestSuite : public TestSuite
+{
+  public:
+    ChannelPlanTestSuite();
+};
+
+ChannelPlanTestSuite::ChannelPlanTestSuite()
+    : TestSuite("lora-bridge-channel-plan", Type::UNIT)
+{
+    AddTestCase(new ChannelPlanConfigTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new ChannelPlanBalanceTestCase, TestCase::Duration::QUICK);
+}
+
+static ChannelPlanTestSuite g_channelPlanTestSuite; //!< Static variable for test initialization
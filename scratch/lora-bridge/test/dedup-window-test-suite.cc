@@ -0,0 +1,141 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-bridge/lib/dedup-window.h"
+
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Window size rounding.
+ */
+class DedupWindowSizeTestCase : public TestCase
+{
+  public:
+    DedupWindowSizeTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DedupWindowSizeTestCase::DedupWindowSizeTestCase()
+    : TestCase("Round the window up to a power of two, at least 64")
+{
+}
+
+void
+DedupWindowSizeTestCase::DoRun()
+{
+    NS_TEST_EXPECT_MSG_EQ(DedupWindow(0).GetWindow(), 64, "Empty window");
+    NS_TEST_EXPECT_MSG_EQ(DedupWindow(64).GetWindow(), 64, "Power of two kept");
+    NS_TEST_EXPECT_MSG_EQ(DedupWindow(65).GetWindow(), 128, "Rounded up");
+    NS_TEST_EXPECT_MSG_EQ(DedupWindow(1000).GetWindow(), 1024, "Rounded up");
+    NS_TEST_EXPECT_MSG_EQ(DedupWindow().GetWindow(), 1u << 20, "Default window");
+    NS_TEST_EXPECT_MSG_EQ(DedupWindow(1000).GetBytes(), 1024 / 8, "One bit per id");
+}
+
+/**
+ * Duplicates, late copies and stale ids.
+ */
+class DedupWindowInsertTestCase : public TestCase
+{
+  public:
+    DedupWindowInsertTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DedupWindowInsertTestCase::DedupWindowInsertTestCase()
+    : TestCase("Detect duplicates in a sliding window of ids")
+{
+}
+
+void
+DedupWindowInsertTestCase::DoRun()
+{
+    DedupWindow window(64);
+    NS_TEST_EXPECT_MSG_EQ(window.Contains(1), false, "Nothing seen yet");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(1), true, "First copy");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(1), false, "Second copy");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(3), true, "Gap");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(2), true, "Out of order, within the window");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(2), false, "Out of order copy");
+    NS_TEST_EXPECT_MSG_EQ(window.Contains(3), true, "Seen");
+    NS_TEST_EXPECT_MSG_EQ(window.Contains(4), false, "Not seen");
+
+    // Sliding by less than a window: the slot of 66 held 2, that of 65 held 1
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(66), true, "Slides the window");
+    NS_TEST_EXPECT_MSG_EQ(window.Contains(65), false, "Slot of an older id not cleared");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(65), true, "Id sharing a slot with an older one");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(3), false, "Oldest id of the window, still remembered");
+    NS_TEST_EXPECT_MSG_EQ(window.GetStaleCount(), 0, "Nothing stale yet");
+
+    // Out of the window: reported as seen and counted as stale
+    NS_TEST_EXPECT_MSG_EQ(window.Contains(2), true, "Too old to tell");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(2), false, "Stale id");
+    NS_TEST_EXPECT_MSG_EQ(window.GetStaleCount(), 1, "Stale count");
+
+    // Jump by more than a window: everything older is forgotten
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(1000), true, "Jump");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(999), true, "Below the jump, within the window");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(937), true, "Oldest id of the window");
+    NS_TEST_EXPECT_MSG_EQ(window.Insert(936), false, "Just out of the window");
+    NS_TEST_EXPECT_MSG_EQ(window.GetStaleCount(), 2, "Stale count");
+    NS_TEST_EXPECT_MSG_EQ(window.GetUniqueCount(), 8, "Distinct ids");
+}
+
+/**
+ * Senders of the most recent ids.
+ */
+class PacketSenderRingTestCase : public TestCase
+{
+  public:
+    PacketSenderRingTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PacketSenderRingTestCase::PacketSenderRingTestCase()
+    : TestCase("Keep the sender of the ids of the window only")
+{
+}
+
+void
+PacketSenderRingTestCase::DoRun()
+{
+    PacketSenderRing senders(100);
+    NS_TEST_EXPECT_MSG_EQ(senders.GetBytes(), 128 * 8, "One slot per id of the rounded window");
+    uint32_t sender = 0;
+    NS_TEST_EXPECT_MSG_EQ(senders.Get(0, sender), false, "Id 0 is never sent");
+    NS_TEST_EXPECT_MSG_EQ(senders.Get(5, sender), false, "Nothing set yet");
+    senders.Set(5, 17);
+    NS_TEST_EXPECT_MSG_EQ(senders.Get(5, sender), true, "Sender set");
+    NS_TEST_EXPECT_MSG_EQ(sender, 17, "Sender of id 5");
+    senders.Set(133, 4); // Same slot, one window later
+    NS_TEST_EXPECT_MSG_EQ(senders.Get(5, sender), false, "Overwritten by a newer id");
+    NS_TEST_EXPECT_MSG_EQ(senders.Get(133, sender), true, "Newer id");
+    NS_TEST_EXPECT_MSG_EQ(sender, 4, "Sender of id 133");
+}
+
+/**
+ * Duplicate filter tests.
+ */
+class DedupWindowTestSuite : public TestSuite
+{
+  public:
+    DedupWindowTestSuite();
+};
+
+DedupWindowTestSuite::DedupWindowTestSuite()
+    : TestSuite("lora-bridge-dedup-window", Type::UNIT)
+{
+    AddTestCase(new DedupWindowSizeTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new DedupWindowInsertTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new PacketSenderRingTestCase, TestCase::Duration::QUICK);
+}
+
+static DedupWindowTestSuite g_dedupWindowTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,17 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// Test runner of the lora-bridge library. The suites are ns-3 TestSuites
+// compiled into this program rather than into a module test library, since
+// the library lives in scratch. Run them all, or one with --suite:
+//
+//   ./ns3 run "lora-bridge-test --suite=lora-bridge-trace-replay --verbose"
+
+#include "ns3/test.h"
+
+int
+main(int argc, char* argv[])
+{
+    return ns3::TestRunner::Run(argc, argv);
+}
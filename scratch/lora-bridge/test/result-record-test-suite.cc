@@ -0,0 +1,152 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-bridge/lib/result-record.h"
+
+#include "ns3/test.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * A written record reads back unchanged.
+ */
+class RecordRoundTripTestCase : public TestCase
+{
+  public:
+    RecordRoundTripTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RecordRoundTripTestCase::RecordRoundTripTestCase()
+    : TestCase("Write a record and read it back")
+{
+}
+
+void
+RecordRoundTripTestCase::DoRun()
+{
+    ResultRecord record;
+    record.SetParameters("nDevices=100\nscenario=CT_dev\n");
+    record.SetScalar("failureRate", 0.125);
+    record.SetScalar("downlinkSent", 42);
+    record.SetScalar("failureRate", 0.25); // Replaces, keeps the position
+    size_t table = record.AddTable("perSf", "Packets per SF", {"sf", "sent", "lost"});
+    record.AddRow(table, {7, 1000, 3});
+    record.AddRow(table, {12, 20, 1.5e-3});
+
+    std::string path = CreateTempDirFilename("record.lbrec");
+    NS_TEST_ASSERT_MSG_EQ(record.Write(path), true, "Could not write the record");
+
+    ResultRecord copy;
+    NS_TEST_ASSERT_MSG_EQ(copy.Read(path), true, "Could not read the record back");
+    NS_TEST_EXPECT_MSG_EQ(copy.GetParameters().size(), 2, "Parameter count");
+    NS_TEST_EXPECT_MSG_EQ(copy.GetParameter("scenario"), "CT_dev", "Parameter value");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetScalars().size(), 2, "Scalar count");
+    NS_TEST_EXPECT_MSG_EQ(copy.GetScalars()[0].first, "failureRate", "Scalar order");
+    double value = 0;
+    NS_TEST_EXPECT_MSG_EQ(copy.GetScalar("failureRate", value), true, "Scalar missing");
+    NS_TEST_EXPECT_MSG_EQ(value, 0.25, "Scalar value");
+    NS_TEST_EXPECT_MSG_EQ(copy.GetScalar("missing", value), false, "Unknown scalar found");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetTables().size(), 1, "Table count");
+    const ResultRecord::Table& copied = copy.GetTables()[0];
+    NS_TEST_EXPECT_MSG_EQ(copied.title, "Packets per SF", "Table title");
+    NS_TEST_EXPECT_MSG_EQ(copied.columns.size(), 3, "Column count");
+    NS_TEST_ASSERT_MSG_EQ(copied.rows.size(), 2, "Row count");
+    NS_TEST_EXPECT_MSG_EQ(copied.rows[1][2], 1.5e-3, "Row value");
+}
+
+/**
+ * Malformed files are rejected instead of throwing.
+ */
+class RecordMalformedTestCase : public TestCase
+{
+  public:
+    RecordMalformedTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RecordMalformedTestCase::RecordMalformedTestCase()
+    : TestCase("Reject malformed records")
+{
+}
+
+void
+RecordMalformedTestCase::DoRun()
+{
+    std::vector<std::string> bodies = {
+        "LBREC 2\n",                                    // Unknown version
+        "LBREC 1\ns\tfailureRate\tabc\n",               // Scalar not a number
+        "LBREC 1\ns\tfailureRate\t1e999\n",             // Scalar out of range
+        "LBREC 1\nt\tperSf\tTitle\tsf\nr\t7\tx7\n",     // Row value not a number
+        "LBREC 1\nr\t7\n",                              // Row without a table
+        "LBREC 1\nx\tunknown\n",                        // Unknown line
+    };
+    std::string path = CreateTempDirFilename("malformed.lbrec");
+    for (const auto& body : bodies)
+    {
+        {
+            std::ofstream file(path);
+            file << body;
+        }
+        ResultRecord record;
+        NS_TEST_EXPECT_MSG_EQ(record.Read(path), false, "Accepted a malformed record: " << body);
+    }
+    ResultRecord record;
+    NS_TEST_EXPECT_MSG_EQ(record.Read(CreateTempDirFilename("missing.lbrec")), false, "Read a missing file");
+}
+
+/**
+ * Escaping of the LaTeX special characters.
+ */
+class EscapeLatexTestCase : public TestCase
+{
+  public:
+    EscapeLatexTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EscapeLatexTestCase::EscapeLatexTestCase()
+    : TestCase("Escape every LaTeX special character")
+{
+}
+
+void
+EscapeLatexTestCase::DoRun()
+{
+    NS_TEST_EXPECT_MSG_EQ(EscapeLatex("plain text 42"), "plain text 42", "Plain text changed");
+    NS_TEST_EXPECT_MSG_EQ(EscapeLatex("rx_power"), "rx\\_power", "Underscore");
+    NS_TEST_EXPECT_MSG_EQ(EscapeLatex("50% & #1 $x$"), "50\\% \\& \\#1 \\$x\\$", "Percent, ampersand, hash, dollar");
+    NS_TEST_EXPECT_MSG_EQ(EscapeLatex("{set}"), "\\{set\\}", "Braces");
+    NS_TEST_EXPECT_MSG_EQ(EscapeLatex("a\\b"), "a\\textbackslash{}b", "Backslash");
+    NS_TEST_EXPECT_MSG_EQ(EscapeLatex("m^2 ~1"), "m\\^{}2 \\~{}1", "Caret and tilde");
+}
+
+/**
+ * Result record tests.
+ */
+class ResultRecordTestSuite : public TestSuite
+{
+  public:
+    ResultRecordTestSuite();
+};
+
+ResultRecordTestSuite::ResultRecordTestSuite()
+    : TestSuite("lora-bridge-result-record", Type::UNIT)
+{
+    AddTestCase(new RecordRoundTripTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new RecordMalformedTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new EscapeLatexTestCase, TestCase::Duration::QUICK);
+}
+
+static ResultRecordTestSuite g_resultRecordTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,150 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-bridge/lib/trace-replay.h"
+
+#include "ns3/test.h"
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Conversion of a CSV export holding good and malformed lines.
+ */
+class CsvConversionTestCase : public TestCase
+{
+  public:
+    CsvConversionTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+CsvConversionTestCase::CsvConversionTestCase()
+    : TestCase("Convert a CSV trace, skipping and reporting the malformed lines")
+{
+}
+
+void
+CsvConversionTestCase::DoRun()
+{
+    std::string csvPath = CreateTempDirFilename("arrivals.csv");
+    std::string tracePath = CreateTempDirFilename("arrivals.bin");
+    {
+        std::ofstream csv(csvPath);
+        csv << "# device,timestamp_s,payload_bytes\n" // 1
+            << "3,12.5,24\n"                           // 2
+            << "1,-4,24\n"                             // 3: negative time
+            << "2,abc,24\n"                            // 4: not a number
+            << "4,1.000001,51\r\n"                     // 5: CRLF line end
+            << "5,7\n"                                 // 6: missing field
+            << "6,8,70000\n"                           // 7: payload too large
+            << "-7,9,24\n"                             // 8: negative device
+            << "8,2.5s,24\n"                           // 9: trailing garbage
+            << "\n"                                    // 10
+            << "9,0,12\n";                             // 11
+    }
+
+    std::vector<std::string> errors;
+    int64_t count = ConvertCsvArrivalTrace(csvPath, tracePath, &errors);
+    NS_TEST_ASSERT_MSG_EQ(count, 3, "Three valid records");
+    NS_TEST_ASSERT_MSG_EQ(errors.size(), 6, "Six malformed lines");
+    std::vector<std::string> expected = {"line 3:", "line 4:", "line 6:", "line 7:", "line 8:", "line 9:"};
+    for (size_t i = 0; i < expected.size() && i < errors.size(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(errors[i].compare(0, expected[i].size(), expected[i]),
+                              0,
+                              "Unexpected report " << errors[i]);
+    }
+
+    std::ifstream trace(tracePath, std::ios::binary);
+    ArrivalTraceHeader header;
+    trace.read(reinterpret_cast<char*>(&header), sizeof(header));
+    NS_TEST_ASSERT_MSG_EQ(std::string(header.magic, 8), "LBTRACE1", "Bad magic");
+    NS_TEST_ASSERT_MSG_EQ(header.count, 3, "Bad record count in the header");
+    std::vector<ArrivalTraceRecord> records(header.count);
+    trace.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(ArrivalTraceRecord));
+    NS_TEST_ASSERT_MSG_EQ(trace.good(), true, "Truncated trace");
+
+    // Sorted by time, microsecond resolution
+    NS_TEST_EXPECT_MSG_EQ(records[0].deviceId, 9, "First record");
+    NS_TEST_EXPECT_MSG_EQ(records[0].timestampUs, 0, "First timestamp");
+    NS_TEST_EXPECT_MSG_EQ(records[1].deviceId, 4, "Second record");
+    NS_TEST_EXPECT_MSG_EQ(records[1].timestampUs, 1000001, "Second timestamp");
+    NS_TEST_EXPECT_MSG_EQ(records[1].payloadSize, 51, "Second payload size");
+    NS_TEST_EXPECT_MSG_EQ(records[2].deviceId, 3, "Third record");
+    NS_TEST_EXPECT_MSG_EQ(records[2].timestampUs, 12500000, "Third timestamp");
+
+    Ptr<TraceReplayGenerator> replay = CreateObject<TraceReplayGenerator>();
+    NS_TEST_ASSERT_MSG_EQ(replay->Open(tracePath), true, "The generator rejects the trace");
+    NS_TEST_EXPECT_MSG_EQ(replay->GetRecordCount(), 3, "The generator sees another count");
+    replay->Dispose();
+
+    NS_TEST_EXPECT_MSG_EQ(ConvertCsvArrivalTrace(CreateTempDirFilename("missing.csv"), tracePath),
+                          -1,
+                          "A missing input must fail");
+}
+
+/**
+ * Traces whose header promises more records than the file holds.
+ */
+class CorruptTraceTestCase : public TestCase
+{
+  public:
+    CorruptTraceTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+CorruptTraceTestCase::CorruptTraceTestCase()
+    : TestCase("Reject truncated traces and record counts that overflow")
+{
+}
+
+void
+CorruptTraceTestCase::DoRun()
+{
+    std::string path = CreateTempDirFilename("corrupt.bin");
+    ArrivalTraceRecord record = {};
+    // 2^60 records of 16 bytes wrap the byte count around to 0
+    for (uint64_t count : {uint64_t(3), uint64_t(1) << 60, ~uint64_t(0)})
+    {
+        {
+            ArrivalTraceHeader header = {};
+            std::memcpy(header.magic, "LBTRACE1", 8);
+            header.recordSize = sizeof(ArrivalTraceRecord);
+            header.count = count;
+            std::ofstream trace(path, std::ios::binary);
+            trace.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            trace.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            trace.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+        Ptr<TraceReplayGenerator> replay = CreateObject<TraceReplayGenerator>();
+        NS_TEST_EXPECT_MSG_EQ(replay->Open(path), false, "Accepted " << count << " records in a file of 2");
+        replay->Dispose();
+    }
+}
+
+/**
+ * Trace replay tests.
+ */
+class TraceReplayTestSuite : public TestSuite
+{
+  public:
+    TraceReplayTestSuite();
+};
+
+TraceReplayTestSuite::TraceReplayTestSuite()
+    : TestSuite("lora-bridge-trace-replay", Type::UNIT)
+{
+    AddTestCase(new CsvConversionTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new CorruptTraceTestCase, TestCase::Duration::QUICK);
+}
+
+static TraceReplayTestSuite g_traceReplayTestSuite; //!< Static variable for test initialization
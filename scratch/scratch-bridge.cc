@@ -5,17 +5,83 @@
 #include "ns3/mobility-module.h"
 #include "ns3/internet-module.h"
 
+#include "lora-bridge/lib/bounded-pcap.h"
+#include "lora-bridge/lib/polling-coordinator.h"
+#include "lora-bridge/lib/scheduler-tuner.h"
+
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("ScratchBridge");
 
 int main(int argc, char *argv[])
 {
+    uint32_t nSensors = 7;
+    double simSeconds = 300.0;
+    uint32_t packetSize = 1024;
+    Time cycleTime = Seconds(7.0);
+    Time maxCycleTime = Seconds(60.0);
+    bool adaptiveCycle = false;
+    std::string pcapMode = "full";
+    std::string pcapNodes;
+    uint32_t snapLen = 64;
+    uint64_t pcapMaxFileBytes = 0;
+    uint32_t pcapMaxFiles = 4;
+    std::string scheduler = "Map";
+    Time schedulerPrefix = Seconds(30);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nSensors", "Number of regular nodes polled by the gateway", nSensors);
+    cmd.AddValue("simSeconds", "Simulation time in seconds", simSeconds);
+    cmd.AddValue("packetSize", "Poll and response payload size in bytes", packetSize);
+    cmd.AddValue("cycleTime", "Polling cycle time (minimum cycle time if adaptive)", cycleTime);
+    cmd.AddValue("maxCycleTime", "Longest adaptive cycle time", maxCycleTime);
+    cmd.AddValue("adaptive", "Adapt the cycle time to the measured cycle busy time", adaptiveCycle);
+    cmd.AddValue("pcap", "Packet capture: full (every frame, every device), bounded or off", pcapMode);
+    cmd.AddValue("pcapNodes", "Comma-separated node ids captured in bounded mode (default: all)", pcapNodes);
+    cmd.AddValue("snapLen", "Bytes kept per frame in bounded mode", snapLen);
+    cmd.AddValue("pcapMaxFileBytes", "Rotate capture files beyond this size in bounded mode (0 = never)", pcapMaxFileBytes);
+    cmd.AddValue("pcapMaxFiles", "Capture files per device in the rotation ring", pcapMaxFiles);
+    cmd.AddValue("scheduler", "Event scheduler: Map, Heap, Calendar, List, PriorityQueue or auto", scheduler);
+    cmd.AddValue("schedulerPrefix", "Simulated time each scheduler is timed on in auto mode", schedulerPrefix);
+    cmd.Parse(argc, argv);
+
     LogComponentEnable("ScratchBridge", LOG_LEVEL_INFO);
 
+    std::set<uint32_t> captured;
+    std::istringstream ids(pcapNodes);
+    std::string id;
+    while (std::getline(ids, id, ','))
+    {
+        if (id.empty())
+        {
+            continue;
+        }
+        size_t end = 0;
+        unsigned long node = 0;
+        try
+        {
+            node = id[0] == '-' ? nSensors + 1 : std::stoul(id, &end);
+        }
+        catch (const std::exception&)
+        {
+            end = 0;
+        }
+        if (end != id.size() || node > nSensors)
+        {
+            NS_LOG_ERROR("Invalid node id " << id << " in --pcapNodes, expected 0 to " << nSensors);
+            return 1;
+        }
+        captured.insert(node);
+    }
+
     NodeContainer nodes;
-    nodes.Create(8); // 1 gateway + 7 regular nodes
-    NS_LOG_INFO("Created 8 nodes: 1 gateway (Node_0) and 7 regular nodes.");
+    nodes.Create(nSensors + 1); // 1 gateway + nSensors regular nodes
+    NS_LOG_INFO("Created " << nodes.GetN() << " nodes: 1 gateway (Node_0) and " << nSensors << " regular nodes.");
 
     CsmaHelper csma;
     csma.SetChannelAttribute("DataRate", StringValue("100Mbps"));
@@ -33,52 +99,35 @@ int main(int argc, char *argv[])
     Ipv4InterfaceContainer interfaces = address.Assign(devices);
     NS_LOG_INFO("Assigned IP addresses in the range 192.168.1.0/24.");
 
-    // UDP server on gateway (Node 0) to receive responses from regular nodes
+    // Polling coordinator on gateway (Node 0): one poll/response slot per regular node and cycle
     uint16_t serverPort = 9;
-    UdpServerHelper gatewayServer(serverPort);
-    ApplicationContainer gatewayServerApp = gatewayServer.Install(nodes.Get(0));
-    gatewayServerApp.Start(Seconds(1.0));
-    gatewayServerApp.Stop(Seconds(300.0));
-    NS_LOG_INFO("Installed UDP server on Gateway (Node_0) to receive responses.");
-
-    // UDP servers on regular nodes (1 to 7) to receive polls
-    UdpServerHelper server(serverPort);
-    ApplicationContainer serverApps;
+    Ptr<PollingCoordinator> coordinator = CreateObject<PollingCoordinator>();
+    coordinator->SetAttribute("Port", UintegerValue(serverPort));
+    coordinator->SetAttribute("PollSize", UintegerValue(packetSize));
+    coordinator->SetAttribute("MinCycle", TimeValue(cycleTime));
+    coordinator->SetAttribute("MaxCycle", TimeValue(maxCycleTime));
+    coordinator->SetAttribute("Adaptive", BooleanValue(adaptiveCycle));
     for (uint32_t i = 1; i < nodes.GetN(); ++i)
     {
-        serverApps.Add(server.Install(nodes.Get(i)));
-        NS_LOG_INFO("Installed UDP server on Regular Node_" << i << " to receive polls.");
+        coordinator->AddNode(interfaces.GetAddress(i));
     }
-    serverApps.Start(Seconds(1.0));
-    serverApps.Stop(Seconds(300.0));
+    nodes.Get(0)->AddApplication(coordinator);
+    coordinator->SetStartTime(Seconds(2.0));
+    coordinator->SetStopTime(Seconds(simSeconds));
+    NS_LOG_INFO("Installed polling coordinator on Gateway (Node_0), cycle time " << cycleTime.GetSeconds()
+                << "s" << (adaptiveCycle ? " (adaptive)." : "."));
 
-    // UDP clients on gateway (Node 0) to poll each regular node sequentially, once per sequence
-    ApplicationContainer clientApps;
+    // Poll responders on regular nodes (1 to nSensors)
     for (uint32_t i = 1; i < nodes.GetN(); ++i)
     {
-        UdpClientHelper client(interfaces.GetAddress(i), serverPort);
-        client.SetAttribute("MaxPackets", UintegerValue(43)); // ~42 sequences in 300s (300 ÷ 7)
-        client.SetAttribute("Interval", TimeValue(Seconds(7.0))); // Repeat every sequence (7s)
-        client.SetAttribute("PacketSize", UintegerValue(1024));
-        ApplicationContainer clientApp = client.Install(nodes.Get(0));
-        clientApp.Start(Seconds(2.0 + (i - 1))); // Sequential: 2s, 3s, 4s, ...
-        clientApp.Stop(Seconds(300.0));
-        clientApps.Add(clientApp);
-        NS_LOG_INFO("Installed UDP client on Gateway (Node_0) to poll Regular Node_" << i << " starting at " << 2.0 + (i - 1) << "s, once per 7s sequence.");
-    }
-
-    // UDP clients on regular nodes (1 to 7) to respond to polls
-    for (uint32_t i = 1; i < nodes.GetN(); ++i)
-    {
-        UdpClientHelper responseClient(interfaces.GetAddress(0), serverPort);
-        responseClient.SetAttribute("MaxPackets", UintegerValue(43)); // Match polling cycles
-        responseClient.SetAttribute("Interval", TimeValue(Seconds(7.0))); // Match sequence interval
-        responseClient.SetAttribute("PacketSize", UintegerValue(1024));
-        ApplicationContainer responseApp = responseClient.Install(nodes.Get(i));
-        responseApp.Start(Seconds(2.1 + (i - 1))); // Respond 0.1s after poll: 2.1s, 3.1s, ...
-        responseApp.Stop(Seconds(300.0));
-        NS_LOG_INFO("Installed UDP client on Regular Node_" << i << " to respond to polls starting at " << 2.1 + (i - 1) << "s, once per 7s sequence.");
+        Ptr<PollResponder> responder = CreateObject<PollResponder>();
+        responder->SetAttribute("Port", UintegerValue(serverPort));
+        responder->SetAttribute("ResponseSize", UintegerValue(packetSize));
+        nodes.Get(i)->AddApplication(responder);
+        responder->SetStartTime(Seconds(1.0));
+        responder->SetStopTime(Seconds(simSeconds));
     }
+    NS_LOG_INFO("Installed poll responders on Regular Node_1 to Node_" << nSensors << ".");
 
     // Position nodes at specified locations
     MobilityHelper mobility;
@@ -88,39 +137,52 @@ int main(int argc, char *argv[])
     // Set exact positions (x, y, z) for each node
     Ptr<MobilityModel> mobilityModel;
     
-    // Node 0 (Gateway) at x=0m, y=0m
-    mobilityModel = nodes.Get(0)->GetObject<MobilityModel>();
-    mobilityModel->SetPosition(Vector(0.0, 0.0, 0.0));
-    
-    // Node 1 at x=10.3m, y=0.5m
-    mobilityModel = nodes.Get(1)->GetObject<MobilityModel>();
-    mobilityModel->SetPosition(Vector(10.3, 0.5, 0.0));
-    
-    // Node 2 at x=26.05m, y=0m
-    mobilityModel = nodes.Get(2)->GetObject<MobilityModel>();
-    mobilityModel->SetPosition(Vector(26.05, 0.0, 0.0));
-    
-    // Node 3 at x=29.2m, y=0.5m
-    mobilityModel = nodes.Get(3)->GetObject<MobilityModel>();
-    mobilityModel->SetPosition(Vector(29.2, 0.5, 0.0));
-    
-    // Node 4 at x=35.5m, y=0m
-    mobilityModel = nodes.Get(4)->GetObject<MobilityModel>();
-    mobilityModel->SetPosition(Vector(35.5, 0.0, 0.0));
-    
-    // Node 5 at x=37.5m, y=0.5m
-    mobilityModel = nodes.Get(5)->GetObject<MobilityModel>();
-    mobilityModel->SetPosition(Vector(37.5, 0.5, 0.0));
-    
-    // Node 6 at x=43.8m, y=0m
-    mobilityModel = nodes.Get(6)->GetObject<MobilityModel>();
-    mobilityModel->SetPosition(Vector(43.8, 0.0, 0.0));
-    
-    // Node 7 at x=46.95m, y=0.5m
-    mobilityModel = nodes.Get(7)->GetObject<MobilityModel>();
-    mobilityModel->SetPosition(Vector(46.95, 0.5, 0.0));
-    
-    NS_LOG_INFO("Positioned nodes along 73m bridge: Gateway (Node_0) at (0m, 0m), Regular Node_1 at (10.3m, 0.5m), Node_2 at (26.05m, 0m), Node_3 at (29.2m, 0.5m), Node_4 at (35.5m, 0m), Node_5 at (37.5m, 0.5m), Node_6 at (43.8m, 0m), Node_7 at (46.95m, 0.5m).");
+    // Measured positions of the gateway and the first 7 nodes along the bridge
+    const std::vector<Vector> positions = {Vector(0.0, 0.0, 0.0),
+                                           Vector(10.3, 0.5, 0.0),
+                                           Vector(26.05, 0.0, 0.0),
+                                           Vector(29.2, 0.5, 0.0),
+                                           Vector(35.5, 0.0, 0.0),
+                                           Vector(37.5, 0.5, 0.0),
+                                           Vector(43.8, 0.0, 0.0),
+                                           Vector(46.95, 0.5, 0.0)};
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        mobilityModel = nodes.Get(i)->GetObject<MobilityModel>();
+        if (i < positions.size())
+        {
+            mobilityModel->SetPosition(positions[i]);
+        }
+        else
+        {
+            // Additional nodes are spread evenly over the rest of the 73m bridge
+            uint32_t extra = nodes.GetN() - positions.size();
+            double x = 46.95 + (73.0 - 46.95) * (i - positions.size() + 1) / (extra + 1);
+            mobilityModel->SetPosition(Vector(x, (i % 2) * 0.5, 0.0));
+        }
+    }
+
+    NS_LOG_INFO("Positioned " << nodes.GetN() << " nodes along 73m bridge, Gateway (Node_0) at (0m, 0m).");
+
+    // Event scheduler; auto times each backend on a prefix of the run in a forked child, so it
+    // must come before NetAnim and the captures open their files
+    if (scheduler == "auto")
+    {
+        SchedulerTuner tuner;
+        tuner.SetPrefix(std::min(schedulerPrefix, Seconds(simSeconds)));
+        scheduler = tuner.Calibrate();
+        for (const SchedulerTuner::Timing& timing : tuner.GetTimings())
+        {
+            NS_LOG_INFO("Scheduler " << timing.backend << ": "
+                        << (timing.finished ? std::to_string(timing.wallSeconds) + " s" : "given up"));
+        }
+    }
+    if (!SchedulerTuner::Install(scheduler, false))
+    {
+        NS_LOG_ERROR("Unknown scheduler " << scheduler);
+        return 1;
+    }
+    NS_LOG_INFO("Event scheduler: " << scheduler << ".");
 
     // Enable NetAnim
     AnimationInterface anim("bridge-network.xml");
@@ -143,14 +205,47 @@ int main(int argc, char *argv[])
     NS_LOG_INFO("Configured NetAnim visualization (bridge-network.xml).");
 
     // Enable PCAP tracing
-    csma.EnablePcapAll("bridge-network");
-    NS_LOG_INFO("Enabled PCAP tracing (bridge-network-*.pcap).");
+    std::vector<Ptr<BoundedPcapCapture>> captures;
+    if (pcapMode == "full")
+    {
+        csma.EnablePcapAll("bridge-network");
+        NS_LOG_INFO("Enabled PCAP tracing (bridge-network-*.pcap).");
+    }
+    else if (pcapMode == "bounded")
+    {
+        captures = EnableBoundedPcap(devices, captured, "bridge-network", snapLen, pcapMaxFileBytes, pcapMaxFiles);
+        NS_LOG_INFO("Enabled bounded PCAP tracing on " << captures.size() << " devices, snaplen " << snapLen
+                    << " bytes" << (pcapMaxFileBytes ? ", rotating files" : "") << " (bridge-network-*.pcap).");
+    }
 
-    Simulator::Stop(Seconds(300.0));
-    NS_LOG_INFO("Starting simulation for 300 seconds...");
+    Simulator::Stop(Seconds(simSeconds));
+    NS_LOG_INFO("Starting simulation for " << simSeconds << " seconds...");
     Simulator::Run();
     NS_LOG_INFO("Simulation completed.");
 
+    std::cout << "================ POLLING SUMMARY ================\n";
+    std::cout << "Cycles: " << coordinator->GetCycleCount() << ", overruns: " << coordinator->GetOverrunCount()
+              << ", final cycle time: " << coordinator->GetCycleTime().GetSeconds() << " s\n";
+    std::cout << "Cycle busy time: mean " << coordinator->GetMeanBusyTime() << " s, max "
+              << coordinator->GetMaxBusyTime() << " s\n";
+    std::cout << "Cycle jitter: mean " << coordinator->GetMeanCycleJitter() << " s, max "
+              << coordinator->GetMaxCycleJitter() << " s, period std dev "
+              << coordinator->GetCyclePeriodStdDev() << " s\n";
+    std::cout << "Sustained response rate: " << coordinator->GetResponseRate() << " responses/s\n";
+    for (uint32_t i = 0; i < coordinator->GetNodeCount(); ++i)
+    {
+        const PollingCoordinator::NodeStats& stats = coordinator->GetNodeStats(i);
+        std::cout << "Node_" << i + 1 << ": " << stats.responses << "/" << stats.polls << " polls answered, "
+                  << stats.timeouts << " timeouts, latency mean " << stats.GetMeanLatency() * 1000.0
+                  << " ms, max " << stats.latencyMax * 1000.0 << " ms\n";
+    }
+    std::cout << "==============================================\n";
+    for (const auto& capture : captures)
+    {
+        NS_LOG_INFO("Capture: " << capture->GetFrameCount() << " frames, " << capture->GetBytesWritten()
+                    << " bytes in " << capture->GetFileCount() << " files.");
+    }
+
     Simulator::Destroy();
     NS_LOG_INFO("Simulation resources destroyed.");
 